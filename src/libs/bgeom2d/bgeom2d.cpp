@@ -26,7 +26,7 @@ double Point::meas_section(const Point& p, const Point& L1, const Point& L2, dou
 }
 
 double Point::meas_section(const Point& p, const Point& L1, const Point& L2) noexcept{
-	static double k;
+	double k;
 	return meas_section(p, L1, L2, k);
 }
 
@@ -175,7 +175,7 @@ vector<int> BoundingBox3DFinder::suspects(const Point3& bb) const{
 	return allsuspects(
 		get_xstart(bb.x), get_xend(bb.x),
 		get_ystart(bb.y), get_yend(bb.y),
-		get_zstart(bb.z), get_yend(bb.z));
+		get_zstart(bb.z), get_zend(bb.z));
 }
 
 vector<int> BoundingBox3DFinder::allsuspects(int x0, int x1, int y0, int y1, int z0, int z1) const{
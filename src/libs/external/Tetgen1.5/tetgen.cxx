@@ -16,6 +16,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "tetgen.h"
+#include <mutex>
 
 //// io_cxx ///////////////////////////////////////////////////////////////////
 ////                                                                       ////
@@ -3610,6 +3611,10 @@ int tetgenmesh::sapexpivot[6] = {5, 5, 3, 3, 4, 4};
 
 void tetgenmesh::inittables()
 {
+  // HybMesh: tables are static members equal for all instances.
+  // They are filled once to allow concurrent tetrahedralize() calls.
+  static std::once_flag tables_flag;
+  std::call_once(tables_flag, [](){
   int soffset, toffset;
   int i, j;
 
@@ -3685,6 +3690,7 @@ void tetgenmesh::inittables()
       stpivottbl[i][j] = (i & 3) + (((i & 12) + toffset) % 12);
     }
   }
+  });
 }
 
 
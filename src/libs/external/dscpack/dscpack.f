@@ -47,6 +47,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       PI = ACOS(-1.D0)
       IF (U.GE.0.63D0) GO TO 20
@@ -110,6 +111,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       WWP = (1.D0,0.D0)
       WWN = (1.D0,0.D0)
@@ -175,6 +177,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       WSUM = (0.D0,0.D0)
       DO 10 K = 1,M
@@ -304,6 +307,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       WQSUM = (0.D0,0.D0)
 C
@@ -382,6 +386,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       IF (ABS(WA-WB).GT.0.D0) GO TO 10
       WQUAD1 = (0.D0,0.D0)
@@ -469,6 +474,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       PI = ACOS(-1.D0)
       ZI = (0.D0,1.D0)
@@ -642,10 +648,15 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM1/W0,W1,Z0,Z1,C
+C$OMP THREADPRIVATE(/PARAM1/)
       COMMON /PARAM2/U,PHI0,PHI1,ALFA0,ALFA1,QWORK
+C$OMP THREADPRIVATE(/PARAM2/)
       COMMON /PARAM3/M,N,NPTQ,ISHAPE,LINEARC,NSHAPE,IND
+C$OMP THREADPRIVATE(/PARAM3/)
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
       COMMON /PARAM5/ISPRT,ICOUNT
+C$OMP THREADPRIVATE(/PARAM5/)
 C     ..
       CALL XWTRAN(M,N,X,U,C,W0,W1,PHI0,PHI1)
       CALL THDATA(U)
@@ -849,10 +860,15 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM1/ W02,W12,Z02,Z12,C2
+C$OMP THREADPRIVATE(/PARAM1/)
       COMMON /PARAM2/ U2,PHI02,PHI12,ALFA02,ALFA12,QWORK2
+C$OMP THREADPRIVATE(/PARAM2/)
       COMMON /PARAM3/ M2,N2,NPTQ2,ISHAPE2,LINEARC2,NSHAPE,IND
+C$OMP THREADPRIVATE(/PARAM3/)
       COMMON /PARAM4/ UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
       COMMON /PARAM5/ ISPRT,ICOUNT
+C$OMP THREADPRIVATE(/PARAM5/)
 C     ..
       ZI = (0.D0,1.D0)
       PI = ACOS(-1.D0)
@@ -1069,6 +1085,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       ZI = (0.D0,1.D0)
       PI = ACOS(-1.D0)
@@ -1204,6 +1221,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       WDSC = (0.D0,0.D0)
 C
@@ -1702,6 +1720,7 @@ C     .. Intrinsic Functions ..
 C     ..
 C     .. Common blocks ..
       COMMON /PARAM4/UARY,VARY,DLAM,IU
+C$OMP THREADPRIVATE(/PARAM4/)
 C     ..
       ERRMAX = 0.D0
       ERRMIN = 99.D0
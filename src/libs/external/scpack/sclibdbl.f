@@ -1021,6 +1021,7 @@ c   values.  integration with  step  may be continued.
 c
       dimension g(13),w(13),rho(13)
       data g(1)/1.0d0/,rho(1)/1.0d0/
+c$omp threadprivate(g,rho)
 c
       hi = xout - x
       ki = kold + 1
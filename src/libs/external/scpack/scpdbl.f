@@ -180,6 +180,7 @@ c
       implicit complex*16(c,w,z)
       common /param1/ kfix(20),krat(20),ncomp,nptsq2,c2,
      &  qwork2(460),betam2(20),z2(20),wc2,w2(20)
+c$omp threadprivate(/param1/)
       dimension z(n),w(n),betam(n),qwork(1)
       dimension ajinv(20,20),scr(900),fval(19),y(19)
       external scfun
@@ -356,6 +357,7 @@ c
       external zfode
       logical odecal
       common /param2/ cdwdt,z2(20),betam2(20),n2
+c$omp threadprivate(/param2/)
 c
       odecal = .false.
       if (iguess.ne.1) goto 1
@@ -408,6 +410,7 @@ c
       implicit double precision (a-b,d-h,o-v,x-y)
       implicit complex*16(c,w,z)
       common /param2/ cdwdt,z(20),betam(20),n
+c$omp threadprivate(/param2/)
 c
       zdzdt = cdwdt / zprod(zz,0,n,z,betam)
 c
@@ -522,6 +525,7 @@ c
       dimension fval(ndim),y(ndim)
       common /param1/ kfix(20),krat(20),ncomp,nptsq,c,
      &  qwork(460),betam(20),z(20),wc,w(20)
+c$omp threadprivate(/param1/)
       n = ndim+1
 c
 c transform y(k) to z(k):
@@ -759,6 +763,7 @@ c
       dimension z(n),betam(n)
 */*/* new line:
       common /logcnt/ ncount,ncnt1
+c$omp threadprivate(/logcnt/)
 c
 c using atan2 instead of log because the latter fails
 c at ztmp = (1.0, 0.0). Old code is
@@ -904,6 +909,7 @@ c
 
       subroutine count0
       common /logcnt/ ncount,ncnt1
+c$omp threadprivate(/logcnt/)
       ncount = 0
       ncnt1 = 0
       write (6,1)
@@ -913,6 +919,7 @@ c
 
       subroutine count
       common /logcnt/ ncount,ncnt1
+c$omp threadprivate(/logcnt/)
       ncdiff = ncount - ncnt1
       write (6,2) ncdiff,ncount
     2 format (' ------- no. logs: since last count',i7,',   total',i8)
@@ -7,10 +7,11 @@
 #include "debug2d.hpp"
 #include "healgrid.hpp"
 #include "modgrid.hpp"
+#include "hmparallel.hpp"
 
 using namespace HMBlay::Impl;
 
-BGrid BGrid::MeshFullPath(const ExtPath& epath){
+BGrid BGrid::MeshFullPath(const ExtPath& epath, int nthreads){
 	//1. divide by angles
 	vector<ExtPath> pths = ExtPath::DivideByAngle(epath,
 			{CornerTp::RIGHT,
@@ -26,18 +27,36 @@ BGrid BGrid::MeshFullPath(const ExtPath& epath){
 		pths = ExtPath::DivideByHalf(pths[0]);
 	}
 
-	//2. build conform mapping for each subpath
-	ShpVector<MappedRect> mps;
+	//2. build conform mapping for each subpath.
+	//   Subpaths share end vertices, so mappings are built
+	//   concurrently using deep copies of left, right and bottom lines.
+	ShpVector<MappedRect> mps(pths.size());
 	bool use_rect_approx = !epath.ext_data[0].opt->force_conformal;
-	for (auto& p: pths){
+	vector<std::array<HM2D::EdgeData, 3>> lrb(pths.size());
+	vector<int> femn(pths.size());
+	vector<double> depth(pths.size());
+	for (int i=0; i<pths.size(); ++i){
+		auto& p = pths[i];
 		//estimate vertical and horizontal partition
 		int isz = p.PathPartition(0, HM2D::Contour::Length(p)).size();
 		int jsz = p.largest_vpart_size();
+		femn[i] = isz*jsz*1.5;
+		depth[i] = p.largest_depth();
 
-		double h = p.largest_depth();
-		mps.push_back(MappedRect::Factory(p.leftbc, p.rightbc, p, h,
-					isz*jsz*1.5, use_rect_approx));
+		HM2D::EdgeData all, cp;
+		all.insert(all.end(), p.leftbc.begin(), p.leftbc.end());
+		all.insert(all.end(), p.rightbc.begin(), p.rightbc.end());
+		all.insert(all.end(), p.begin(), p.end());
+		HM2D::DeepCopy(all, cp);
+		auto it = cp.begin();
+		lrb[i][0].assign(it, it + p.leftbc.size()); it += p.leftbc.size();
+		lrb[i][1].assign(it, it + p.rightbc.size()); it += p.rightbc.size();
+		lrb[i][2].assign(it, cp.end());
 	}
+	HMParallel::For(pths.size(), [&](int i){
+		mps[i] = MappedRect::Factory(lrb[i][0], lrb[i][1], lrb[i][2], depth[i],
+				femn[i], use_rect_approx);
+	}, 2, nthreads);
 
 	//3. build rectangular meshers
 	ShpVector<MappedMesher> mesher4;
@@ -103,7 +122,7 @@ BGrid BGrid::MeshFullPath(const ExtPath& epath){
 	return g;
 }
 
-BGrid BGrid::MeshSequence(vector<Options*>& data){ 
+BGrid BGrid::MeshSequence(vector<Options*>& data, int nthreads){
 	auto ret = BGrid();
 
 	//1) assemble extended path = path + boundaries + angles
@@ -114,7 +133,7 @@ BGrid BGrid::MeshSequence(vector<Options*>& data){
 	ExtPath::ReinterpretCornerTp(fullpath);
 
 	//3) build grid for a path
-	ret = BGrid::MeshFullPath(fullpath);
+	ret = BGrid::MeshFullPath(fullpath, nthreads);
 
 	//4) guarantee no self-intersections.
 	//   Includes acute angle postprocessing.
@@ -160,27 +179,47 @@ BGrid BGrid::ImposeBGrids(ShpVector<BGrid>& gg){
 	_THROW_NOT_IMP_;
 }
 
-void BGrid::add_weights(const std::map<const HM2D::Cell*, int>& w){
-	for (auto& it: w) it.first->id = -1;
-	aa::constant_ids_pvec(vcells, 0);
-	for (auto& it: w) if (it.first->id == 0){
-		weight.insert(it);
+void BGrid::sync_features(){
+	bool aligned = feat_cells.size() == vcells.size();
+	for (int i=0; i<vcells.size() && aligned; ++i){
+		aligned = feat_cells[i] == vcells[i];
 	}
-}
-void BGrid::add_source_feat(const std::map<const HM2D::Cell*, shared_ptr<int>>& f){
-	for (auto& it: f) it.first->id = -1;
-	aa::constant_ids_pvec(vcells, 0);
-	for (auto& it: f) if (it.first->id == 0){
-		source_feat.insert(it);
+	if (aligned) return;
+
+	vector<int> w(vcells.size(), 1e3);
+	vector<shared_ptr<int>> f(vcells.size());
+	for (auto& c: feat_cells) c->id = -1;
+	aa::enumerate_ids_pvec(vcells);
+	for (int i=0; i<feat_cells.size(); ++i){
+		int k = feat_cells[i]->id;
+		if (k < 0) continue;
+		w[k] = weight[i];
+		f[k] = source_feat[i];
 	}
+	feat_cells = vcells;
+	weight = std::move(w);
+	source_feat = std::move(f);
+}
+
+void BGrid::set_features(const HM2D::CellData& cells, const vector<int>& w,
+		const vector<shared_ptr<int>>& f){
+	sync_features();
+	feat_cells.insert(feat_cells.end(), cells.begin(), cells.end());
+	weight.insert(weight.end(), w.begin(), w.end());
+	if (f.size() == 0) source_feat.resize(feat_cells.size());
+	else source_feat.insert(source_feat.end(), f.begin(), f.end());
+	//since new entries go last they override old features
+	sync_features();
+}
+
+void BGrid::set_weight(int i, int w){
+	sync_features();
+	weight[i] = w;
 }
 
 void BGrid::remove_cells(const vector<int>& bad_cells){
-	for (int ic: bad_cells){
-		weight.erase(vcells[ic].get());
-		source_feat.erase(vcells[ic].get());
-	}
 	HM2D::Grid::Algos::RemoveCells(*this, bad_cells);
+	sync_features();
 }
 
 void BGrid::add_grid(const BGrid& g){
@@ -188,25 +227,26 @@ void BGrid::add_grid(const BGrid& g){
 	vedges.insert(vedges.end(), g.vedges.begin(), g.vedges.end());
 	vcells.insert(vcells.end(), g.vcells.begin(), g.vcells.end());
 
-	add_weights(g.weight);
-	add_source_feat(g.source_feat);
+	//g features may be not aligned. sync_features will align them.
+	feat_cells.insert(feat_cells.end(), g.feat_cells.begin(), g.feat_cells.end());
+	weight.insert(weight.end(), g.weight.begin(), g.weight.end());
+	source_feat.insert(source_feat.end(), g.source_feat.begin(), g.source_feat.end());
+	sync_features();
 }
 
-void BGrid::add_cell(shared_ptr<HM2D::Cell> c, const HM2D::Cell* same_feat_cell){
+void BGrid::add_cell(shared_ptr<HM2D::Cell> c, int same_feat_cell){
+	sync_features();
 	vcells.push_back(c);
-	if (same_feat_cell != 0){
-		auto fnd1 = weight.find(same_feat_cell);
-		auto fnd2 = source_feat.find(same_feat_cell);
-		if (fnd1 != weight.end()) weight[c.get()] = fnd1->second;
-		if (fnd2 != source_feat.end()) source_feat[c.get()] = fnd2->second;
-	}
+	feat_cells.push_back(c);
+	weight.push_back(same_feat_cell >= 0 ? weight[same_feat_cell] : 1e3);
+	source_feat.push_back(same_feat_cell >= 0 ? source_feat[same_feat_cell]
+	                                          : shared_ptr<int>());
 }
 
-void BGrid::remove_features(const HM2D::Cell* c){
-	auto fnd1 = weight.find(c);
-	auto fnd2 = source_feat.find(c);
-	if (fnd1 != weight.end()) weight.erase(fnd1);
-	if (fnd2 != source_feat.end()) source_feat.erase(fnd2);
+void BGrid::remove_features(int i){
+	sync_features();
+	weight[i] = 1e3;
+	source_feat[i].reset();
 }
 
 shared_ptr<BGrid> BGrid::MoveFrom1(HM2D::GridData&& gg){
@@ -214,6 +254,7 @@ shared_ptr<BGrid> BGrid::MoveFrom1(HM2D::GridData&& gg){
 	ret->vcells = std::move(gg.vcells);
 	ret->vedges = std::move(gg.vedges);
 	ret->vvert = std::move(gg.vvert);
+	ret->sync_features();
 	return ret;
 }
 
@@ -222,5 +263,6 @@ BGrid BGrid::MoveFrom2(HM2D::GridData&& gg){
 	ret.vcells = std::move(gg.vcells);
 	ret.vedges = std::move(gg.vedges);
 	ret.vvert = std::move(gg.vvert);
+	ret.sync_features();
 	return ret;
 }
@@ -11,56 +11,62 @@ namespace Impl{
 class BGrid: public HM2D::GridData{
 	static ExtPath AssembleExtendedPath(vector<Options*>& data);
 	static BGrid NoSelfIntersections(BGrid& g, const HM2D::EdgeData& source);
-	static BGrid MeshFullPath(const ExtPath& p);
+	//conformal mappings of path segments are built using nthreads threads
+	static BGrid MeshFullPath(const ExtPath& p, int nthreads=0);
 
 public:
 	//includes deletion of features, edges and vertices
 	void remove_cells(const vector<int>& bad_cells);
 	//adds cell to the end of cell list.
-	//gets features (weight, source_feat) from same_feat_cell
+	//gets features (weight, source_feat) from same_feat_cell-th cell
 	//!!! does not add edges and vertices.
-	void add_cell(shared_ptr<HM2D::Cell> c, const HM2D::Cell* same_feat_cell=0);
+	void add_cell(shared_ptr<HM2D::Cell> c, int same_feat_cell=-1);
 	void add_grid(const BGrid& g);
 
-	//Removes all source features
-	void remove_features(const HM2D::Cell* c);
+	//Removes all source features of i-th cell
+	void remove_features(int i);
+
+	//Cell features are stored in arrays aligned with vcells.
+	//BGrid methods keep them aligned. If vcells were changed by
+	//other procedures (healing, splitting, etc.) sync_features()
+	//should be called before features access.
+	void sync_features();
+	//sets features of cells. Cells not presented in vcells are ignored.
+	//Empty f means that cells are not from source.
+	void set_features(const HM2D::CellData& cells, const vector<int>& w,
+			const vector<shared_ptr<int>>& f=vector<shared_ptr<int>>());
+	void set_weight(int i, int w);
 
 	//index of layer starting from source
 	//used for bgrid imposition to calculate cell priority
-	std::map<const HM2D::Cell*, int> weight;
-	int get_weight(const HM2D::Cell* c){
-		auto fnd = weight.find(c);
-		return (fnd == weight.end()) ? 1e3 : fnd->second;
-	}
-	int get_weight(int i){ return get_weight(vcells[i].get()); }
-	void add_weights(const std::map<const HM2D::Cell*, int>& w);
+	int get_weight(int i) const { return weight[i]; }
+	//!!! cell ids should equal their vcells indices
+	int get_weight(const HM2D::Cell* c) const { return weight[c->id]; }
 
 	//all cells which were created from the same source
 	//has unique address at source_feat. Value by itself doesn't matter.
 	//HM2D::Cells are considered to belong to same source if
-	//source_feat[c1].get() == source_feat[c2].get()
-	std::map<const HM2D::Cell*, shared_ptr<int>> source_feat;
-	void add_source_feat(const std::map<const HM2D::Cell*, shared_ptr<int>>& f);
-
-	bool is_from_source(const HM2D::Cell* c1) const{
-		return source_feat.find(c1) != source_feat.end();
+	//source_feat[i1].get() == source_feat[i2].get()
+	bool is_from_source(int i) const { return source_feat[i] != nullptr; }
+	bool is_from_same_source(int i1, int i2) const{
+		return source_feat[i1] != nullptr && source_feat[i1] == source_feat[i2];
 	}
+	//!!! cell ids should equal their vcells indices
 	bool is_from_same_source(const HM2D::Cell* c1, const HM2D::Cell* c2) const{
-		auto fnd1 = source_feat.find(c1);
-		auto fnd2 = source_feat.find(c2);
-		if (fnd1 == source_feat.end() || 
-			fnd2 == source_feat.end()) return false;
-		else return (fnd1->second.get() == fnd2->second.get());
-	}
-	bool is_from_same_source (int i1, int i2) const{
-		return is_from_same_source(vcells[i1].get(), vcells[i2].get());
+		return is_from_same_source(c1->id, c2->id);
 	}
 	
 	
-	static BGrid MeshSequence(vector<Options*>& data);
+	static BGrid MeshSequence(vector<Options*>& data, int nthreads=0);
 	static BGrid ImposeBGrids(ShpVector<BGrid>& gg);
 	static shared_ptr<BGrid> MoveFrom1(HM2D::GridData&& gg);
 	static BGrid MoveFrom2(HM2D::GridData&& gg);
+private:
+	//cells to which features were assigned.
+	//Equals vcells if features are aligned.
+	HM2D::CellData feat_cells;
+	vector<int> weight;
+	vector<shared_ptr<int>> source_feat;
 };
 
 
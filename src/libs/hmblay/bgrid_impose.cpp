@@ -9,6 +9,7 @@
 #include "healgrid.hpp"
 #include "finder2d.hpp"
 #include "modgrid.hpp"
+#include "hmparallel.hpp"
 
 using namespace HMBlay::Impl;
 
@@ -17,56 +18,33 @@ namespace{
 class ContactArea{
 	HM2D::Contour::Tree domain;
 	const BGrid* grid;
-	const int n_cfinder = 50; //partition for auxilliary grid
 	vector<HM2D::EdgeData> intersections; //intersection contours
-	std::map<int, int> intersect_results; //cell pair index -> intersection contour index
 	std::set<int> cells_in_area; //all cells which were involved in intersections
 
-	//unique integer for two cells
-	//!!! cells ids for should be set correctly
-	long long __cellcell(const HM2D::Cell* c1, const HM2D::Cell* c2){
-		long long i1 = c1->id, i2 = c2->id;
-		if (i1>i2) std::swap(i1, i2);
-		return i1*grid->vcells.size()+i2;
-	}
-
-	void __set_cells_intersection(const HM2D::Cell* c1, const HM2D::Cell* c2){
-		long long ind = __cellcell(c1, c2);
-		//if cells share the same feature they can not intersect
-		if (grid->is_from_same_source(c1, c2)) return;
-		//if result was already obtained
-		if (intersect_results.find(ind) != intersect_results.end()) return;
-		//apply intersection
-		auto res = HM2D::Contour::Clip::Intersection(c1->edges, c2->edges);
-		if (res.nodes.size() == 1){
-			cells_in_area.insert(c1->id);
-			cells_in_area.insert(c2->id);
-			intersect_results[ind] = intersections.size();
-			intersections.push_back(res.nodes[0]->contour);
-		} else {
-			intersect_results[ind] = -1;
-		}
-	}
-
 	void FillDomain(){
-		//GGeom::Info::CellFinder cfinder(grid, n_cfinder, n_cfinder);
-		auto bb = HM2D::BBox(grid->vvert);
-		BoundingBoxFinder cfinder(bb, bb.maxlen()/n_cfinder);
+		//broad phase: cells with intersecting bounding boxes
+		vector<BoundingBox> boxes(grid->vcells.size());
 		for (int i=0; i<grid->vcells.size(); ++i){
-			auto cbb = HM2D::BBox(grid->vcells[i]->edges);
-			cfinder.addentry(cbb);
+			boxes[i] = HM2D::BBox(grid->vcells[i]->edges);
 		}
-		aa::enumerate_ids_pvec(grid->vcells);
-		for (int i=0; i<cfinder.nsqr(); ++i){
-			auto clist = cfinder.sqr_entries(i);
-			//check all pairs of cells positioned close to each other
-			for (int j=0; j<clist.size(); ++j){
-				for (int k=j+1; k<clist.size(); ++k){
-					__set_cells_intersection(
-						grid->vcells[clist[j]].get(),
-						grid->vcells[clist[k]].get());
-				}
-			}
+		vector<std::pair<int, int>> pairs;
+		for (auto& ij: HM2D::Finder::BoxPairs(boxes)){
+			//if cells share the same feature they can not intersect
+			if (!grid->is_from_same_source(ij.first, ij.second)) pairs.push_back(ij);
+		}
+		//narrow phase: clipping only reads cell primitives
+		//so it is done concurrently
+		vector<HM2D::EdgeData> res(pairs.size());
+		HMParallel::For(pairs.size(), [&](int k){
+			auto r = HM2D::Contour::Clip::Intersection(
+				grid->vcells[pairs[k].first]->edges,
+				grid->vcells[pairs[k].second]->edges);
+			if (r.nodes.size() == 1) res[k] = r.nodes[0]->contour;
+		});
+		for (int k=0; k<pairs.size(); ++k) if (res[k].size() > 0){
+			cells_in_area.insert(pairs[k].first);
+			cells_in_area.insert(pairs[k].second);
+			intersections.push_back(std::move(res[k]));
 		}
 		//unite all intersections
 		domain = HM2D::Contour::Clip::Union(intersections);
@@ -120,21 +98,21 @@ WidenCellCont(const HM2D::EdgeData& cont){
 	return HM2D::Contour::Constructor::FromPoints(ret, true);
 }
 
-bool CellsIntersect(const HM2D::Cell* c1, const HM2D::Cell* c2, const BGrid& grid1){
-	//Finds if widened cells with different source feature are intersected 
+bool CellsIntersect(const HM2D::Cell* c1, const HM2D::Cell* c2,
+		const HM2D::EdgeData& cont1, const HM2D::EdgeData& cont2,
+		const BGrid& grid1){
+	//Finds if widened cells (cont1, cont2) with different source feature are intersected.
 	//Distance of widening is defined in WidenCellCont procedure.
+	//Cell primitives are not modified so it can be called concurrently.
 	
 	//if cells share the same feature return false
 	if (grid1.is_from_same_source(c1, c2)) return false;
 
 	//if have common edge return false
-	aa::constant_ids_pvec(c1->edges, 0);
-	aa::constant_ids_pvec(c2->edges, 1);
-	for (auto e: c1->edges) if (e->id == 1) return false;
+	for (auto& e1: c1->edges)
+	for (auto& e2: c2->edges) if (e1 == e2) return false;
 
 	//calculate intersection of widened cells
-	auto cont1 = WidenCellCont(c1->edges);
-	auto cont2 = WidenCellCont(c2->edges);
 	return std::get<0>(HM2D::Contour::Finder::Cross(cont1, cont2));
 }
 
@@ -208,10 +186,11 @@ void PurgeGrid(BGrid& grid, const HM2D::EdgeData& cont){
 	//!! i'm still not sure whether tracking bad points to tell good/bad cells is enough.
 	//Maybe there is a possibility of a not_too_bad_cell which is gathered all by bad points
 	std::set<const HM2D::Vertex*> bad_points;
+	HM2D::Finder::ClosestEdgeFinder cfinder(cont);
 	for (int i=0; i<grid.vvert.size(); ++i){
 		const HM2D::Vertex* p = grid.vvert[i].get();
 		//Explicitly check points on contours because whereis is not relieable in this case
-		auto res = HM2D::Finder::ClosestEdge(cont, *p);
+		auto res = cfinder.find(*p);
 		if (ISZERO(std::get<1>(res))) continue;
 		//check where is point
 		int r = HM2D::Contour::Finder::WhereIs(cont, *p);
@@ -318,8 +297,10 @@ const HM2D::EdgeData* ClosedSource(const HM2D::EdgeData* src, const BGrid* grid)
 		{bbox.xmin, bbox.ymin, bbox.xmax, bbox.ymin,
 		 bbox.xmax, bbox.ymax, bbox.xmin, bbox.ymax}, true);
 	double sz = 1.1*sqrt(sqr(bbox.lenx()) + sqr(bbox.leny()));
+	//angle of the next tried section. It is kept between calls
+	//so that end and start sections have different directions.
+	double an = 0;
 	auto find_good_box_point = [&](Point& src)->shared_ptr<HM2D::Vertex>{
-		static double an = 0;
 		//trying different angles until we find non crossing section
 		for (int i=0; i<20; ++i){
 			Point p2 = src + Point(cos(an), sin(an)) * sz;
@@ -366,33 +347,44 @@ void IntersectCellsInfo2(const BGrid& grid,
 
 	//choose conflict cells
 	std::list<const HM2D::Cell*> confc = contact.involved_cells();
+	vector<const HM2D::Cell*> cc(confc.begin(), confc.end());
+	//cell features are accessed by cell ids
+	aa::enumerate_ids_pvec(grid.vcells);
 	
 	//filter cells: cannot use ContactArea results
 	//because they were obtained without widening
-	auto cit = confc.begin();
-	while (cit != confc.end()){
-		//get all cells which intersect current
-		vector<std::list<const HM2D::Cell*>::iterator> adjcells;
-		auto cit2 = confc.begin();
-		while(cit2 != confc.end()){
-			if (cit != cit2 && CellsIntersect(*cit, *cit2, grid)){
-				adjcells.push_back(cit2);
-			}
-			++cit2;
-		}
-		//keep cit / keep cit2 / delete both
-		double pri = prifun(*cit);
+	vector<HM2D::EdgeData> wcont(cc.size());
+	vector<BoundingBox> wbox(cc.size());
+	for (int i=0; i<cc.size(); ++i){
+		wcont[i] = WidenCellCont(cc[i]->edges);
+		wbox[i] = HM2D::BBox(wcont[i].size() > 0 ? wcont[i] : cc[i]->edges);
+	}
+	//only cells with intersecting widened boxes are checked
+	auto pairs = HM2D::Finder::BoxPairs(wbox);
+	vector<char> isect(pairs.size(), 0);
+	HMParallel::For(pairs.size(), [&](int k){
+		int i = pairs[k].first, j = pairs[k].second;
+		isect[k] = CellsIntersect(cc[i], cc[j], wcont[i], wcont[j], grid);
+	});
+	vector<vector<int>> adjcells(cc.size());
+	for (int k=0; k<pairs.size(); ++k) if (isect[k]){
+		adjcells[pairs[k].first].push_back(pairs[k].second);
+		adjcells[pairs[k].second].push_back(pairs[k].first);
+	}
+
+	for (int i=0; i<cc.size(); ++i){
+		//keep cc[i] / keep adjacent / delete both
+		double pri = prifun(cc[i]);
 		bool keep_cit = true;
-		for (auto i: adjcells){
-			double pri2 = prifun(*i);
+		for (auto j: adjcells[i]){
+			double pri2 = prifun(cc[j]);
 			if (ISEQGREATER(pri2, pri)){
 				keep_cit = false; break;
 			}
 		}
 		//adding to list
-		if (!keep_cit) to_delete.push_back(*cit);
-		else to_keep.push_back(*cit);
-		++cit;
+		if (!keep_cit) to_delete.push_back(cc[i]);
+		else to_keep.push_back(cc[i]);
 	}
 }
 
@@ -688,6 +680,9 @@ NoHangingNodes::NoHangingNodes(BGrid& _grid): grid(&_grid), cfinder(grid, 20, 20
 void HMBlay::Impl::BGridImpose(BGrid& grid,
 		std::function<double(const HM2D::Cell*)> prifun,
 		const HM2D::EdgeData& source){
+	//grid could be healed after features assignment
+	grid.sync_features();
+
 	//1) if source is not a closed contour supplement it
 	const HM2D::EdgeData* src = ClosedSource(&source, &grid);
 
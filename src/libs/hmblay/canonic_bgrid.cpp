@@ -551,9 +551,12 @@ void MappedMesher::Fill(TBotPart bottom_partitioner, TVertPart vertical_partitio
 	auto right = HM2D::Grid::Constructor::RectGridRight(g4);
 	auto top = HM2D::Grid::Constructor::RectGridTop(g4);
 	//5) fill layer weights and feature
-	std::map<const HM2D::Cell*, int> lweights;
+	//feature arrays are aligned with g4cells which keeps all cells
+	//of the regular grid including those deleted in 7).
+	HM2D::CellData g4cells = g4.vcells;
+	vector<int> lweights(g4cells.size());
 	shared_ptr<int> pfeat(new int());
-	std::map<const HM2D::Cell*, shared_ptr<int>> feat;
+	vector<shared_ptr<int>> feat(g4cells.size(), pfeat);
 	int k = 0;
 	for (int j = 0; j<jsz-1; ++j){
 		for (int i=0; i<isz-1; ++i){
@@ -565,9 +568,7 @@ void MappedMesher::Fill(TBotPart bottom_partitioner, TVertPart vertical_partitio
 				case 4: w = jsz-1-j; break;
 				default: assert(false);
 			}
-			lweights[g4.vcells[k].get()] = w;
-			feat[g4.vcells[k].get()] = pfeat;
-			++k;
+			lweights[k++] = w;
 		}
 	}
 
@@ -576,11 +577,6 @@ void MappedMesher::Fill(TBotPart bottom_partitioner, TVertPart vertical_partitio
 	for (int j=0; j<jsz-1; ++j){
 		for (int i=0; i<isz-1; ++i){
 			if (vlines[i].size() < j+2 || vlines[i+1].size() < j+2){
-				auto c = g4.vcells[kc].get();
-				auto fnd1 = lweights.find(c);
-				auto fnd2 = feat.find(c);
-				if (fnd1 != lweights.end()) lweights.erase(fnd1);
-				if (fnd2 != feat.end()) feat.erase(fnd2);
 				g4.vcells[kc] = nullptr;
 			}
 			++kc;
@@ -674,6 +670,5 @@ void MappedMesher::Fill(TBotPart bottom_partitioner, TVertPart vertical_partitio
 	HM2D::Grid::Algos::Heal(result);
 
 	//13) fill weights
-	result.add_weights(lweights);
-	result.add_source_feat(feat);
+	result.set_features(g4cells, lweights, feat);
 }
@@ -78,7 +78,7 @@ void AcuteConnector::BuildInternals(){
 	filler->vedges[0]->boundary_type = pc2info.eprev->boundary_type;
 	filler->vedges[1]->boundary_type = pc2info.enext->boundary_type;
 	//5) set highest priority
-	filler->weight[filler->vcells[0].get()] = 0;
+	filler->set_weight(0, 0);
 };
 
 void AcuteConnector::ModifyAdjacents(){
@@ -321,9 +321,6 @@ void RoundConnector::AssembleGrid(vector<HM2D::VertexData>& pallpts, shared_ptr<
 	}
 	HM2D::Grid::Constructor::FixCellVert(ap, cell_vert);
 	filler = BGrid::MoveFrom1(HM2D::Grid::Constructor::FromTab(ap, cell_vert));
-	for (int i=0; i<filler->vcells.size(); ++i){
-		filler->weight.emplace(filler->vcells[i].get(), cell_weights[i]);
-		filler->source_feat.emplace(filler->vcells[i].get(), cell_feat[i]);
-	}
+	filler->set_features(filler->vcells, cell_weights, cell_feat);
 	HM2D::Grid::Algos::Heal(*filler);
 }
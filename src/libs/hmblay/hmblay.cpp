@@ -2,11 +2,38 @@
 #include <memory>
 #include "bgrid.hpp"
 #include "hmtimer.hpp"
+#include "hmparallel.hpp"
 
 using namespace HMBlay::Impl;
 
+namespace{
+//Groups of sequences which source contours have no common vertices.
+//Meshing procedures use primitives ids, so sequences sharing
+//vertices should be processed within the same thread.
+vector<vector<int>> independent_sequences(const vector<vector<Options*>>& seqvec){
+	vector<int> group(seqvec.size());
+	for (int i=0; i<group.size(); ++i) group[i] = i;
+	std::function<int(int)> root = [&](int i)->int{
+		return (group[i] == i) ? i : (group[i] = root(group[i]));
+	};
+	std::map<const HM2D::Vertex*, int> owner;
+	for (int i=0; i<seqvec.size(); ++i)
+	for (auto& opt: seqvec[i])
+	for (auto& e: *opt->get_full_source())
+	for (auto& v: e->vertices){
+		auto ins = owner.emplace(v.get(), i);
+		if (!ins.second) group[root(i)] = root(ins.first->second);
+	}
+	std::map<int, vector<int>> grmap;
+	for (int i=0; i<seqvec.size(); ++i) grmap[root(i)].push_back(i);
+	vector<vector<int>> ret;
+	for (auto& it: grmap) ret.push_back(it.second);
+	return ret;
+}
+}
+
 // ========================= Main Algo
-HM2D::GridData HMBlay::BuildBLayerGrid(const vector<HMBlay::Input>& orig_opt){
+HM2D::GridData HMBlay::BuildBLayerGrid(const vector<HMBlay::Input>& orig_opt, int nthreads){
 	if (orig_opt.size() == 0) return HM2D::GridData();
 	//0) check input
 	for (auto& o: orig_opt){
@@ -35,12 +62,16 @@ HM2D::GridData HMBlay::BuildBLayerGrid(const vector<HMBlay::Input>& orig_opt){
 	//Organize options in a sequences depending on start/end points
 	auto seqvec = Options::BuildSequence(opt);
 
-	//5) Build Grid for each sequence
-	ShpVector<BGrid> gg;
-	for (auto& seq: seqvec){
-		auto a = BGrid::MeshSequence(seq);
-		gg.emplace_back(new BGrid(std::move(a)));
-	}
+	//5) Build Grid for each sequence.
+	//   Independent sequences are meshed concurrently.
+	ShpVector<BGrid> gg(seqvec.size());
+	auto groups = independent_sequences(seqvec);
+	HMParallel::For(groups.size(), [&](int i){
+		for (int k: groups[i]){
+			auto a = BGrid::MeshSequence(seqvec[k], nthreads);
+			gg[k].reset(new BGrid(std::move(a)));
+		}
+	}, 2, nthreads);
 
 	//6) impose boundary grids
 	auto impres = BGrid::ImposeBGrids(gg);
@@ -13,7 +13,18 @@ public:
 	EBuildError(std::string m) noexcept: std::runtime_error(
 			std::string("Boundary Layer Build Error: ") + m){};
 };
-HM2D::GridData BuildBLayerGrid(const vector<Input>& opt);
+//Independent source contours and path segments are meshed concurrently
+//using nthreads threads. nthreads <= 0 means HMParallel::NThreads().
+HM2D::GridData BuildBLayerGrid(const vector<Input>& opt, int nthreads=0);
+
+//Receiver of a grid which is built by parts.
+//Points get consecutive indices in order of addition starting from zero.
+struct GridSink{
+	virtual ~GridSink(){}
+	virtual void add_points(const vector<Point>& pts) = 0;
+	//cells are given by indices of their points
+	virtual void add_cells(const vector<vector<int>>& cellvert) = 0;
+};
 
 struct TBuildStripeGrid: public HMCallback::ExecutorBase{
 	HMCB_SET_PROCNAME("Stripe grid building");
@@ -23,6 +34,17 @@ struct TBuildStripeGrid: public HMCallback::ExecutorBase{
 		const std::vector<double>& partition,
 		int tip_algo,
 		Point& bl, Point& br, Point& tr, Point& tl);
+
+	//Chunked mode: open contour is processed by windows of about nwindow edges.
+	//Grid of each window is passed to the sink and released
+	//so only a single window grid is kept in memory.
+	//Vertices at window junctions are shared. Their positions are taken from
+	//the preceding window, so the result may differ from the non-chunked one
+	//near junctions. Closed contours are built as a whole.
+	void _run(const HM2D::EdgeData& cont,
+		const std::vector<double>& partition,
+		int tip_algo, int nwindow, GridSink& sink,
+		Point& bl, Point& br, Point& tr, Point& tl);
 };
 extern HMCallback::FunctionWithCallback<TBuildStripeGrid> BuildStripeGrid;
 
@@ -4,6 +4,7 @@
 #include "buildgrid.hpp"
 #include "healgrid.hpp"
 #include "modgrid.hpp"
+#include "finder2d.hpp"
 
 HM2D::GridData HalfCirc(HM2D::EdgeData& b1, HM2D::EdgeData& b2, double sz){
 	Point b1f = *HM2D::Contour::First(b1);
@@ -114,11 +115,25 @@ HM2D::GridData HalfCirc(HM2D::EdgeData& b1, HM2D::EdgeData& b2, double sz){
 	return ret;
 }
 
-HMCallback::FunctionWithCallback<HMBlay::TBuildStripeGrid> HMBlay::BuildStripeGrid;
+namespace{
 
-HM2D::GridData HMBlay::TBuildStripeGrid::_run(const HM2D::EdgeData& cont,
+//points of a vertical line from the bottom to the top.
+//bot, top are given from the source contour.
+vector<Point> vertical_line(const vector<Point>& bot, const vector<Point>& top){
+	vector<Point> ret(bot.rbegin(), bot.rend());
+	for (auto& p: top) if (ret.size() == 0 || ret.back() != p) ret.push_back(p);
+	return ret;
+}
+
+//builds a stripe grid with tips at the start (tip_start) and the end (tip_end) of cont.
+//lline, rline are the vertical lines at the start and the end of an open contour
+//directed from the bottom to the top.
+HM2D::GridData build_stripe(const HM2D::EdgeData& cont,
 		const std::vector<double>& partition,
-		int tip_algo, Point& bl, Point& br, Point& tr, Point& tl){
+		int tip_algo, bool tip_start, bool tip_end,
+		Point& bl, Point& br, Point& tr, Point& tl,
+		vector<Point>& lline, vector<Point>& rline,
+		HMCallback::Caller2& callback){
 	HM2D::EdgeData cp(cont);
 	HMBlay::Input opt;
 	opt.partition = partition;
@@ -128,39 +143,38 @@ HM2D::GridData HMBlay::TBuildStripeGrid::_run(const HM2D::EdgeData& cont,
 	opt.start = *HM2D::Contour::First(cont);
 	opt.end = *HM2D::Contour::Last(cont);
 
-	callback->step_after(45, "Upper grid");
+	callback.step_after(45, "Upper grid");
 	opt.direction = HMBlay::Direction::INNER;
 	HM2D::GridData g1 = HMBlay::BuildBLayerGrid({opt});
 	HM2D::EdgeData cleft1, cright1;
+	vector<Point> lpts1, rpts1, lpts2, rpts2;
 	{
-		vector<Point> _pv1, _pv2;
 		if (HM2D::Contour::IsOpen(cont)){
 			int Nplen = cont.size()+1;
 			for (int i=0; i<opt.partition.size(); ++i){
-				_pv1.push_back(*g1.vvert[i*Nplen]);
-				_pv2.push_back(*g1.vvert[i*Nplen+Nplen-1]);
+				lpts1.push_back(*g1.vvert[i*Nplen]);
+				rpts1.push_back(*g1.vvert[i*Nplen+Nplen-1]);
 			}
-			cleft1 = HM2D::Contour::Constructor::FromPoints(_pv1);
-			cright1 = HM2D::Contour::Constructor::FromPoints(_pv2);
+			cleft1 = HM2D::Contour::Constructor::FromPoints(lpts1);
+			cright1 = HM2D::Contour::Constructor::FromPoints(rpts1);
 			tl = *HM2D::Contour::Last(cleft1);
 			tr = *HM2D::Contour::Last(cright1);
 		} else { tl = *g1.vvert.back(); tr = tl; }
 	}
 
-	callback->step_after(45, "Lower grid");
+	callback.step_after(45, "Lower grid");
 	opt.direction = HMBlay::Direction::OUTER;
 	HM2D::GridData g2 = HMBlay::BuildBLayerGrid({opt});
 	HM2D::EdgeData cleft2, cright2;
 	{
-		vector<Point> _pv1, _pv2;
 		if (HM2D::Contour::IsOpen(cont)){
 			int Nplen = cont.size()+1;
 			for (int i=0; i<opt.partition.size(); ++i){
-				_pv2.push_back(*g2.vvert[i*Nplen]);
-				_pv1.push_back(*g2.vvert[i*Nplen+Nplen-1]);
+				rpts2.push_back(*g2.vvert[i*Nplen]);
+				lpts2.push_back(*g2.vvert[i*Nplen+Nplen-1]);
 			}
-			cleft2 = HM2D::Contour::Constructor::FromPoints(_pv1);
-			cright2 = HM2D::Contour::Constructor::FromPoints(_pv2);
+			cleft2 = HM2D::Contour::Constructor::FromPoints(lpts2);
+			cright2 = HM2D::Contour::Constructor::FromPoints(rpts2);
 			bl = *HM2D::Contour::Last(cleft2);
 			br = *HM2D::Contour::Last(cright2);
 		} else { bl = *g2.vvert.back(); br=bl; }
@@ -189,19 +203,22 @@ HM2D::GridData HMBlay::TBuildStripeGrid::_run(const HM2D::EdgeData& cont,
 			cleft2.erase(cleft2.begin());
 			cright1.erase(cright1.begin());
 			cright2.erase(cright2.begin());
+			for (auto pv: {&lpts1, &lpts2, &rpts1, &rpts2}) pv->erase(pv->begin());
 		}
 		
 	}
+	lline = vertical_line(lpts2, lpts1);
+	rline = vertical_line(rpts2, rpts1);
 
-	callback->step_after(5, "Tip grids");
+	callback.step_after(5, "Tip grids");
 	shared_ptr<HM2D::GridData> tip1, tip2;
 
 	if (HM2D::Contour::IsClosed(cont)){ 
 	} else if (tip_algo == 0){
 	} else if (tip_algo == 1){
 		if (cleft1.size()>0){
-			tip1.reset(new HM2D::GridData(HalfCirc(cleft1, cleft2, cont[0]->length())));
-			tip2.reset(new HM2D::GridData(HalfCirc(cright2, cright1, cont.back()->length())));
+			if (tip_start) tip1.reset(new HM2D::GridData(HalfCirc(cleft1, cleft2, cont[0]->length())));
+			if (tip_end) tip2.reset(new HM2D::GridData(HalfCirc(cright2, cright1, cont.back()->length())));
 		} else {
 			HM2D::VertexData pts;
 			Vect av1 = tl - *HM2D::Contour::First(cont);
@@ -210,7 +227,7 @@ HM2D::GridData HMBlay::TBuildStripeGrid::_run(const HM2D::EdgeData& cont,
 			aa::add_shared(pts, HM2D::Vertex(tl));
 			aa::add_shared(pts, HM2D::Vertex( *HM2D::Contour::First(cont) + av1  ));
 			aa::add_shared(pts, HM2D::Vertex(bl));
-			tip1 = std::make_shared<HM2D::GridData>(
+			if (tip_start) tip1 = std::make_shared<HM2D::GridData>(
 				HM2D::Grid::Constructor::FromTab(pts, {{0, 1, 2}}));
 
 			pts.clear();
@@ -220,12 +237,12 @@ HM2D::GridData HMBlay::TBuildStripeGrid::_run(const HM2D::EdgeData& cont,
 			aa::add_shared(pts, HM2D::Vertex(br));
 			aa::add_shared(pts, HM2D::Vertex( *HM2D::Contour::Last(cont) + av2  ));
 			aa::add_shared(pts, HM2D::Vertex(tr));
-			tip2 = std::make_shared<HM2D::GridData>(
+			if (tip_end) tip2 = std::make_shared<HM2D::GridData>(
 				HM2D::Grid::Constructor::FromTab(pts, {{0, 1, 2}}));
 		}
 	}
 
-	callback->step_after(5, "Merge");
+	callback.step_after(5, "Merge");
 	HM2D::GridData ret = g1;
 	HM2D::Grid::Algos::MergeTo(g2, ret);
 	if (tip1) HM2D::Grid::Algos::MergeTo(*tip1, ret);
@@ -233,3 +250,79 @@ HM2D::GridData HMBlay::TBuildStripeGrid::_run(const HM2D::EdgeData& cont,
 
 	return ret;
 }
+
+}
+
+HMCallback::FunctionWithCallback<HMBlay::TBuildStripeGrid> HMBlay::BuildStripeGrid;
+
+HM2D::GridData HMBlay::TBuildStripeGrid::_run(const HM2D::EdgeData& cont,
+		const std::vector<double>& partition,
+		int tip_algo, Point& bl, Point& br, Point& tr, Point& tl){
+	vector<Point> lline, rline;
+	return build_stripe(cont, partition, tip_algo, true, true,
+			bl, br, tr, tl, lline, rline, *callback);
+}
+
+void HMBlay::TBuildStripeGrid::_run(const HM2D::EdgeData& cont,
+		const std::vector<double>& partition,
+		int tip_algo, int nwindow, GridSink& sink,
+		Point& bl, Point& br, Point& tr, Point& tl){
+	//windows contain at least two edges to define their direction
+	int ne = cont.size();
+	int nwin = 1;
+	if (HM2D::Contour::IsOpen(cont)){
+		nwin = std::max(1, (int)std::round(double(ne)/std::max(nwindow, 2)));
+		nwin = std::max(1, std::min(nwin, ne/2));
+	}
+	//global indices and coordinates of the previous window right line vertices
+	vector<int> prev_ind;
+	vector<Point> prev_pts;
+	int npts = 0;
+	for (int k=0; k<nwin; ++k){
+		HM2D::EdgeData wcont(cont.begin() + (long long)k*ne/nwin,
+		                     cont.begin() + (long long)(k+1)*ne/nwin);
+		Point wbl, wbr, wtr, wtl;
+		vector<Point> lline, rline;
+		HM2D::GridData g;
+		{
+			auto cb = callback->subrange(100./nwin, 100.);
+			g = build_stripe(wcont, partition, tip_algo, k == 0, k == nwin-1,
+					wbl, wbr, wtr, wtl, lline, rline, *cb);
+		}
+		if (k == 0){ bl = wbl; tl = wtl; }
+		if (k == nwin-1){ br = wbr; tr = wtr; }
+
+		//junction vertices are moved to the previous window line
+		aa::constant_ids_pvec(g.vvert, -1);
+		if (k > 0){
+			assert(lline.size() == prev_ind.size());
+			for (int i=0; i<lline.size(); ++i){
+				auto fnd = HM2D::Finder::ClosestPoint(g.vvert, lline[i]);
+				auto& v = g.vvert[std::get<0>(fnd)];
+				v->set(prev_pts[i]);
+				v->id = prev_ind[i];
+			}
+		}
+		//all other vertices are new
+		vector<Point> newpts;
+		for (auto& v: g.vvert) if (v->id < 0){
+			v->id = npts++;
+			newpts.push_back(*v);
+		}
+		vector<vector<int>> cellvert(g.vcells.size());
+		for (int i=0; i<g.vcells.size(); ++i){
+			auto op = HM2D::Contour::OrderedPoints(g.vcells[i]->edges);
+			for (int j=0; j<(int)op.size()-1; ++j) cellvert[i].push_back(op[j]->id);
+		}
+		sink.add_points(newpts);
+		sink.add_cells(cellvert);
+
+		if (k == nwin-1) break;
+		prev_pts = rline;
+		prev_ind.resize(rline.size());
+		for (int i=0; i<rline.size(); ++i){
+			auto fnd = HM2D::Finder::ClosestPoint(g.vvert, rline[i]);
+			prev_ind[i] = g.vvert[std::get<0>(fnd)]->id;
+		}
+	}
+}
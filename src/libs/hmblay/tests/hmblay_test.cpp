@@ -11,6 +11,8 @@
 #include "unite_grids.hpp"
 #include "finder2d.hpp"
 #include "inscribe_grid.hpp"
+#include "bgrid.hpp"
+#include "healgrid.hpp"
 
 using HMTesting::add_check;
 
@@ -773,6 +775,162 @@ void test17(){
 		"same with ignore_all option");
 }
 
+void test18(){
+	std::cout<<"18. Multiple sources in parallel"<<std::endl;
+	//row of squares and circles with outer boundary layers
+	vector<HM2D::EdgeData> conts;
+	for (int i=0; i<6; ++i){
+		double x = 3*i;
+		if (i % 2 == 0) conts.push_back(HM2D::Contour::Constructor::FromPoints(
+				{x, 0, x+1, 0, x+1, 1, x, 1}, true));
+		else conts.push_back(HM2D::Contour::Constructor::Circle(64, 0.5, Point(x+0.5, 0.5)));
+	}
+	vector<HMBlay::Input> inp(conts.size());
+	for (int i=0; i<conts.size(); ++i){
+		inp[i].bnd_step_method = HMBlay::MethFromString("KEEP_SHAPE");
+		inp[i].direction = HMBlay::DirectionFromString("OUTER");
+		inp[i].edges = &conts[i];
+		inp[i].bnd_step = 0.05;
+		inp[i].start = inp[i].end = *HM2D::Contour::First(conts[i]);
+		inp[i].partition = {0, 0.01, 0.02, 0.04, 0.08, 0.12};
+	}
+	HM2D::GridData g1 = HMBlay::BuildBLayerGrid(inp, 1);
+	HM2D::GridData g2 = HMBlay::BuildBLayerGrid(inp, 4);
+	bool good = g1.vvert.size() == g2.vvert.size() &&
+	            g1.vcells.size() == g2.vcells.size() &&
+	            g1.vcells.size() > 0;
+	for (int i=0; i<g1.vvert.size() && good; ++i){
+		good = *g1.vvert[i] == *g2.vvert[i];
+	}
+	add_check(good, "serial and parallel results coincide");
+	add_check(HM2D::Contour::Tree::GridBoundary(g1).nodes.size() == 12, "layers around all sources");
+
+	//open sawtooth sources: overlapping layers are imposed after closing the source
+	vector<HM2D::EdgeData> oconts;
+	for (int i=0; i<4; ++i){
+		vector<double> pts;
+		for (int k=0; k<9; ++k){
+			pts.push_back(3*i + 0.3*k);
+			pts.push_back(k % 2);
+		}
+		oconts.push_back(HM2D::Contour::Constructor::FromPoints(pts));
+	}
+	vector<HMBlay::Input> oinp(oconts.size());
+	for (int i=0; i<oconts.size(); ++i){
+		oinp[i].bnd_step_method = HMBlay::MethFromString("KEEP_SHAPE");
+		oinp[i].direction = HMBlay::DirectionFromString("LEFT");
+		oinp[i].edges = &oconts[i];
+		oinp[i].bnd_step = 0.05;
+		oinp[i].start = *HM2D::Contour::First(oconts[i]);
+		oinp[i].end = *HM2D::Contour::Last(oconts[i]);
+		oinp[i].partition = {0, 0.01, 0.02, 0.04, 0.08, 0.12};
+	}
+	HM2D::GridData g3 = HMBlay::BuildBLayerGrid(oinp, 1);
+	HM2D::GridData g4 = HMBlay::BuildBLayerGrid(oinp, 4);
+	good = g3.vvert.size() == g4.vvert.size() &&
+	       g3.vcells.size() == g4.vcells.size() &&
+	       g3.vcells.size() > 0;
+	//imposed areas are filled by gmsh triangulation
+	//which could slightly differ for different memory layouts
+	for (int i=0; i<g3.vvert.size() && good; ++i){
+		good = Point::meas(*g3.vvert[i], *g4.vvert[i]) < 1e-6;
+	}
+	add_check(good, "serial and parallel results coincide for open sources");
+}
+
+void test19(){
+	std::cout<<"19. Boundary layer grid cell features"<<std::endl;
+	using HMBlay::Impl::BGrid;
+	auto g = BGrid::MoveFrom2(HM2D::Grid::Constructor::RectGrid01(4, 3));
+	shared_ptr<int> f1(new int()), f2(new int());
+	vector<int> w;
+	vector<shared_ptr<int>> f;
+	for (int i=0; i<g.vcells.size(); ++i){
+		w.push_back(i);
+		f.push_back(i < 6 ? f1 : f2);
+	}
+	g.set_features(g.vcells, w, f);
+	HM2D::CellData c0 = g.vcells;
+	g.remove_cells({0, 7});
+	add_check(g.vcells.size() == 10 && g.get_weight(0) == 1 && g.get_weight(6) == 8 &&
+		g.is_from_same_source(0, 4) && !g.is_from_same_source(4, 5),
+		"features after cells removal");
+
+	//external procedures change cells order
+	std::reverse(g.vcells.begin(), g.vcells.end());
+	g.sync_features();
+	aa::enumerate_ids_pvec(g.vcells);
+	add_check(g.get_weight(c0[11].get()) == 11 && g.get_weight(0) == 11 &&
+		g.is_from_same_source(c0[1].get(), c0[5].get()) &&
+		!g.is_from_same_source(c0[1].get(), c0[6].get()), "features after reordering");
+
+	auto g2 = BGrid::MoveFrom2(HM2D::Grid::Constructor::RectGrid01(2, 2));
+	g2.set_weight(3, 0);
+	g.add_grid(g2);
+	add_check(g.vcells.size() == 14 && g.get_weight(13) == 0 && g.get_weight(12) == 1e3 &&
+		!g.is_from_source(13) && g.is_from_source(0), "features after grids addition");
+}
+
+void test20(){
+	std::cout<<"20. Imposition of overlapping layers"<<std::endl;
+	//star with acute outer corners
+	vector<double> pts;
+	int n = 24;
+	for (int i=0; i<2*n; ++i){
+		double r = (i % 2 == 0) ? 1.0 : 0.5, a = M_PI*i/n;
+		pts.push_back(r*cos(a));
+		pts.push_back(r*sin(a));
+	}
+	auto c = HM2D::Contour::Constructor::FromPoints(pts, true);
+	HMBlay::Input inp;
+	inp.bnd_step_method = HMBlay::MethFromString("KEEP_SHAPE");
+	inp.direction = HMBlay::DirectionFromString("OUTER");
+	inp.edges = &c;
+	inp.bnd_step = 0.01;
+	inp.start = inp.end = *HM2D::Contour::First(c);
+	inp.partition = {0, 0.002, 0.005, 0.01, 0.02, 0.03, 0.04, 0.05};
+	HM2D::GridData g = HMBlay::BuildBLayerGrid({inp});
+	add_check(g.vcells.size() > 0 && HM2D::Grid::Algos::Check(g), "non-intersecting grid");
+}
+
+void test21(){
+	std::cout<<"21. Chunked stripe grid"<<std::endl;
+	struct Collector: public HMBlay::GridSink{
+		vector<Point> pts;
+		vector<vector<int>> cells;
+		void add_points(const vector<Point>& p) override{
+			pts.insert(pts.end(), p.begin(), p.end());
+		}
+		void add_cells(const vector<vector<int>>& c) override{
+			cells.insert(cells.end(), c.begin(), c.end());
+		}
+	};
+	vector<Point> pts;
+	for (int i=0; i<=400; ++i) pts.push_back(Point(0.05*i, 0.3*sin(0.02*i)));
+	auto c = HM2D::Contour::Constructor::FromPoints(pts);
+	vector<double> part {0, 0.02, 0.05};
+	for (int ta: {0, 1}){
+		Point bl, br, tr, tl, bl2, br2, tr2, tl2;
+		HM2D::GridData g = HMBlay::BuildStripeGrid(c, part, ta, bl, br, tr, tl);
+		Collector col;
+		HMBlay::BuildStripeGrid(c, part, ta, 50, col, bl2, br2, tr2, tl2);
+		add_check(col.pts.size() == g.vvert.size() && col.cells.size() == g.vcells.size(),
+				"grid dimensions");
+		bool good = true;
+		for (auto& cell: col.cells){
+			double a = 0;
+			for (int i=0; i<cell.size(); ++i){
+				const Point& p1 = col.pts[cell[i]];
+				const Point& p2 = col.pts[cell[(i+1) % cell.size()]];
+				a += p1.x*p2.y - p2.x*p1.y;
+			}
+			if (a <= 0) good = false;
+		}
+		add_check(good, "positive cells");
+		add_check(bl == bl2 && br == br2 && tr == tr2 && tl == tl2, "corner points");
+	}
+}
+
 int main(){
 	test01();
 	test02();
@@ -790,6 +948,10 @@ int main(){
 	test14();
 	test16();
 	test17();
+	test18();
+	test19();
+	test20();
+	test21();
 	
 	//UNDONE:
 	//test15();
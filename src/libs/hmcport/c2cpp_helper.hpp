@@ -5,6 +5,7 @@
 #include <string>
 #include <string.h>
 #include "bgeom2d.h"
+#include "bgeom3d.h"
 #include <functional>
 
 namespace c2cpp{
@@ -53,6 +54,14 @@ inline vector<Point> to_points2(int np, double* pts){
 	return ret;
 }
 
+inline vector<Point3> to_points3(int np, double* pts){
+	vector<Point3> ret(np);
+	for (int i=0; i<np; ++i){
+		ret[i].set(pts[3*i], pts[3*i+1], pts[3*i+2]);
+	}
+	return ret;
+}
+
 inline bool eqstring(const char* _s1, std::string s2){
 	if (_s1 == nullptr) return false;
 	return s2 == std::string(_s1);
@@ -12,6 +12,7 @@
 #include "finder2d.hpp"
 #include "export2d_hm.hpp"
 #include "partition01.hpp"
+#include "hmparallel.hpp"
 
 
 int c2_dims(void* obj, int* ret){
@@ -451,9 +452,12 @@ HM2D::EdgeData const_partition(HM2D::EdgeData& data, double step, double a0,
 
 	//building
 	std::map<double, double> m; m[0]=step;
-	HM2D::EdgeData ret;
+	vector<HM2D::Contour::Algos::PartitionTask> tasks;
 	for (int i=0; i<simpc.size(); ++i){
-		auto r = HM2D::Contour::Algos::WeightedPartition(m, simpc[i], ned[i], keep);
+		tasks.emplace_back(simpc[i], m, ned[i], keep);
+	}
+	HM2D::EdgeData ret;
+	for (auto& r: HM2D::Contour::Algos::BulkPartition(tasks)){
 		ret.insert(ret.end(), r.begin(), r.end());
 	}
 	return ret;
@@ -620,20 +624,24 @@ int c2_matched_partition(void* obj, int nconds, void** conds, int npts, double*
 			for (auto& c: ac) conditions.push_back(c);
 		}
 
-		//process each input contour
-		HM2D::EdgeData ret_;
-		for (auto& icont: input){
-			//set angle points
-			HM2D::VertexData fixpoints;
-			_c2part::place_angle(icont, a0, true, fixpoints);
-			//set cross points
-			for (auto& cond: conditions) _c2part::place_cross(icont, cond, fixpoints);
-			//build partition
-			auto r = HM2D::Contour::Algos::ConditionalPartition(icont, step, infdist,
-					conditions, pconditions, power, fixpoints);
-			//add to answer
-			HM2D::DeepCopy(r, ret_);
+		//set angle and cross points for each input contour
+		vector<HM2D::VertexData> fixpoints(input.size());
+		for (int i=0; i<input.size(); ++i){
+			_c2part::place_angle(input[i], a0, true, fixpoints[i]);
+		}
+		//only conditions with overlapping boxes could cross input contours
+		vector<BoundingBox> ibox, cbox;
+		for (auto& c: input) ibox.push_back(HM2D::BBox(c, geps));
+		for (auto& c: conditions) cbox.push_back(HM2D::BBox(c, geps));
+		for (auto& ij: HM2D::Finder::BoxPairs(ibox, cbox)){
+			_c2part::place_cross(input[ij.first], conditions[ij.second], fixpoints[ij.first]);
 		}
+		//build partitions
+		auto r = HM2D::Contour::Algos::BulkConditionalPartition(input, step, infdist,
+				conditions, pconditions, power, fixpoints);
+		//add to answer
+		HM2D::EdgeData ret_;
+		for (auto& c: r) HM2D::DeepCopy(c, ret_);
 		sc.unscale(&ret_);
 		c2cpp::to_pp(ret_, ret);
 		return HMSUCCESS;
@@ -643,6 +651,47 @@ int c2_matched_partition(void* obj, int nconds, void** conds, int npts, double*
 	}
 }
 
+int c2_bulk_partition(int nobjs, void** objs, double* steps, int* nedges,
+		double a0, int keepbnd, int* nret, double** ret){
+	try{
+		auto _conts = c2cpp::to_pvec<HM2D::EdgeData>(nobjs, objs);
+		//deepcopy and scale each contour
+		vector<HM2D::EdgeData> conts(nobjs);
+		vector<ScaleBase> sc(nobjs);
+		vector<HM2D::VertexData> keep(nobjs);
+		vector<HM2D::Contour::Algos::PartitionTask> tasks;
+		for (int i=0; i<nobjs; ++i){
+			if (!HM2D::Contour::IsContour(*_conts[i])){
+				throw std::runtime_error("Only singly connected contours "
+						"are valid for bulk partition");
+			}
+			HM2D::DeepCopy(*_conts[i], conts[i]);
+			sc[i] = HM2D::Scale01(conts[i]);
+			_c2part::place_angle(conts[i], a0, keepbnd, keep[i]);
+			std::map<double, double> m; m[0] = steps[i]/sc[i].L;
+			tasks.emplace_back(conts[i], m, nedges ? nedges[i] : -1, keep[i]);
+		}
+		auto r = HM2D::Contour::Algos::BulkPartition(tasks);
+		//flat vertices arrays
+		vector<double> ret_;
+		for (int i=0; i<nobjs; ++i){
+			HM2D::Unscale(r[i], sc[i]);
+			auto op = HM2D::Contour::OrderedPoints(r[i]);
+			nret[i] = op.size();
+			for (auto& p: op){
+				ret_.push_back(p->x);
+				ret_.push_back(p->y);
+			}
+		}
+		*ret = new double[ret_.size()];
+		std::copy(ret_.begin(), ret_.end(), *ret);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
+
 int c2_segment_partition(double start, double end, double hstart, double hend,
 		int ninternal, double* hinternal, int* nret, double** ret){
 	try{
@@ -823,20 +872,19 @@ int c2_closest_points(void* obj, int npts, double* pts, const char* proj, double
 	try{
 		auto cont = static_cast<HM2D::EdgeData*>(obj);
 		vector<Point> points = c2cpp::to_points2(npts, pts);
-		vector<Point> ret_;
+		vector<Point> ret_(points.size());
 		if (c2cpp::eqstring(proj, "vertex")){
 			auto av = HM2D::AllVertices(*cont);
-			for (auto& p: points){
-				int fnd = std::get<0>(HM2D::Finder::ClosestPoint(av, p));
-				ret_.push_back(*av[fnd]);
-			}
+			HM2D::Finder::ClosestPointFinder finder(av);
+			HMParallel::For(points.size(), [&](int i){
+				int fnd = std::get<0>(finder.find(points[i]));
+				ret_[i] = *av[fnd];
+			}, 64);
 		} else if (c2cpp::eqstring(proj, "edge")){
-			for (auto& p: points){
-				auto fnd = HM2D::Finder::ClosestEdge(*cont, p);
-				HM2D::Edge& e = *(*cont)[std::get<0>(fnd)];
-				double w = std::get<2>(fnd);
-				ret_.push_back(Point::Weigh(*e.pfirst(), *e.plast(), w));
-			}
+			HM2D::Finder::ClosestEdgeFinder finder(*cont);
+			HMParallel::For(points.size(), [&](int i){
+				ret_[i] = finder.find_point(points[i]);
+			}, 64);
 		}
 		else throw std::runtime_error("unknown projection option");
 
@@ -73,6 +73,17 @@ int c2_partition(void* obj, const char* algo, int nstep, double* step, double a0
 int c2_matched_partition(void* obj, int nconts, void** conts, int npts, double* pts, double step,
                          double infdist, double power, double a0, void** ret);
 
+//constant step partition of multiple singly connected contours processed in parallel
+// steps[i]: partition step of i-th contour
+// nedges[i]: forced number of edges of i-th contour or -1. nedges could be NULL.
+// a0, keepbnd: same as in c2_partition
+// nret[i]: number of vertices in i-th result
+// ret: [x0, y0, x1, y1, ...] ordered vertices of all results.
+//      First vertex of a closed contour is repeated at its end.
+//      Should be freed by free_double_array.
+int c2_bulk_partition(int nobjs, void** objs, double* steps, int* nedges,
+                      double a0, int keepbnd, int* nret, double** ret);
+
 int c2_segment_partition(double start, double end, double hstart, double hend,
 	int ninternal, double* hinternal, int* nret, double** ret);
 
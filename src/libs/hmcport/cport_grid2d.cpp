@@ -21,9 +21,11 @@
 #include "export2d_fluent.hpp"
 #include "export2d_tecplot.hpp"
 #include "export2d_hm.hpp"
+#include "export2d_vtk.hpp"
 #include "snap_grid2cont.hpp"
 #include "treverter2d.hpp"
 #include "inscribe_grid.hpp"
+#include "renumgrid.hpp"
 
 
 int g2_dims(void* obj, int* ret){
@@ -146,6 +148,20 @@ int g2_move(void* obj, double* dx){
 		return HMERROR;
 	}
 }
+int g2_renumber(void* obj, const char* algo){
+	try{
+		HM2D::Grid::Algos::RenumberMethod m;
+		if (c2cpp::eqstring(algo, "rcm")) m = HM2D::Grid::Algos::RenumberMethod::RCM;
+		else if (c2cpp::eqstring(algo, "hilbert")) m = HM2D::Grid::Algos::RenumberMethod::HILBERT;
+		else if (c2cpp::eqstring(algo, "morton")) m = HM2D::Grid::Algos::RenumberMethod::MORTON;
+		else throw std::runtime_error("unknown renumbering algorithm");
+		HM2D::Grid::Algos::Renumber(*static_cast<HM2D::GridData*>(obj), m);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
 int g2_scale(void* obj, double* pc, double* p0){
 	try{
 		auto g = static_cast<HM2D::GridData*>(obj);
@@ -684,10 +700,55 @@ int g2_stripe_grid(void* obj, int npart, double* part, const char* tipalgo, int*
 		return HMERROR;
 	}
 }
+namespace{
+//passes unscaled window grids to a vtk stream
+struct StripeVTKSink: public HMBlay::GridSink{
+	StripeVTKSink(HM2D::Export::GridVTKStream& out, const ScaleBase& sc): out(out), sc(sc){}
+	void add_points(const vector<Point>& pts) override{
+		vector<Point> p2(pts);
+		sc.unscale(p2.begin(), p2.end());
+		out.add_points(p2);
+	}
+	void add_cells(const vector<vector<int>>& cellvert) override{
+		out.add_cells(cellvert);
+	}
+
+	HM2D::Export::GridVTKStream& out;
+	ScaleBase sc;
+};
+}
+
+int g2_stripe_grid_vtk(void* obj, int npart, double* part, const char* tipalgo, int nwindow,
+		const char* fname, hmcport_callback cb){
+	try{
+		auto cont = static_cast<HM2D::EdgeData*>(obj);
+		Autoscale::D2 sc(cont);
+
+		//scaling
+		vector<double> spart(part, part+npart);
+		sc.scale(spart);
+
+		//main procedure
+		Point bl, br, tr, tl;
+		HM2D::EdgeData ic = HM2D::Contour::Assembler::Contour1(*cont);
+		int ta = 0;
+		if (c2cpp::eqstring(tipalgo, "radial")) ta = 1;
+		HM2D::Export::GridVTKStream out(fname);
+		StripeVTKSink sink(out, sc.get_scale());
+		HMBlay::BuildStripeGrid.WithCallback(cb, ic, spart, ta, nwindow, sink,
+				bl, br, tr, tl);
+		out.fin();
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
+
 int g2_map_grid(void* base_obj, void* target_obj,
 		int npoints, double* base_points, double* target_points,
 		const char* snap, int bt_from_contour, const char* algo,
-		int is_reversed, int rinvalid, void** ret, hmcport_callback cb){
+		int is_reversed, int rinvalid, double fem_tol, void** ret, hmcport_callback cb){
 	ScaleBase sc_backup;
 	try{
 		HM2D::GridData* g = static_cast<HM2D::GridData*>(base_obj);
@@ -703,6 +764,7 @@ int g2_map_grid(void* base_obj, void* target_obj,
 
 		HMMap::Options opt;
 		opt.btypes_from_contour = bt_from_contour;
+		opt.fem_tol = fem_tol;
 
 		switch (std::map<std::string, int>{
 				{"no", 1},
@@ -1167,7 +1229,7 @@ int g2_to_hm(void* doc, void* node, void* obj, const char* name, const char* fmt
 		return HMERROR;
 	}
 }
-int g2_boundary_layer(int nopt, BoundaryLayerGridOption* opt, void** ret, hmcport_callback cb){
+int g2_boundary_layer(int nopt, BoundaryLayerGridOption* opt, int nthreads, void** ret, hmcport_callback cb){
 	try{
 		vector<HMBlay::Input> vinp(nopt);
 		for (int i=0; i<nopt; ++i){
@@ -1195,7 +1257,7 @@ int g2_boundary_layer(int nopt, BoundaryLayerGridOption* opt, void** ret, hmcpor
 				inp.bnd_step_basis.push_back(std::make_pair(Point(inp.end), opt_.step_end));
 			}
 		}
-		*ret = new HM2D::GridData(HMBlay::BuildBLayerGrid(vinp));
+		*ret = new HM2D::GridData(HMBlay::BuildBLayerGrid(vinp, nthreads));
 		return HMSUCCESS;
 	} catch (std::exception& e){
 		add_error_message(e.what());
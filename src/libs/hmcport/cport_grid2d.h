@@ -15,6 +15,8 @@ int g2_deepcopy(void* obj, void** ret);
 int g2_free(void* obj);
 int g2_concatenate(int nobjs, void** objs, void** ret);
 int g2_move(void* obj, double* dx);
+//reorders primitives for memory locality. algo = "rcm", "hilbert", "morton"
+int g2_renumber(void* obj, const char* algo);
 int g2_scale(void* obj, double* pc, double* p0);
 int g2_reflect(void* obj, double* v0, double* v1);
 int g2_rotate(void* obj, double* p0, double a);
@@ -63,6 +65,11 @@ int g2_circ4grid(const char* algo, double* p0, double rad, double step, double s
 int g2_stripe_grid(void* obj, int npartition, double* partition, const char* tipalgo, int* bnd, void** ret,
 		hmcport_callback cb);
 
+//builds stripe grid around open contour by windows of nwindow edges
+//and writes it directly to vtk file fname without assembling it in memory.
+int g2_stripe_grid_vtk(void* obj, int npartition, double* partition, const char* tipalgo, int nwindow,
+		const char* fname, hmcport_callback cb);
+
 //base_grid - Grid* object 
 //target_contour - EdgeData* object
 //pbase, ptarget[2*Npnt] - mapped points given as [x0, y0, x1, y1, ....]
@@ -76,11 +83,14 @@ int g2_stripe_grid(void* obj, int npartition, double* partition, const char* tip
 //reversed:
 //   0 - default
 //   1 - target contour is reversed
+//fem_tol:
+//   >0 - adaptive auxiliary triangulation with given relative error tolerance
+//   otherwise - fixed auxiliary triangulation
 //if return_invalid = true then grid will be returned even if it is not valid,
 int g2_map_grid(void* base_obj, void* target_obj,
 		int npoints, double* base_points, double* target_points,
 		const char* snap, int bt_from_contour, const char* algo,
-		int is_reversed, int rinvalid, void** ret, hmcport_callback cb);
+		int is_reversed, int rinvalid, double fem_tol, void** ret, hmcport_callback cb);
 
 int g2_point_at(void* obj, int index, double* ret);
 int g2_closest_points(void* obj, int npts, double* pts, const char* proj, double* ret);
@@ -142,7 +152,9 @@ struct BoundaryLayerGridOption{
 	double step_start; //step values for incremental stepping
 	double step_end;
 };
-int g2_boundary_layer(int nopt, BoundaryLayerGridOption* opt, void** ret, hmcport_callback cb);
+//nthreads - number of threads used for independent sources and path segments.
+//            nthreads <= 0 means default value
+int g2_boundary_layer(int nopt, BoundaryLayerGridOption* opt, int nthreads, void** ret, hmcport_callback cb);
 
 int g2_snap_to_contour(void* grid, void* contour, double* gp1, double* gp2,
 		double* cp1, double* cp2, const char* algo, void** ret);
@@ -7,6 +7,7 @@
 #include "surface.hpp"
 #include "treverter3d.hpp"
 #include "merge3d.hpp"
+#include "renumber3d.hpp"
 #include "buildgrid3d.hpp"
 #include "revolve_grid3d.hpp"
 #include "tetrahedral.hpp"
@@ -31,6 +32,20 @@ int g3_move(void* obj, double* dx){
 		return HMERROR;
 	}
 }
+int g3_renumber(void* obj, const char* algo){
+	try{
+		HM3D::Grid::Algos::RenumberMethod m;
+		if (c2cpp::eqstring(algo, "rcm")) m = HM3D::Grid::Algos::RenumberMethod::RCM;
+		else if (c2cpp::eqstring(algo, "hilbert")) m = HM3D::Grid::Algos::RenumberMethod::HILBERT;
+		else if (c2cpp::eqstring(algo, "morton")) m = HM3D::Grid::Algos::RenumberMethod::MORTON;
+		else throw std::runtime_error("unknown renumbering algorithm");
+		HM3D::Grid::Algos::Renumber(*static_cast<HM3D::GridData*>(obj), m);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
 int g3_scale(void* obj, double* pc, double* p0){
 	try{
 		auto g = static_cast<HM3D::GridData*>(obj);
@@ -291,6 +306,14 @@ int g3_concatenate(int nobjs, void** objs, void** ret){
 	try{
 		auto gg = c2cpp::to_pvec<HM3D::GridData>(nobjs, objs);
 		HM3D::GridData ret_;
+		//allocate once
+		size_t nv=0, ne=0, nf=0, nc=0;
+		for (auto g: gg){
+			nv += g->vvert.size(); ne += g->vedges.size();
+			nf += g->vfaces.size(); nc += g->vcells.size();
+		}
+		ret_.vvert.reserve(nv); ret_.vedges.reserve(ne);
+		ret_.vfaces.reserve(nf); ret_.vcells.reserve(nc);
 		for (auto g: gg){
 			ret_.vvert.insert(ret_.vvert.end(), g->vvert.begin(), g->vvert.end());
 			ret_.vedges.insert(ret_.vedges.end(), g->vedges.begin(), g->vedges.end());
@@ -398,6 +421,21 @@ int g3_merge(void* obj1, void* obj2, void** ret, hmcport_callback cb){
 	}
 }
 
+int g3_merge_many(int nobjs, void** objs, void** ret, hmcport_callback cb){
+	try{
+		auto gg = c2cpp::to_pvec<HM3D::GridData>(nobjs, objs);
+		Autoscale::D3 sc(gg);
+		HM3D::GridData ret_ = HM3D::Grid::Algos::MergeGrids(
+			vector<const HM3D::GridData*>(gg.begin(), gg.end()));
+		sc.unscale(&ret_);
+		c2cpp::to_pp(ret_, ret);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
+
 int g3_extrude(void* obj, int nz, double* zvals,
 		int*  bbot, int* btop,
 		int bside, void** ret){
@@ -455,6 +493,7 @@ int g3_revolve(void* obj, double* vec, int n_phi, double* phi,
 int g3_tetrahedral_fill(int nsurf, void** surf,
 		int nconstr, void** constr,
 		int npts, double* pcoords, double* psizes,
+		int nthreads, const char* backend,
 		void** ret, hmcport_callback cb){
 	try{
 		//TODO constraints are not supported yet
@@ -464,9 +503,13 @@ int g3_tetrahedral_fill(int nsurf, void** surf,
 		//collect all input source surfaces
 		HM3D::FaceData source;
 		for (auto& s: surf_) source.insert(source.end(), s->begin(), s->end());
+		HM3D::Mesher::TetrahedralBackend bk;
+		if (c2cpp::eqstring(backend, "gmsh")) bk = HM3D::Mesher::TetrahedralBackend::GMSH;
+		else if (c2cpp::eqstring(backend, "tetgen")) bk = HM3D::Mesher::TetrahedralBackend::TETGEN;
+		else throw std::runtime_error("unknown tetrahedral meshing backend");
 		//procedure
 		HM3D::GridData ret_ = HM3D::Mesher::UnstructuredTetrahedral.WithCallback(
-				cb, source);
+				cb, source, nthreads, bk);
 		sc.unscale(&ret_);
 		c2cpp::to_pp(ret_, ret);
 		return HMSUCCESS;
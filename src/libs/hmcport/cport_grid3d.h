@@ -6,6 +6,8 @@
 extern "C"{
 
 int g3_move(void* obj, double* dx);
+//reorders primitives for memory locality. algo = "rcm", "hilbert", "morton"
+int g3_renumber(void* obj, const char* algo);
 int g3_scale(void* obj, double* pc, double* p0);
 int g3_point_at(void* obj, int index, double* ret);
 
@@ -49,6 +51,8 @@ int g3_volume(void* obj, double* ret);
 
 //merge coincident primitives
 int g3_merge(void* obj1, void* obj2, void** ret, hmcport_callback cb);
+//merge coincident primitives of nobjs grids in a single pass
+int g3_merge_many(int nobjs, void** objs, void** ret, hmcport_callback cb);
 
 int g3_assign_boundary_types(void* obj, int* bnd, int** revdif);
 
@@ -71,9 +75,13 @@ int g3_revolve(void* obj, double* vec, int n_phi, double* phi,
 
 //======= unstructured fill
 //0 on fail
+//nthreads - number of threads used for disjoint domains.
+//           nthreads <= 0 means default value
+//backend = "gmsh", "tetgen"
 int g3_tetrahedral_fill(int nsurf, void** surf,
 		int nconstr, void** constr,
 		int npts, double* pcoords, double* psizes,
+		int nthreads, const char* backend,
 		void** ret, hmcport_callback cb);
 
 
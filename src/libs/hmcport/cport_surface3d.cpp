@@ -5,6 +5,8 @@
 #include "surface_tree.hpp"
 #include "treverter3d.hpp"
 #include "export3d_hm.hpp"
+#include "finder3d.hpp"
+#include "hmparallel.hpp"
 
 int s3_dims(void* obj, int* dims){
 	try{
@@ -239,7 +241,11 @@ int s3_quick_separate(void* obj, int* nret, void*** ret){
 int s3_concatenate(int nobjs, void** objs, void** ret){
 	try{
 		HM3D::FaceData ret_;
-		for (auto& it: c2cpp::to_pvec<HM3D::FaceData>(nobjs, objs)){
+		auto ss = c2cpp::to_pvec<HM3D::FaceData>(nobjs, objs);
+		size_t nf = 0;
+		for (auto& it: ss) nf += it->size();
+		ret_.reserve(nf);
+		for (auto& it: ss){
 			ret_.insert(ret_.end(), it->begin(), it->end());
 		}
 		c2cpp::to_pp(ret_, ret);
@@ -281,3 +287,55 @@ int s3_assign_boundary_types(void* obj, int* bnd, int** revdif){
 		return HMERROR;
 	}
 }
+
+int s3_closest_points(void* obj, int npts, double* pts, double* ret, int* ret_faces){
+	try{
+		auto surf = static_cast<HM3D::FaceData*>(obj);
+		vector<Point3> points = c2cpp::to_points3(npts, pts);
+		HM3D::Finder::SurfaceFinder finder(*surf);
+		HMParallel::For(points.size(), [&](int i){
+			auto fnd = finder.find(points[i]);
+			if (std::get<0>(fnd) < 0) throw std::runtime_error("empty surface");
+			const Point3& p = std::get<2>(fnd);
+			ret[3*i] = p.x;
+			ret[3*i+1] = p.y;
+			ret[3*i+2] = p.z;
+			ret_faces[i] = std::get<0>(fnd);
+		}, 64);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
+
+int s3_where_points(void* obj, int npts, double* pts, int* ret){
+	try{
+		auto surf = static_cast<HM3D::FaceData*>(obj);
+		vector<Point3> points = c2cpp::to_points3(npts, pts);
+		HM3D::Finder::SurfaceFinder finder(*surf);
+		HMParallel::For(points.size(), [&](int i){
+			ret[i] = finder.whereis(points[i]);
+		}, 64);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
+
+int s3_faces_in_box(void* obj, double* box, int* nret, int** ret){
+	try{
+		auto surf = static_cast<HM3D::FaceData*>(obj);
+		HM3D::Finder::SurfaceFinder finder(*surf);
+		BoundingBox3D bb(Point3(box[0], box[1], box[2]), Point3(box[3], box[4], box[5]));
+		vector<int> fc = finder.faces_in_box(bb);
+		*nret = fc.size();
+		*ret = new int[*nret];
+		std::copy(fc.begin(), fc.end(), *ret);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
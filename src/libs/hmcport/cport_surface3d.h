@@ -27,6 +27,15 @@ int s3_to_hm(void* doc, void* node, void* obj, const char* name, const char* fmt
 		hmcport_callback cb);
 int s3_assign_boundary_types(void* obj, int* bnd, int** revdif);
 
+//ret - closest points lying on surface faces, ret_faces - indices of those faces
+int s3_closest_points(void* obj, int npts, double* pts, double* ret, int* ret_faces);
+//location of points with respect to closed surface:
+//ret = 1 - inside, 0 - on the surface, -1 - outside
+int s3_where_points(void* obj, int npts, double* pts, int* ret);
+//box = [xmin, ymin, zmin, xmax, ymax, zmax]
+//ret - sorted indices of faces which bounding boxes cross the box
+int s3_faces_in_box(void* obj, double* box, int* nret, int** ret);
+
 }
 #endif
 
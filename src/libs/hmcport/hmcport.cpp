@@ -1,5 +1,6 @@
 #include "hmcport.h"
 #include "hmtesting.hpp"
+#include "hmtimer.hpp"
 #include <iostream>
 #include "c2cpp_helper.hpp"
 
@@ -70,6 +71,36 @@ int get_ascii_file_hash(const char* fn, size_t* ret){
 	}
 }
 
+int set_performance_recording(int is_on){
+	try{
+		HMTimer::SetRecording(is_on != 0);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
+
+int get_performance_records(char** json){
+	try{
+		c2cpp::to_char_string(HMTimer::RecordsToJson(), json);
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
+
+int clear_performance_records(){
+	try{
+		HMTimer::ClearRecords();
+		return HMSUCCESS;
+	} catch (std::exception& e){
+		add_error_message(e.what());
+		return HMERROR;
+	}
+}
+
 const char* get_boundary_name(const BoundaryNamesStruct* bnames, int index){
 	for (int i=0; i<bnames->n; ++i){
 		if (bnames->index[i] == index){
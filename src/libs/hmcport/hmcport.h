@@ -33,6 +33,13 @@ int free_voidp_array(void** a);
 int get_last_error_message(char** msg);
 void add_error_message(const char*);
 
+//performance records of matrix solvers and other heavy procedures.
+//is_on = 1/0 switches recording on/off
+int set_performance_recording(int is_on);
+//json array of records gathered so far. Should be freed by free_char_array
+int get_performance_records(char** json);
+int clear_performance_records();
+
 // structure representing boundary-index->boundary-name dictionary
 struct BoundaryNamesStruct{
 	int n;
@@ -0,0 +1,68 @@
+#include "renumgrid.hpp"
+#include "contabs2d.hpp"
+#include "hmgraph.hpp"
+#include "spacefill.hpp"
+#include "hmparallel.hpp"
+
+using namespace HM2D;
+namespace ga = HM2D::Grid::Algos;
+
+namespace{
+
+vector<int> cell_order(const GridData& g, ga::RenumberMethod method){
+	if (method == ga::RenumberMethod::RCM){
+		return HMMath::Graph::RCM(Connectivity::CellCell(g.vcells));
+	}
+	//cell centers as average of edges centers
+	vector<double> cnt(2*g.vcells.size(), 0);
+	HMParallel::For(g.vcells.size(), [&](int i){
+		auto& c = g.vcells[i];
+		for (auto& e: c->edges){
+			cnt[2*i] += e->pfirst()->x + e->plast()->x;
+			cnt[2*i+1] += e->pfirst()->y + e->plast()->y;
+		}
+		cnt[2*i] /= 2*c->edges.size();
+		cnt[2*i+1] /= 2*c->edges.size();
+	}, 10000);
+	if (method == ga::RenumberMethod::HILBERT){
+		return HMMath::SFC::HilbertOrder(cnt, 2);
+	} else {
+		return HMMath::SFC::MortonOrder(cnt, 2);
+	}
+}
+
+//places primitives with non-negative ids to the positions given by ids,
+//others go to the end keeping their order.
+template<class T>
+void apply_ids(ShpVector<T>& data, int nused){
+	ShpVector<T> ret(data.size());
+	int k = nused;
+	for (auto& it: data){
+		if (it->id >= 0) ret[it->id] = it;
+		else ret[k++] = it;
+	}
+	std::swap(ret, data);
+}
+
+}
+
+void ga::RenumberByCells(GridData& g){
+	aa::constant_ids_pvec(g.vedges, -1);
+	aa::constant_ids_pvec(g.vvert, -1);
+	int ie = 0, iv = 0;
+	for (auto& c: g.vcells)
+	for (auto& e: c->edges) if (e->id < 0){
+		e->id = ie++;
+		for (auto& v: e->vertices) if (v->id < 0) v->id = iv++;
+	}
+	apply_ids(g.vedges, ie);
+	apply_ids(g.vvert, iv);
+}
+
+void ga::Renumber(GridData& g, RenumberMethod method){
+	vector<int> ord = cell_order(g, method);
+	CellData newcells(g.vcells.size());
+	for (int i=0; i<ord.size(); ++i) newcells[i] = g.vcells[ord[i]];
+	std::swap(g.vcells, newcells);
+	RenumberByCells(g);
+}
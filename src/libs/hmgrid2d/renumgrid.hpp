@@ -0,0 +1,24 @@
+#ifndef HYBMESH_RENUMGRID_HPP
+#define HYBMESH_RENUMGRID_HPP
+
+#include "primitives2d.hpp"
+
+namespace HM2D{ namespace Grid{ namespace Algos{
+
+enum class RenumberMethod{
+	RCM,      //reverse Cuthill-McKee for cell-cell graph
+	HILBERT,  //cell centers along Hilbert curve
+	MORTON    //cell centers along Morton (z-order) curve
+};
+
+//Reorders grid primitives for better memory locality.
+//Cells are sorted by the given method, edges and vertices
+//are placed in order of their first appearance in sorted cells.
+void Renumber(GridData& g, RenumberMethod method);
+
+//edges and vertices are placed in order of their first appearance in cells
+void RenumberByCells(GridData& g);
+
+}}}
+
+#endif
@@ -21,17 +21,19 @@ struct _ShiftSnapPreCalc{
 	_ShiftSnapPreCalc(GridData& grid, const HM2D::EdgeData& cont,
 			const VertexData& snap_nodes, bool only_corner_points=true): g(&grid){
 		auto cv = HM2D::AllVertices(cont);
+		HM2D::Finder::ClosestPointFinder pfinder(cv);
+		HM2D::Finder::ClosestEdgeFinder efinder(cont);
 		//snapping nodes
 		for (auto p: snap_nodes){
 			//try to search among vertices
-			auto tfpnt = HM2D::Finder::ClosestPoint(cv, *p);
+			auto tfpnt = pfinder.find(*p);
 			Point* fpnt = cv[std::get<0>(tfpnt)].get();
 			if (*fpnt == *p){
 				p->set(*fpnt);
 				continue;
 			}
 			//snap to edge
-			auto fed = HM2D::Finder::ClosestEdge(cont, *p);
+			auto fed = efinder.find(*p);
 			HM2D::Edge* e = cont[std::get<0>(fed)].get();
 			double w = std::get<2>(fed);
 			p->set(Point::Weigh(*e->first(), *e->last(), w));
@@ -214,8 +216,9 @@ GridData Algos::SnapBndSection(const GridData& grid, const EdgeData& cont,
 	vector<Point> np = Contour::WeightPoints(cont, ww);
 	if (snap_strategy == "shift"){
 		auto av = HM2D::AllVertices(cont);
+		HM2D::Finder::ClosestPointFinder finder(av);
 		for (auto& p: np){
-			auto fnd = HM2D::Finder::ClosestPoint(av, p);
+			auto fnd = finder.find(p);
 			p.set(*av[std::get<0>(fnd)]);
 		}
 	}
@@ -16,6 +16,7 @@
 #include "MLine.h"
 #include "nan_handler.h"
 #include "GmshMessage.h"
+#include "hmparallel.hpp"
 using namespace HM2D;
 
 HMCallback::FunctionWithCallback<Mesher::TUnstructuredTriangle> Mesher::UnstructuredTriangle;
@@ -743,6 +744,10 @@ void fill_model_with_2d_recomb(GModel& m, GFace* fc){
 
 GridData gmsh_fill(const Contour::Tree& tree, const CoordinateMap2D<double>& embedded,
 		int algo, HMCallback::Caller2& cb){
+	std::lock_guard<std::mutex> lk(HMParallel::GmshMutex());
+	//gmsh perturbs inserted points using rand().
+	//Seed is reset so that result doesn't depend on the order of gmsh_fill calls.
+	srand(1);
 	GModel m;
 	m.setFactory("Gmsh");
 	//2 - auto, 5 - delaunay, 6 - frontal, 8 - delaunay for quads
@@ -3,6 +3,9 @@
 #include "surface.hpp"
 #include "assemble3d.hpp"
 #include "nodes_compare.h"
+#include "hmparallel.hpp"
+#include <unordered_map>
+#include <cstdint>
 
 using namespace HM3D;
 
@@ -128,6 +131,87 @@ void assemble_duplicate_faces(FaceData& ffrom, FaceData& fto, vector<int>& from,
 	}
 }
 
+//spatial hash of points with geps sized buckets.
+//Points are equal if all their coordinates differ by less than geps,
+//so equal points lie in the same or adjacent buckets.
+struct PointBuckets{
+	struct Key{
+		long long x, y, z;
+		bool operator==(const Key& k) const { return x == k.x && y == k.y && z == k.z; }
+	};
+	struct KeyHash{
+		size_t operator()(const Key& k) const{
+			//unsigned arithmetic wraps around on overflow
+			return (size_t)((uint64_t)k.x*73856093ULL ^
+			                (uint64_t)k.y*19349663ULL ^
+			                (uint64_t)k.z*83492791ULL);
+		}
+	};
+	static Key key(const Point3& p){
+		return Key{(long long)std::floor(p.x/geps),
+		           (long long)std::floor(p.y/geps),
+		           (long long)std::floor(p.z/geps)};
+	}
+
+	PointBuckets(const VertexData& pts, const vector<int>& used): pts(pts){
+		vector<Key> keys(used.size());
+		HMParallel::For(used.size(), [&](int i){ keys[i] = key(*pts[used[i]]); }, 1000);
+		for (int i=0; i<used.size(); ++i) data[keys[i]].push_back(used[i]);
+	}
+
+	//calls fun(index) for all stored points equal to p
+	template<class Fun>
+	void for_equal(const Point3& p, Fun&& fun) const{
+		Key k = key(p);
+		for (long long dx=-1; dx<=1; ++dx)
+		for (long long dy=-1; dy<=1; ++dy)
+		for (long long dz=-1; dz<=1; ++dz){
+			auto fnd = data.find(Key{k.x+dx, k.y+dy, k.z+dz});
+			if (fnd == data.end()) continue;
+			for (int i: fnd->second){
+				const Point3& p2 = *pts[i];
+				if (fabs(p2.x-p.x)<geps && fabs(p2.y-p.y)<geps && fabs(p2.z-p.z)<geps) fun(i);
+			}
+		}
+	}
+
+	const VertexData& pts;
+	std::unordered_map<Key, vector<int>, KeyHash> data;
+};
+
+struct PairHash{
+	size_t operator()(const std::pair<int, int>& p) const{
+		return std::hash<long long>()(((long long)p.first << 32) ^ (unsigned)p.second);
+	}
+};
+
+struct VecHash{
+	size_t operator()(const vector<int>& v) const{
+		size_t ret = v.size();
+		for (int i: v) ret ^= std::hash<int>()(i) + 0x9e3779b9 + (ret << 6) + (ret >> 2);
+		return ret;
+	}
+};
+
+//rep[i] = index of the primitive which replaces i-th one (rep[i] <= i).
+//Resolves chains so that all representatives are final.
+void resolve_rep(vector<int>& rep){
+	for (int i=0; i<rep.size(); ++i) rep[i] = rep[rep[i]];
+}
+
+//leaves data[ids] entries in given order
+template<class C>
+void take_entries(C& data, const vector<int>& ids){
+	if (ids.size() == data.size() &&
+	    std::is_sorted(ids.begin(), ids.end())) return;
+	C d(ids.size());
+	for (int i=0; i<ids.size(); ++i) d[i] = data[ids[i]];
+	std::swap(d, data);
+}
+
+//duplicates are taken from the grid with the lowest index.
+GridData merge_grids(const vector<const GridData*>& grids, bool last_first);
+
 }
 
 void HM3D::Grid::Algos::MergeGrid(GridData& from, GridData& to,
@@ -225,30 +309,159 @@ void HM3D::Grid::Algos::MergeGrid(GridData& from, GridData& to,
 	}
 }
 
-GridData HM3D::Grid::Algos::MergeGrids(const GridData& _g1, const GridData& _g2){
-	//make deep copies of g1, g2
-	GridData g1, g2;
-	DeepCopy(_g1, g1);
-	DeepCopy(_g2, g2);
+GridData HM3D::Grid::Algos::MergeGrids(const GridData& g1, const GridData& g2){
+	//duplicates are taken from g1, g2 primitives go first
+	return merge_grids(vector<const GridData*>{&g1, &g2}, true);
+}
 
-	//assemble coincident points on grid surfaces
-	vector<int> vfrom, vto;
+GridData HM3D::Grid::Algos::MergeGrids(const vector<const GridData*>& grids){
+	return merge_grids(grids, false);
+}
 
-	auto srf1 = Surface::Assembler::GridSurface(g1);
-	auto srf2 = Surface::Assembler::GridSurface(g2);
-	auto pc1 = AllVertices(srf1);
-	auto pc2 = AllVertices(srf2);
-	aa::enumerate_ids_pvec(g1.vvert);
-	aa::enumerate_ids_pvec(g2.vvert);
+namespace{
+GridData merge_grids(const vector<const GridData*>& grids, bool last_first){
+	//1. deep copies of all grids are concatenated.
+	//   owners of primitives are indices of their grids.
+	GridData ret;
+	vector<int> vown, eown, fown, cown;
+	for (int k=0; k<grids.size(); ++k){
+		GridData g;
+		DeepCopy(*grids[k], g);
+		ret.vvert.insert(ret.vvert.end(), g.vvert.begin(), g.vvert.end());
+		ret.vedges.insert(ret.vedges.end(), g.vedges.begin(), g.vedges.end());
+		ret.vfaces.insert(ret.vfaces.end(), g.vfaces.begin(), g.vfaces.end());
+		for (auto c: g.vcells) if (c->faces.size() > 1) ret.vcells.push_back(c);
+		vown.resize(ret.vvert.size(), k);
+		eown.resize(ret.vedges.size(), k);
+		fown.resize(ret.vfaces.size(), k);
+		cown.resize(ret.vcells.size(), k);
+	}
+	if (grids.size() < 2) return ret;
+	aa::enumerate_ids_pvec(ret.vvert);
+	aa::enumerate_ids_pvec(ret.vedges);
+	aa::enumerate_ids_pvec(ret.vfaces);
 
-	auto pc1set = point3_set_pointers(pc1);
-	for (auto it2: pc2){
-		int fnd = pc1set.find(it2->x, it2->y, it2->z);
-		if (fnd == -1) continue;
-		vfrom.push_back(pc1[fnd]->id);
-		vto.push_back(it2->id);
+	//2. boundary primitives
+	vector<int> bfaces, bedges, bvert;
+	vector<char> is_bedge(ret.vedges.size(), 0), is_bvert(ret.vvert.size(), 0);
+	for (int i=0; i<ret.vfaces.size(); ++i) if (ret.vfaces[i]->is_boundary()){
+		bfaces.push_back(i);
+		for (auto& e: ret.vfaces[i]->edges){
+			is_bedge[e->id] = 1;
+			is_bvert[e->first()->id] = 1;
+			is_bvert[e->last()->id] = 1;
+		}
 	}
+	for (int i=0; i<ret.vedges.size(); ++i) if (is_bedge[i]) bedges.push_back(i);
+	for (int i=0; i<ret.vvert.size(); ++i) if (is_bvert[i]) bvert.push_back(i);
 
-	MergeGrid(g1, g2, vfrom, vto);
-	return g2;
+	//3. vertices welding.
+	//   Each boundary vertex is replaced by an equal vertex with the lowest index
+	//   from a grid with a lower index.
+	vector<int> vrep(ret.vvert.size());
+	for (int i=0; i<vrep.size(); ++i) vrep[i] = i;
+	{
+		PointBuckets buckets(ret.vvert, bvert);
+		HMParallel::For(bvert.size(), [&](int i){
+			int iv = bvert[i];
+			buckets.for_equal(*ret.vvert[iv], [&](int j){
+				if (vown[j] < vown[iv] && j < vrep[iv]) vrep[iv] = j;
+			});
+		}, 1000);
+	}
+	resolve_rep(vrep);
+	//internal edges could also end at boundary vertices
+	HMParallel::For(ret.vedges.size(), [&](int i){
+		auto& e = ret.vedges[i];
+		int i0 = e->first()->id, i1 = e->last()->id;
+		if (vrep[i0] != i0) e->vertices[0] = ret.vvert[vrep[i0]];
+		if (vrep[i1] != i1) e->vertices.back() = ret.vvert[vrep[i1]];
+	}, 1000);
+
+	//4. edges matching by their end vertices
+	vector<int> erep(ret.vedges.size());
+	for (int i=0; i<erep.size(); ++i) erep[i] = i;
+	{
+		vector<std::pair<int, int>> keys(bedges.size());
+		HMParallel::For(bedges.size(), [&](int i){
+			auto& e = ret.vedges[bedges[i]];
+			keys[i] = std::minmax(e->first()->id, e->last()->id);
+		}, 1000);
+		std::unordered_map<std::pair<int, int>, int, PairHash> emap(2*bedges.size());
+		for (int i=0; i<bedges.size(); ++i){
+			auto r = emap.emplace(keys[i], bedges[i]);
+			if (!r.second && eown[r.first->second] != eown[bedges[i]]){
+				erep[bedges[i]] = r.first->second;
+			}
+		}
+	}
+	resolve_rep(erep);
+	HMParallel::For(ret.vfaces.size(), [&](int i){
+		for (auto& e: ret.vfaces[i]->edges) if (erep[e->id] != e->id){
+			e = ret.vedges[erep[e->id]];
+		}
+	}, 1000);
+
+	//5. faces matching by their edges sets
+	vector<int> frep(ret.vfaces.size());
+	for (int i=0; i<frep.size(); ++i) frep[i] = i;
+	{
+		vector<vector<int>> keys(bfaces.size());
+		HMParallel::For(bfaces.size(), [&](int i){
+			auto& f = ret.vfaces[bfaces[i]];
+			keys[i].resize(f->edges.size());
+			for (int j=0; j<f->edges.size(); ++j) keys[i][j] = f->edges[j]->id;
+			std::sort(keys[i].begin(), keys[i].end());
+		}, 1000);
+		std::unordered_map<vector<int>, int, VecHash> fmap(2*bfaces.size());
+		for (int i=0; i<bfaces.size(); ++i){
+			auto r = fmap.emplace(std::move(keys[i]), bfaces[i]);
+			if (r.second) continue;
+			auto& fbase = ret.vfaces[r.first->second];
+			auto& fdup = ret.vfaces[bfaces[i]];
+			if (fown[r.first->second] == fown[bfaces[i]] || !fbase->is_boundary()) continue;
+			frep[bfaces[i]] = r.first->second;
+			//change face->cells connectivity
+			auto cdup = (fdup->has_left_cell()) ? fdup->left.lock() : fdup->right.lock();
+			fbase->has_left_cell() ? fbase->right = cdup : fbase->left = cdup;
+			auto ind = std::find(cdup->faces.begin(), cdup->faces.end(), fdup) - cdup->faces.begin();
+			assert(ind < cdup->faces.size());
+			cdup->faces[ind] = fbase;
+		}
+	}
+
+	//6. remove replaced primitives.
+	//   If last_first is set primitives of the last grid go first
+	//   with duplicates substituted in place, others follow them.
+	int last = grids.size() - 1;
+	auto order = [&](const vector<int>& rep, const vector<int>& own, vector<int>& ids){
+		ids.clear();
+		if (!last_first){
+			for (int i=0; i<rep.size(); ++i) if (rep[i] == i) ids.push_back(i);
+			return;
+		}
+		vector<char> taken(rep.size(), 0);
+		for (int i=0; i<rep.size(); ++i) if (own[i] == last && !taken[rep[i]]){
+			ids.push_back(rep[i]);
+			taken[rep[i]] = 1;
+		}
+		for (int i=0; i<rep.size(); ++i) if (own[i] != last && rep[i] == i && !taken[i]){
+			ids.push_back(i);
+		}
+	};
+	vector<int> used;
+	order(vrep, vown, used);
+	take_entries(ret.vvert, used);
+	order(erep, eown, used);
+	take_entries(ret.vedges, used);
+	order(frep, fown, used);
+	take_entries(ret.vfaces, used);
+	if (last_first){
+		vector<int> crep(ret.vcells.size());
+		for (int i=0; i<crep.size(); ++i) crep[i] = i;
+		order(crep, cown, used);
+		take_entries(ret.vcells, used);
+	}
+	return ret;
+}
 }
@@ -10,9 +10,17 @@ namespace HM3D{ namespace Grid{ namespace Algos{
 void MergeGrid(GridData& from, GridData& to,
 		const vector<int>& from_vert, const vector<int>& to_vert);
 
-//deep copied grid, constructed from g1 and g2 will be returned
+//deep copied grid, constructed from g1 and g2 will be returned.
+//Duplicate primitives are taken from g1.
+//Primitives of g2 go first keeping their positions, the rest of g1 follows them.
 GridData MergeGrids(const GridData& g1, const GridData& g2);
 
+//deep copied grid, constructed from all grids will be returned.
+//Coincident boundary primitives of different grids are welded in a single pass.
+//Duplicate primitives are taken from the grid with the lowest index.
+//Primitives of the result keep the order of input grids.
+GridData MergeGrids(const vector<const GridData*>& grids);
+
 
 }}}
 
@@ -1,6 +1,6 @@
 #include "pyramid_layer.hpp"
 #include "debug3d.hpp"
-#include <unordered_map>
+#include "hmparallel.hpp"
 
 using namespace HM3D;
 namespace{
@@ -14,6 +14,8 @@ CellData single_face_cells(const FaceData& fc){
 	return ret;
 }
 
+//Builds pyramids on faces of the limiting surface.
+//Cell index should equal index of its base face in the limits array.
 struct PyrConstructor{
 	PyrConstructor(const FaceData& limits){
 		limvertices = AllVertices(limits);
@@ -21,41 +23,43 @@ struct PyrConstructor{
 		double L = bball.maxlen() / 30.0;
 		bbfinder.reset(new BoundingBox3DFinder(bball, L));
 		aa::enumerate_ids_pvec(limvertices);
-		limfaces.resize(limits.size());
+
+		//flat face-vertex table
+		vector<vector<int>> fv(limits.size());
+		vector<BoundingBox3D> fbb(limits.size());
+		HMParallel::For(limits.size(), [&](int i){
+			auto av = limits[i]->sorted_vertices();
+			fv[i].resize(av.size());
+			for (int j=0; j<av.size(); ++j) fv[i][j] = av[j]->id;
+			fbb[i] = BoundingBox3D(av);
+		}, 1000);
+		limstart.resize(limits.size() + 1, 0);
+		for (int i=0; i<limits.size(); ++i){
+			limstart[i+1] = limstart[i] + fv[i].size();
+		}
+		limnodes.resize(limstart.back());
 		for (int i=0; i<limits.size(); ++i){
-			auto f = limits[i].get();
-			auto av = f->sorted_vertices();
-			limfaces[i].resize(av.size());
-			for (int j=0; j<av.size(); ++j)
-				limfaces[i][j] = av[j]->id;
-			BoundingBox3D avbb(av);
-			bbfinder->addentry(avbb);
-			faceind[f] = i;
+			std::copy(fv[i].begin(), fv[i].end(), limnodes.begin() + limstart[i]);
+			bbfinder->addentry(fbb[i]);
 		}
 	}
 
-	void build_pyramid(shared_ptr<Cell>& c){
-		auto fc = c->faces[0];
-		auto ap = fc->sorted_vertices();
+	//pyramids for the given cells are built concurrently
+	void build_pyramids(CellData& cells, const vector<int>& icells){
+		HMParallel::For(icells.size(), [&](int k){
+			build_pyramid(cells[icells[k]], icells[k]);
+		}, 1000);
+	}
 
-		Point3 cnt(0, 0, 0);
-		double area = 0.;
-		Vect3 rnrm = right_normal(*ap[0], *ap[1], *ap[2]);
-		for (int i=1; i<ap.size() - 1; ++i){
-			Point3 c1 = (*ap[0] + *ap[i] + *ap[i+1]) / 3.;
-			double a1 = 0.5 * vecDot(vecCross(*ap[i] - *ap[0], *ap[i+1] - *ap[0]), rnrm);
-			area += a1;
-			cnt += c1 * a1;
-		}
-		assert(area > 0);
-		cnt /= area;
-		double len = 0.5 * sqrt(area);
-		rnrm *= (len);
-		shared_ptr<Vertex> vert(new Vertex(cnt - rnrm));
-		no_cross_check(c->faces[0].get(), cnt, *vert);
+	void build_pyramid(shared_ptr<Cell>& c, int iface){
+		assert(c->faces.size() == 1);
+		Point3 vert = apex(iface);
+		shared_ptr<Vertex> pv(new Vertex(vert));
 
 		EdgeData edges;
-		for (auto& v: ap) edges.emplace_back(new Edge(v, vert));
+		for (int k=limstart[iface]; k<limstart[iface+1]; ++k){
+			edges.emplace_back(new Edge(limvertices[limnodes[k]], pv));
+		}
 		//build pyramid faces
 		for (int n=0; n<edges.size(); ++n){
 			int nnext = (n == edges.size() - 1) ? 0 : n+1;
@@ -70,27 +74,52 @@ struct PyrConstructor{
 		c->faces[0]->left = c;
 		for (int i=1; i<c->faces.size(); ++i) c->faces[i]->right=c;
 	}
+
+	//vertices of the i-th face in sorted order
+	int face_size(int i) const { return limstart[i+1] - limstart[i]; }
+	const Vertex& face_vertex(int i, int j) const { return *limvertices[limnodes[limstart[i] + j]]; }
+	const Vertex* face_pvertex(int i, int j) const { return limvertices[limnodes[limstart[i] + j]].get(); }
 private:
 	static constexpr double CROSSLIMIT = 3;
 	shared_ptr<BoundingBox3DFinder> bbfinder;
 	VertexData limvertices;
-	vector<vector<int>> limfaces;
-	std::unordered_map<const Face*, int> faceind;
+	vector<int> limstart, limnodes;
 
-	void no_cross_check(const Face* srcface, const Point3& start, Point3& end){
+	Point3 apex(int iface) const{
+		int n = face_size(iface);
+		const Vertex& p0 = face_vertex(iface, 0);
+		Point3 cnt(0, 0, 0);
+		double area = 0.;
+		Vect3 rnrm = right_normal(p0, face_vertex(iface, 1), face_vertex(iface, 2));
+		for (int i=1; i<n - 1; ++i){
+			const Vertex& pi = face_vertex(iface, i);
+			const Vertex& pi1 = face_vertex(iface, i+1);
+			Point3 c1 = (p0 + pi + pi1) / 3.;
+			double a1 = 0.5 * vecDot(vecCross(pi - p0, pi1 - p0), rnrm);
+			area += a1;
+			cnt += c1 * a1;
+		}
+		assert(area > 0);
+		cnt /= area;
+		double len = 0.5 * sqrt(area);
+		rnrm *= (len);
+		Point3 ret = cnt - rnrm;
+		no_cross_check(iface, cnt, ret);
+		return ret;
+	}
+
+	void no_cross_check(int iface, const Point3& start, Point3& end) const{
 		Point3 plus = Point3::Weigh(start, end, CROSSLIMIT);
 		BoundingBox3D bbox(start, plus);
 		vector<int> cind = bbfinder->suspects(bbox);
 		double ksimin = 1;
 		double xke[3];
-		int iface = faceind[srcface];
 		for (int i: cind) if (i!=iface){
-			vector<int>& nds = limfaces[i];
-			auto& p0 = *limvertices[nds[0]];
-			for (int j=1; j<nds.size()-1; ++j){
+			auto& p0 = face_vertex(i, 0);
+			for (int j=1; j<face_size(i)-1; ++j){
 				bool tricross = segment_triangle_cross3d(
 					start, plus, 
-					p0, *limvertices[nds[j]], *limvertices[nds[j+1]],
+					p0, face_vertex(i, j), face_vertex(i, j+1),
 					xke);
 				if (tricross){
 					//found cross
@@ -145,6 +174,26 @@ bool reentrant_base(const Face& f1, const Face& f2){
 	return true;
 }
 
+//same as reentrant_base for input faces given by their indices
+bool reentrant_base(const PyrConstructor& pc, int f1, int f2){
+	const Vertex& p0 = pc.face_vertex(f1, 0);
+	//right normal
+	Vect3 plane = vecCross(pc.face_vertex(f1, 1) - p0, pc.face_vertex(f1, 2) - p0);
+	double d = -vecDot(plane, p0);
+	int n1 = pc.face_size(f1), n2 = pc.face_size(f2);
+	for (int j=0; j<n2; ++j){
+		const Vertex* p = pc.face_pvertex(f2, j);
+		bool fnd = false;
+		for (int i=0; i<n1; ++i) if (pc.face_pvertex(f1, i) == p) { fnd = true; break; }
+		if (fnd) continue;
+		double s = vecDot(plane, *p) + d;
+		return ISEQGREATER(s, 0.);
+	}
+	//faces have equal nodes
+	//angle is 2pi
+	return true;
+}
+
 bool has_pyramid(const Cell& c1){
 	return c1.faces.size() > 3;
 }
@@ -200,19 +249,17 @@ struct PyrVertices{
 		std::set<Point3> origverts;
 		std::set<shared_ptr<Vertex>> pyrverts;
 		Point3 vertex;
-		bool has_cell(int icell){
-			return icells.find(icell) != icells.end();
-		}
 		void add_cell(int c1, shared_ptr<Vertex> v1){
 			icells.insert(c1);
 			origverts.insert(*v1);
 			pyrverts.insert(v1);
 			assign_vertex();
 		}
-		void merge_with(const pyr_group& g){
+		void merge_with(pyr_group& g){
 			icells.insert(g.icells.begin(), g.icells.end());
 			origverts.insert(g.origverts.begin(), g.origverts.end());
 			pyrverts.insert(g.pyrverts.begin(), g.pyrverts.end());
+			g.icells.clear(); g.origverts.clear(); g.pyrverts.clear();
 			assign_vertex();
 		}
 		void assign_vertex(){
@@ -222,27 +269,29 @@ struct PyrVertices{
 			for (auto& pv: pyrverts) pv->set(vertex);
 		}
 	};
-	std::list<pyr_group> groups;
+	//groups[cell_group[i]] contains i-th cell. Merged groups are left empty.
+	vector<pyr_group> groups;
+	vector<int> cell_group;
 	void add_to_group(int c1, int c2, shared_ptr<Vertex> v1, shared_ptr<Vertex> v2){
-		std::list<pyr_group>::iterator fnd1=groups.end();
-		std::list<pyr_group>::iterator fnd2=groups.end();
-		for (auto it=groups.begin(); it!=groups.end(); ++it){
-			if (it->has_cell(c1)) fnd1 = it;
-			if (it->has_cell(c2)) fnd2 = it;
-		}
-		if (fnd1 == groups.end() && fnd2 == groups.end()){
+		int g1 = cell_group[c1], g2 = cell_group[c2];
+		if (g1 < 0 && g2 < 0){
+			cell_group[c1] = cell_group[c2] = groups.size();
 			groups.emplace_back(c1, c2, v1, v2);
-		} else if (fnd1 != groups.end() && fnd2 == groups.end()){
-			fnd1->add_cell(c2, v2);
-		} else if (fnd1 == groups.end() && fnd2 != groups.end()){
-			fnd2->add_cell(c1, v1);
-		} else if (fnd1 != fnd2){
-			fnd1->merge_with(*fnd2);
-			groups.erase(fnd2);
+		} else if (g1 >= 0 && g2 < 0){
+			cell_group[c2] = g1;
+			groups[g1].add_cell(c2, v2);
+		} else if (g1 < 0 && g2 >= 0){
+			cell_group[c1] = g2;
+			groups[g2].add_cell(c1, v1);
+		} else if (g1 != g2){
+			//smaller group is merged into larger one
+			if (groups[g1].icells.size() < groups[g2].icells.size()) std::swap(g1, g2);
+			for (int i: groups[g2].icells) cell_group[i] = g1;
+			groups[g1].merge_with(groups[g2]);
 		}
 	}
 
-	PyrVertices(CellData& cd): cd(cd){}
+	PyrVertices(CellData& cd): cd(cd), cell_group(cd.size(), -1){}
 
 	void merge(int c1, int c2, PyrConstructor& pc){
 		//build pyramids if they are absent
@@ -271,12 +320,12 @@ struct PyrVertices{
 
 	void supplementary_merge(PyrConstructor& pc){
 		//guarantee that all links within the group were merged
-		for (auto g: groups) merge_group(g.icells, g.vertex);
+		for (auto& g: groups) if (g.icells.size() > 0) merge_group(g.icells, g.vertex);
 	}
 
 private:
 	void tripyramid(int c, int ivert, PyrConstructor& pc){
-		pc.build_pyramid(cd[c]);
+		pc.build_pyramid(cd[c], c);
 	}
 	void merge_group(const std::set<int>& g, Point3 vertex){
 		FaceData lfaces;
@@ -327,15 +376,20 @@ void merge_pyramids(CellData& cells, double merge_angle, PyrConstructor& pc){
 	//cell-edge-cell connections
 	vector<std::pair<int, int>> cec = edge_cells_table(cells);
 
-	//loop over all cell-edge-cell connections
-	for (auto ec: cec){
+	//base faces relations do not depend on pyramids
+	vector<char> reent(cec.size());
+	HMParallel::For(cec.size(), [&](int i){
+		reent[i] = reentrant_base(pc, cec[i].first, cec[i].second);
+	}, 1000);
+
+	//loop over all cell-edge-cell connections.
+	//Merging changes pyramid vertices, hence it is done sequentially.
+	for (int i=0; i<cec.size(); ++i){
+		auto& ec = cec[i];
 		Cell& c1 = *cells[ec.first];
 		Cell& c2 = *cells[ec.second];
 		if (has_pyramid(c1) == false && has_pyramid(c2) == false) continue;
-
-		Face& base1 = *c1.faces[0];
-		Face& base2 = *c2.faces[0];
-		if (reentrant_base(base1, base2)) continue;
+		if (reent[i]) continue;
 
 		if (need_merge(c1, c2, merge_angle))
 			pv.merge(ec.first, ec.second, pc);
@@ -362,10 +416,12 @@ GridData HM3D::Grid::Constructor::BuildPyramidLayer(const FaceData& faces,
 		PyrConstructor constructor(faces);
 
 		//build initial pyramids
-		for (auto c: ac){
-			if (non3only && c->faces[0]->edges.size() < 4) continue;
-			constructor.build_pyramid(c);
+		vector<int> icells;
+		for (int i=0; i<ac.size(); ++i){
+			if (non3only && ac[i]->faces[0]->edges.size() < 4) continue;
+			icells.push_back(i);
 		}
+		constructor.build_pyramids(ac, icells);
 
 		//merge pyramids
 		merge_pyramids(ac, merge_angle, constructor);
@@ -0,0 +1,75 @@
+#include "renumber3d.hpp"
+#include "contabs3d.hpp"
+#include "hmgraph.hpp"
+#include "spacefill.hpp"
+#include "hmparallel.hpp"
+
+using namespace HM3D;
+namespace ga = HM3D::Grid::Algos;
+
+namespace{
+
+vector<int> cell_order(const GridData& g, ga::RenumberMethod method){
+	if (method == ga::RenumberMethod::RCM){
+		return HMMath::Graph::RCM(Connectivity::CellCell(g.vcells));
+	}
+	//cell centers as average of face edges centers
+	vector<double> cnt(3*g.vcells.size(), 0);
+	HMParallel::For(g.vcells.size(), [&](int i){
+		int n = 0;
+		for (auto& f: g.vcells[i]->faces)
+		for (auto& e: f->edges){
+			cnt[3*i] += e->pfirst()->x + e->plast()->x;
+			cnt[3*i+1] += e->pfirst()->y + e->plast()->y;
+			cnt[3*i+2] += e->pfirst()->z + e->plast()->z;
+			n += 2;
+		}
+		if (n > 0) for (int k=0; k<3; ++k) cnt[3*i+k] /= n;
+	}, 10000);
+	if (method == ga::RenumberMethod::HILBERT){
+		return HMMath::SFC::HilbertOrder(cnt, 3);
+	} else {
+		return HMMath::SFC::MortonOrder(cnt, 3);
+	}
+}
+
+//places primitives with non-negative ids to the positions given by ids,
+//others go to the end keeping their order.
+template<class T>
+void apply_ids(ShpVector<T>& data, int nused){
+	ShpVector<T> ret(data.size());
+	int k = nused;
+	for (auto& it: data){
+		if (it->id >= 0) ret[it->id] = it;
+		else ret[k++] = it;
+	}
+	std::swap(ret, data);
+}
+
+}
+
+void ga::RenumberByCells(GridData& g){
+	aa::constant_ids_pvec(g.vfaces, -1);
+	aa::constant_ids_pvec(g.vedges, -1);
+	aa::constant_ids_pvec(g.vvert, -1);
+	int iface = 0, ie = 0, iv = 0;
+	for (auto& c: g.vcells)
+	for (auto& f: c->faces) if (f->id < 0){
+		f->id = iface++;
+		for (auto& e: f->edges) if (e->id < 0){
+			e->id = ie++;
+			for (auto& v: e->vertices) if (v->id < 0) v->id = iv++;
+		}
+	}
+	apply_ids(g.vfaces, iface);
+	apply_ids(g.vedges, ie);
+	apply_ids(g.vvert, iv);
+}
+
+void ga::Renumber(GridData& g, RenumberMethod method){
+	vector<int> ord = cell_order(g, method);
+	CellData newcells(g.vcells.size());
+	for (int i=0; i<ord.size(); ++i) newcells[i] = g.vcells[ord[i]];
+	std::swap(g.vcells, newcells);
+	RenumberByCells(g);
+}
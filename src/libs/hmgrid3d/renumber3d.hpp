@@ -0,0 +1,24 @@
+#ifndef HMGRID3D_RENUMBER_HPP
+#define HMGRID3D_RENUMBER_HPP
+
+#include "primitives3d.hpp"
+
+namespace HM3D{ namespace Grid{ namespace Algos{
+
+enum class RenumberMethod{
+	RCM,      //reverse Cuthill-McKee for cell-cell graph
+	HILBERT,  //cell centers along Hilbert curve
+	MORTON    //cell centers along Morton (z-order) curve
+};
+
+//Reorders grid primitives for better memory locality.
+//Cells are sorted by the given method; faces, edges and vertices
+//are placed in order of their first appearance in sorted cells.
+void Renumber(GridData& g, RenumberMethod method);
+
+//faces, edges and vertices are placed in order of their first appearance in cells
+void RenumberByCells(GridData& g);
+
+}}}
+
+#endif
@@ -1,8 +1,13 @@
 #include "hmgrid3d.hpp"
+#include "merge3d.hpp"
+#include "renumber3d.hpp"
+#include "contabs3d.hpp"
 #include <fstream>
 #include "debug3d.hpp"
 #include "hmtesting.hpp"
 #include "hmtimer.hpp"
+#include "pyramid_layer.hpp"
+#include "tetgen_fill.hpp"
 #include "buildgrid.hpp"
 #include "unite_grids.hpp"
 #include "healgrid.hpp"
@@ -519,6 +524,261 @@ void test10(){
 	}
 }
 
+void test11(){
+	std::cout<<"11. Merging of multiple grids"<<std::endl;
+	vector<HM3D::GridData> gs;
+	for (int i=0; i<2; ++i)
+	for (int j=0; j<2; ++j){
+		gs.push_back(HM3D::Grid::Constructor::Cuboid({double(i), double(j), 0}, 1, 1, 1, 2, 2, 2));
+	}
+	vector<const HM3D::GridData*> pgs;
+	for (auto& g: gs) pgs.push_back(&g);
+	auto g1 = HM3D::Grid::Algos::MergeGrids(pgs);
+	add_check(g1.vvert.size() == 75 && g1.vedges.size() == 170 &&
+	          g1.vfaces.size() == 128 && g1.vcells.size() == 32,
+	          "primitives number");
+	int nbnd = 0;
+	for (auto f: g1.vfaces) if (f->is_boundary()) ++nbnd;
+	add_check(nbnd == 64 && ISEQ(HM3D::SumVolumes(g1.vcells), 4), "boundary faces and volume");
+
+	auto g2 = HM3D::Grid::Algos::MergeGrids(gs[0], gs[1]);
+	g2 = HM3D::Grid::Algos::MergeGrids(g2, gs[2]);
+	g2 = HM3D::Grid::Algos::MergeGrids(g2, gs[3]);
+	add_check(g2.vvert.size() == 75 && g2.vedges.size() == 170 &&
+	          g2.vfaces.size() == 128 && g2.vcells.size() == 32,
+	          "pairwise merging");
+
+	//duplicate primitives origin
+	HM3D::GridData c1 = HM3D::Grid::Constructor::Cuboid({0, 0, 0}, 1, 1, 1, 1, 1, 1);
+	HM3D::GridData c2 = HM3D::Grid::Constructor::Cuboid({1, 0, 0}, 1, 1, 1, 1, 1, 1);
+	for (auto f: c1.vfaces) f->boundary_type = 1;
+	for (auto f: c2.vfaces) f->boundary_type = 2;
+	auto shared_face = [](const HM3D::GridData& g)->shared_ptr<HM3D::Face>{
+		for (auto f: g.vfaces) if (!f->is_boundary()) return f;
+		return nullptr;
+	};
+	auto g3 = HM3D::Grid::Algos::MergeGrids(c1, c2);
+	auto f3 = shared_face(g3);
+	int n2 = 0;
+	for (int i=0; i<6; ++i) if (g3.vfaces[i]->boundary_type == 2) ++n2;
+	add_check(g3.vfaces.size() == 11 && f3 && f3->boundary_type == 1 &&
+	          n2 == 5 && g3.vfaces[10]->boundary_type == 1 &&
+	          g3.vvert[0]->x == 1 && g3.vvert.back()->x == 0,
+	          "pairwise merging: duplicates from the first grid");
+	auto g4 = HM3D::Grid::Algos::MergeGrids(vector<const HM3D::GridData*>{&c2, &c1});
+	auto f4 = shared_face(g4);
+	add_check(g4.vfaces.size() == 11 && f4 && f4->boundary_type == 2 &&
+	          g4.vfaces[0]->boundary_type == 2 && g4.vfaces[10]->boundary_type == 1,
+	          "multiple merging: duplicates from the lowest index grid");
+}
+
+void test12(){
+	std::cout<<"12. Grid renumbering"<<std::endl;
+	auto g = HM3D::Grid::Constructor::Cuboid({0, 0, 0}, 1, 2, 3, 7, 5, 4);
+	//shuffle cells
+	for (int i=0; i<g.vcells.size(); ++i){
+		std::swap(g.vcells[i], g.vcells[(i*47) % g.vcells.size()]);
+	}
+	auto bandwidth = [](const HM3D::GridData& g){
+		auto cc = HM3D::Connectivity::CellCell(g.vcells);
+		int ret = 0;
+		for (int i=0; i<cc.size(); ++i)
+		for (int j: cc[i]) ret = std::max(ret, std::abs(i-j));
+		return ret;
+	};
+	int bw0 = bandwidth(g);
+	double vol = HM3D::SumVolumes(g.vcells);
+	auto check = [&](HM3D::Grid::Algos::RenumberMethod m, std::string nm){
+		HM3D::GridData g1;
+		HM3D::DeepCopy(g, g1);
+		HM3D::Grid::Algos::Renumber(g1, m);
+		bool ok = g1.vvert.size() == 240 && g1.vedges.size() == 602 &&
+		          g1.vfaces.size() == 503 && g1.vcells.size() == 140 &&
+		          ISEQ(HM3D::SumVolumes(g1.vcells), vol);
+		//primitives order follows first appearance in cells
+		aa::enumerate_ids_pvec(g1.vfaces);
+		aa::enumerate_ids_pvec(g1.vvert);
+		ok = ok && g1.vcells[0]->faces[0]->id == 0 &&
+		     g1.vfaces[0]->edges[0]->pfirst()->id == 0;
+		add_check(ok, nm + " primitives");
+		return bandwidth(g1);
+	};
+	int bw1 = check(HM3D::Grid::Algos::RenumberMethod::RCM, "rcm");
+	add_check(bw1 < bw0 && bw1 <= 7*5+1, "rcm bandwidth");
+	int bw2 = check(HM3D::Grid::Algos::RenumberMethod::HILBERT, "hilbert");
+	int bw3 = check(HM3D::Grid::Algos::RenumberMethod::MORTON, "morton");
+	add_check(bw2 < bw0 && bw3 < bw0, "curves bandwidth");
+}
+
+void test13(){
+	std::cout<<"13. Concurrent tetrahedral meshing of disjoint domains"<<std::endl;
+	HM3D::FaceData srf;
+	for (int i=0; i<4; ++i){
+		auto g = HM3D::Grid::Constructor::Cuboid({3.0*i, 0, 0}, 1, 1+i, 1, 4, 4, 4);
+		auto s = HM3D::Surface::Assembler::GridSurface(g);
+		srf.insert(srf.end(), s.begin(), s.end());
+	}
+	auto g1 = HM3D::Mesher::UnstructuredTetrahedral(srf, 1);
+	auto g2 = HM3D::Mesher::UnstructuredTetrahedral(srf, 4);
+	add_check(ISEQ(HM3D::SumVolumes(g1.vcells), 10) &&
+	          ISEQ(HM3D::SumVolumes(g2.vcells), 10), "volumes");
+	//gmsh resolves degenerate (cospherical) Delaunay configurations of cuboid vertices
+	//depending on memory addresses, so only vertices and boundaries are compared.
+	int nb1 = 0, nb2 = 0;
+	for (auto f: g1.vfaces) if (f->is_boundary()) ++nb1;
+	for (auto f: g2.vfaces) if (f->is_boundary()) ++nb2;
+	add_check(g1.vvert.size() == g2.vvert.size() && nb1 == nb2,
+	          "serial and concurrent results");
+
+	if (!HM3D::Mesher::TetgenAvailable()) return;
+	//tetgen domains are meshed concurrently,
+	//callback is called from the calling thread only
+	auto tetgen = HM3D::Mesher::TetrahedralBackend::TETGEN;
+	auto t1 = HM3D::Mesher::UnstructuredTetrahedral(srf, 1, tetgen);
+	std::thread::id caller = std::this_thread::get_id();
+	bool other_thread = false;
+	double domains_progress = -1;
+	auto cb = [&](const char* n1, const char* n2, double p1, double p2)->int{
+		if (std::this_thread::get_id() != caller) other_thread = true;
+		if (std::string(n2) == "Meshing domains") domains_progress = p2;
+		return HMCallback::OK;
+	};
+	auto t2 = HM3D::Mesher::UnstructuredTetrahedral.WithCallback(cb, srf, 4, tetgen);
+	add_check(ISEQ(HM3D::SumVolumes(t2.vcells), 10) &&
+	          t1.vvert.size() == t2.vvert.size() &&
+	          t1.vcells.size() == t2.vcells.size(), "concurrent tetgen meshing");
+	add_check(!other_thread && domains_progress > 0, "callback from calling thread");
+
+	//cancellation from the calling thread
+	auto cancel = [](const char* n1, const char* n2, double p1, double p2)->int{
+		return (std::string(n2) == "Meshing domains" && p2 > 0) ? HMCallback::CANCEL : HMCallback::OK;
+	};
+	bool cancelled = false;
+	try{
+		HM3D::Mesher::UnstructuredTetrahedral.WithCallback(cancel, srf, 4, tetgen);
+	} catch (HMCallback::Cancelled& e){
+		cancelled = true;
+	}
+	add_check(cancelled, "concurrent meshing cancellation");
+}
+
+void test14(){
+	std::cout<<"14. Tetrahedral meshing backends benchmark"<<std::endl;
+	if (!HM3D::Mesher::TetgenAvailable()){
+		bool thrown = false;
+		try{
+			auto srf = HM3D::Surface::Assembler::GridSurface(
+				HM3D::Grid::Constructor::Cuboid({0, 0, 0}, 1, 1, 1, 2, 2, 2));
+			HM3D::Mesher::UnstructuredTetrahedral(srf, 1,
+				HM3D::Mesher::TetrahedralBackend::TETGEN);
+		} catch (std::runtime_error& e){
+			thrown = true;
+		}
+		add_check(thrown, "tetgen is not available");
+		return;
+	}
+	//surface of 6750 quadrangles
+	auto g1 = HM3D::Grid::Constructor::Cuboid({0, 0, 0}, 1, 1, 1, 30, 30, 30);
+	auto g2 = HM3D::Grid::Constructor::Cuboid({0.3, 0.3, 0.3}, 0.3, 0.3, 0.3, 15, 15, 15);
+	auto srf = HM3D::Surface::Assembler::GridSurface(g1);
+	auto s2 = HM3D::Surface::Assembler::GridSurface(g2);
+	srf.insert(srf.end(), s2.begin(), s2.end());
+
+	HMTimer::ClearRecords();
+	HMTimer::SetRecording(true);
+	//TetGen goes first since it builds a coarser mesh
+	//and peak memory growth of the second call counts only memory
+	//exceeding the peak reached by the first one.
+	auto r1 = HM3D::Mesher::UnstructuredTetrahedral(srf, 1,
+			HM3D::Mesher::TetrahedralBackend::TETGEN);
+	auto r2 = HM3D::Mesher::UnstructuredTetrahedral(srf, 1,
+			HM3D::Mesher::TetrahedralBackend::GMSH);
+	HMTimer::SetRecording(false);
+	auto recs = HMTimer::Records();
+	HMTimer::ClearRecords();
+	add_check(recs.size() == 2 && recs[0].name == "TetGen" && recs[1].name == "gmsh", "records");
+	if (recs.size() != 2) return;
+	auto field = [&recs](int i, std::string key)->double{
+		for (auto& f: recs[i].fields) if (f.first == key) return f.second;
+		return -1;
+	};
+	bool samekeys = recs[0].fields.size() == recs[1].fields.size();
+	for (int i=0; samekeys && i<recs[0].fields.size(); ++i){
+		samekeys = recs[0].fields[i].first == recs[1].fields[i].first;
+	}
+	add_check(samekeys &&
+	          field(0, "cells") <= r1.vcells.size() && field(1, "cells") <= r2.vcells.size() &&
+	          field(0, "input_points") == field(1, "input_points") &&
+	          field(0, "input_facets") == field(1, "input_facets") &&
+	          field(0, "mesh_bytes") > 0 && field(1, "mesh_bytes") > 0 &&
+	          field(0, "peak_memory_growth") >= 0 && field(1, "peak_memory_growth") >= 0 &&
+	          field(0, "time") >= 0 && field(1, "time") >= 0,
+	          "records fields");
+	for (int i=0; i<2; ++i){
+		std::cout<<"\t"<<recs[i].name<<": "<<field(i, "time")<<" sec, "
+		         <<field(i, "cells")<<" cells, "
+		         <<field(i, "mesh_bytes")/1048576<<" Mb arrays, "
+		         <<field(i, "peak_memory_growth")/1048576<<" Mb peak memory growth, "
+		         <<field(i, "peak_memory")/1048576<<" Mb peak memory"<<std::endl;
+	}
+
+	add_check(ISEQ(HM3D::SumVolumes(r1.vcells), 0.973) &&
+	          ISEQ(HM3D::SumVolumes(r2.vcells), 0.973), "volumes");
+	int nb1 = 0, nb2 = 0;
+	for (auto f: r1.vfaces) if (f->is_boundary()) ++nb1;
+	for (auto f: r2.vfaces) if (f->is_boundary()) ++nb2;
+	add_check(nb1 == nb2, "boundary faces");
+}
+
+void test15(){
+	std::cout<<"15. Pyramid layer on mixed triangle/quadrangle surface"<<std::endl;
+	//cylinder surface with triangles at the bases directed inside
+	auto g2d = HM2D::Grid::Constructor::Circle(Point(0, 0), 1, 8, 2, true);
+	auto cyl = HM3D::Grid::Constructor::SweepGrid2D(g2d, {0, 0.5, 1});
+	HM3D::FaceData srf;
+	HM3D::DeepCopy(HM3D::Surface::Assembler::GridSurface(cyl), srf, 2);
+	int ntri = 0;
+	for (auto f: srf){
+		f->left.reset(); f->right.reset();
+		f->reverse();
+		if (f->edges.size() == 3) ++ntri;
+	}
+	add_check(srf.size() == 48 && ntri == 16, "input surface");
+
+	//pyramid apex for cell with input face as its first face
+	auto apex = [](const HM3D::GridData& g, int icell)->Point3{
+		auto base = g.vcells[icell]->faces[0]->sorted_vertices();
+		for (auto v: HM3D::AllVertices(g.vcells[icell]->faces)){
+			if (std::find(base.begin(), base.end(), v) == base.end()) return *v;
+		}
+		return Point3(0, 0, 0);
+	};
+	auto npyramids = [](const HM3D::GridData& g)->int{
+		int ret = 0;
+		for (auto c: g.vcells) if (c->faces.size() > 1) ++ret;
+		return ret;
+	};
+	//expected values were obtained with the previous per-face implementation
+	auto g1 = HM3D::Grid::Constructor::BuildPyramidLayer(srf, true, 60);
+	add_check(g1.vvert.size() == 73 && g1.vedges.size() == 214 &&
+	          g1.vfaces.size() == 175 && g1.vcells.size() == 48 &&
+	          npyramids(g1) == 32 && g1.vcells[30]->faces.size() == 1,
+	          "quadrangle pyramids: primitives number");
+	add_check(apex(g1, 0) == Point3(0.663874859350, 0.274985970461, 0.257470892988) &&
+	          apex(g1, 5) == Point3(-0.274985970461, -0.663874859350, 0.257470892988) &&
+	          apex(g1, 17) == Point3(0.274985970461, 0.663874859350, 1.257470892988),
+	          "quadrangle pyramids: apex points");
+
+	auto g2 = HM3D::Grid::Constructor::BuildPyramidLayer(srf, false, 60);
+	add_check(g2.vvert.size() == 89 && g2.vedges.size() == 262 &&
+	          g2.vfaces.size() == 223 && g2.vcells.size() == 48 &&
+	          npyramids(g2) == 48,
+	          "all pyramids: primitives number");
+	add_check(apex(g2, 0) == Point3(0.663874859350, 0.274985970461, 0.257470892988) &&
+	          apex(g2, 17) == Point3(0.274985970461, 0.663874859350, 1.257470892988) &&
+	          apex(g2, 30) == Point3(0.117851130198, -0.284517796864, 1.148650889375),
+	          "all pyramids: apex points");
+}
 
 int main(){
 	test01();
@@ -531,7 +791,12 @@ int main(){
 	test08();
 	test09();
 	test10();
-	
+	test11();
+	test12();
+	test13();
+	test14();
+	test15();
+
 	check_final_report();
 	std::cout<<"DONE"<<std::endl;
 }
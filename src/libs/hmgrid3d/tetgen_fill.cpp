@@ -0,0 +1,172 @@
+#include "tetgen_fill.hpp"
+#include <unordered_map>
+
+using namespace HM3D;
+
+#ifndef HYBMESH_TETGEN
+bool HM3D::Mesher::TetgenAvailable(){ return false; }
+
+GridData HM3D::Mesher::TetgenFill(const vector<double>& points, const vector<int>& facets){
+	throw std::runtime_error("TetGen backend is not available: "
+		"hybmesh was built with system libgmsh");
+}
+#else //HYBMESH_TETGEN
+#include "tetgen.h"
+
+bool HM3D::Mesher::TetgenAvailable(){ return true; }
+
+namespace{
+
+struct TriHash{
+	size_t operator()(const std::array<int, 3>& t) const{
+		size_t ret = 0;
+		for (int i: t) ret ^= std::hash<int>()(i) + 0x9e3779b9 + (ret << 6) + (ret >> 2);
+		return ret;
+	}
+};
+struct PairHash{
+	size_t operator()(const std::pair<int, int>& p) const{
+		return std::hash<long long>()(((long long)p.first << 32) ^ (unsigned)p.second);
+	}
+};
+
+std::array<int, 3> sorted_tri(int a, int b, int c){
+	std::array<int, 3> ret {a, b, c};
+	std::sort(ret.begin(), ret.end());
+	return ret;
+}
+
+//face vertices of a positively oriented tetrahedron
+//directed so that the tetrahedron is the left cell. Same as gmsh import.
+const int tetfaces[4][3] = {{0, 2, 1}, {0, 3, 2}, {1, 2, 3}, {0, 1, 3}};
+
+//tets - positively oriented tetrahedra
+GridData grid_from_tets(const vector<double>& pts, const vector<int>& tets){
+	GridData ret;
+	int ntets = tets.size()/4;
+	ret.vvert.resize(pts.size()/3);
+	for (int i=0; i<ret.vvert.size(); ++i){
+		ret.vvert[i].reset(new Vertex(pts[3*i], pts[3*i+1], pts[3*i+2]));
+	}
+	ret.vcells.resize(ntets);
+	for (auto& c: ret.vcells) c.reset(new Cell());
+
+	std::unordered_map<std::array<int, 3>, int, TriHash> facemap;
+	std::unordered_map<std::pair<int, int>, int, PairHash> edgemap;
+	facemap.reserve(3*ntets);
+	edgemap.reserve(2*ntets + ret.vvert.size());
+	auto get_edge = [&](int a, int b)->shared_ptr<Edge>{
+		auto key = (a < b) ? std::make_pair(a, b) : std::make_pair(b, a);
+		auto er = edgemap.emplace(key, ret.vedges.size());
+		if (er.second) ret.vedges.emplace_back(new Edge(ret.vvert[a], ret.vvert[b]));
+		return ret.vedges[er.first->second];
+	};
+	for (int it=0; it<ntets; ++it){
+		const int* t = &tets[4*it];
+		for (int k=0; k<4; ++k){
+			int p[3] = {t[tetfaces[k][0]], t[tetfaces[k][1]], t[tetfaces[k][2]]};
+			auto fr = facemap.emplace(sorted_tri(p[0], p[1], p[2]), ret.vfaces.size());
+			if (fr.second){
+				ret.vfaces.emplace_back(new Face());
+				auto& f = ret.vfaces.back();
+				for (int i=0; i<3; ++i) f->edges.push_back(get_edge(p[i], p[(i+1)%3]));
+				f->left = ret.vcells[it];
+			} else {
+				ret.vfaces[fr.first->second]->right = ret.vcells[it];
+			}
+		}
+	}
+	for (auto& f: ret.vfaces){
+		if (f->has_left_cell()) f->left.lock()->faces.push_back(f);
+		if (f->has_right_cell()) f->right.lock()->faces.push_back(f);
+	}
+	return ret;
+}
+
+}
+
+GridData HM3D::Mesher::TetgenFill(const vector<double>& points, const vector<int>& facets){
+	int npts = points.size()/3;
+	//===== input arrays
+	tetgenio in, out;
+	in.firstnumber = 0;
+	in.numberofpoints = npts;
+	in.pointlist = new REAL[points.size()];
+	std::copy(points.begin(), points.end(), in.pointlist);
+	int nfacets = 0;
+	for (int i=0; i<facets.size(); i+=facets[i]+1) ++nfacets;
+	in.numberoffacets = nfacets;
+	in.facetlist = new tetgenio::facet[nfacets];
+	for (int i=0, k=0; i<facets.size(); i+=facets[i]+1, ++k){
+		tetgenio::facet& f = in.facetlist[k];
+		tetgenio::init(&f);
+		f.numberofpolygons = 1;
+		f.polygonlist = new tetgenio::polygon[1];
+		tetgenio::polygon& p = f.polygonlist[0];
+		tetgenio::init(&p);
+		p.numberofvertices = facets[i];
+		p.vertexlist = new int[facets[i]];
+		std::copy(facets.begin()+i+1, facets.begin()+i+1+facets[i], p.vertexlist);
+	}
+
+	//===== meshing
+	//p - piecewise linear complex, q - quality mesh, Y - keep boundary,
+	//A - region attributes, z - zero based indexing, Q - quiet
+	char sw[] = "pq1.414YAzQ";
+	try{
+		tetrahedralize(sw, &in, &out);
+	} catch (int err){
+		throw std::runtime_error("TetGen meshing failed with code " + std::to_string(err));
+	}
+	if (out.numberoftetrahedra == 0 || out.numberofcorners != 4 ||
+			out.numberoftetrahedronattributes < 1 || out.numberofpoints < npts){
+		throw std::runtime_error("TetGen meshing failed");
+	}
+
+	//===== domain region is the one adjacent to outer boundary:
+	//only its boundary faces have a single tetrahedron.
+	int ntets = out.numberoftetrahedra;
+	int natt = out.numberoftetrahedronattributes;
+	const int* tl = out.tetrahedronlist;
+	std::unordered_map<std::array<int, 3>, int, TriHash> fcount;
+	fcount.reserve(3*ntets);
+	for (int it=0; it<ntets; ++it)
+	for (int k=0; k<4; ++k){
+		auto key = sorted_tri(tl[4*it+tetfaces[k][0]], tl[4*it+tetfaces[k][1]], tl[4*it+tetfaces[k][2]]);
+		auto r = fcount.emplace(key, it);
+		if (!r.second) r.first->second = -1;
+	}
+	int domtet = -1;
+	for (auto& it: fcount) if (it.second >= 0) { domtet = it.second; break; }
+	assert(domtet >= 0);
+	REAL domattr = out.tetrahedronattributelist[natt*(domtet+1)-1];
+
+	//===== collect domain tetrahedra and used points.
+	//Input points keep their indices.
+	vector<int> newind(out.numberofpoints, -1);
+	for (int i=0; i<npts; ++i) newind[i] = i;
+	vector<double> pts(points);
+	vector<int> tets;
+	tets.reserve(4*ntets);
+	for (int it=0; it<ntets; ++it){
+		if (out.tetrahedronattributelist[natt*(it+1)-1] != domattr) continue;
+		int t[4];
+		for (int k=0; k<4; ++k){
+			int p = tl[4*it+k];
+			if (newind[p] < 0){
+				newind[p] = pts.size()/3;
+				pts.insert(pts.end(), out.pointlist+3*p, out.pointlist+3*p+3);
+			}
+			t[k] = newind[p];
+		}
+		//orientation
+		auto pt = [&pts](int i){ return Point3(pts[3*i], pts[3*i+1], pts[3*i+2]); };
+		Point3 p0 = pt(t[0]);
+		if (vecDot(vecCross(pt(t[1])-p0, pt(t[2])-p0), pt(t[3])-p0) < 0) std::swap(t[0], t[1]);
+		tets.insert(tets.end(), t, t+4);
+	}
+
+	GridData ret = grid_from_tets(pts, tets);
+	return ret;
+}
+#endif //HYBMESH_TETGEN
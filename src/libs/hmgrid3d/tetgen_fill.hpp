@@ -0,0 +1,25 @@
+#ifndef HMGRID3D_TETGEN_FILL_HPP
+#define HMGRID3D_TETGEN_FILL_HPP
+
+#include "primitives3d.hpp"
+
+namespace HM3D{ namespace Mesher{
+
+//TetGen is built only along with internal libgmsh.
+//System libgmsh contains its own TetGen copy which is not used.
+bool TetgenAvailable();
+
+//Tetrahedral mesh of a domain bounded by closed non-intersecting surfaces built by TetGen.
+//points = [x0, y0, z0, x1, y1, z1, ...],
+//facets = [n0, p0_0, ..., p0_(n0-1), n1, p1_0, ...] where n is a number of facet points.
+//Only the region adjacent to the outer boundary is meshed,
+//regions enclosed by inner surfaces are treated as holes.
+//Boundary is not subdivided and the first points.size()/3 vertices
+//of the result equal input points.
+//Concurrent calls are allowed.
+//Throws if !TetgenAvailable().
+GridData TetgenFill(const vector<double>& points, const vector<int>& facets);
+
+}}
+
+#endif
@@ -12,6 +12,8 @@
 #include "debug3d.hpp"
 #include "treverter3d.hpp"
 #include "nodes_compare.h"
+#include "hmparallel.hpp"
+#include "tetgen_fill.hpp"
 using namespace HM3D::Mesher;
 using namespace HM3D;
 
@@ -295,24 +297,56 @@ void equal_vertices(const HM3D::GridData& grid, GFace* gf, const FaceData& surf,
 	}
 }
 
-HM3D::GridData gmsh_fill(const Surface::Tree& tree, const FaceData& cond,
-		const HM3D::VertexData& pcond, const vector<double>& psizes,
+//Both backends push records with the same fields so that they could be compared.
+//mesh_bytes is an estimate of input and output arrays size: 3 doubles per vertex,
+//a vertex index per facet vertex and 4 indices per tetrahedron.
+//peak_memory is a process peak resident set size after meshing.
+//peak_memory_growth is its increase during meshing: it only counts memory
+//exceeding the previous process peak, concurrent domains contribute to it together.
+void add_backend_record(const char* name, const HM3D::Mesher::SurfacePreprocess& presurf,
+		const HM3D::GridData& ret, const HMTimer::TicToc& tm, double mem0){
+	if (!HMTimer::IsRecording()) return;
+	double mem1 = HMTimer::PeakMemory();
+	int nfacets = 0, nfacetvert = 0;
+	for (auto& ds: presurf.decomposed_surfs)
+	for (auto& s: ds)
+	for (auto& f: s){
+		++nfacets;
+		nfacetvert += f->edges.size();
+	}
+	double mbytes = sizeof(double)*3*(presurf.av.size() + ret.vvert.size()) +
+		sizeof(int)*(nfacetvert + 4*ret.vcells.size());
+	HMTimer::AddRecord(HMTimer::Record("Tetrahedral", name)
+		.add("input_points", presurf.av.size()).add("input_facets", nfacets)
+		.add("vertices", ret.vvert.size()).add("cells", ret.vcells.size())
+		.add("mesh_bytes", mbytes)
+		.add("peak_memory", mem1).add("peak_memory_growth", mem1 - mem0)
+		.add("time", tm.elapsed()));
+}
+
+//builds gmsh model from preprocessed surfaces and meshes it.
+//r1, s1 get coincident vertices of the result and presurf.bnd_grid.
+//gmsh keeps options, models list and meshing context in global variables,
+//so model building, meshing and model deletion are serialized by GmshMutex.
+//Mesh import and boundary matching run concurrently.
+void gmsh_mesh(HM3D::Mesher::SurfacePreprocess& presurf, HM3D::GridData& ret,
+		HM3D::VertexData& r1, HM3D::VertexData& s1,
 		HMCallback::Caller2& cb){
-	GModel m;
+	auto model_deleter = [](GModel* m){
+		std::lock_guard<std::mutex> lk(HMParallel::GmshMutex());
+		delete m;
+	};
+	std::unique_ptr<GModel, decltype(model_deleter)> pm(nullptr, model_deleter);
+	std::unique_lock<std::mutex> lk(HMParallel::GmshMutex());
+	HMTimer::TicToc tm("gmsh");
+	double mem0 = HMTimer::PeakMemory();
+	pm.reset(new GModel());
+	GModel& m = *pm;
 	m.setFactory("Gmsh");
 	GmshSetOption("General", "Verbosity", 0.0);
 	GmshSetOption("Mesh", "Optimize", 1.0);
 	//GmshSetOption("Mesh", "OptimizeNetgen", 1.0);
-	
-	//decomposition
-	cb.step_after(10, "Boundary preprocessing");
-	HM3D::Mesher::SurfacePreprocess presurf(tree, 30);
-	//if whole area is meshed with pyramids
-	if (presurf.decomposed_surfs.size() == 0){
-		cb.fin();
-		return presurf.bnd_grid;
-	}
-	
+
 	//mesh1d
 	cb.step_after(5, "Fill 1D mesh");
 	aa::enumerate_ids_pvec(presurf.ae);
@@ -343,14 +377,14 @@ HM3D::GridData gmsh_fill(const Surface::Tree& tree, const FaceData& cond,
 	//mesh3d
 	cb.step_after(35, "Build 3D mesh");
 	fill_model_with_3d(m, g_faces);
+	lk.unlock();
 
-	HM3D::GridData ret;
 	cb.step_after(30, "Assemble mesh");
 	GridFromModel(m, ret);
+	add_backend_record("gmsh", presurf, ret, tm, mem0);
 
 	//restore boundary types from tree
 	cb.step_after(10, "Restore boundary");
-	HM3D::VertexData r1, s1;
 	int k1=0;
 	for (auto& ds: presurf.decomposed_surfs){
 		vector<GFace*>& g_faces_1 = g_faces[k1++];
@@ -360,6 +394,58 @@ HM3D::GridData gmsh_fill(const Surface::Tree& tree, const FaceData& cond,
 			equal_vertices(ret, gf, s, r1, s1);
 		}
 	}
+}
+
+//passes preprocessed surfaces to tetgen as flat arrays.
+//r1, s1 get coincident vertices of the result and presurf.bnd_grid.
+void tetgen_mesh(HM3D::Mesher::SurfacePreprocess& presurf, HM3D::GridData& ret,
+		HM3D::VertexData& r1, HM3D::VertexData& s1,
+		HMCallback::Caller2& cb){
+	HMTimer::TicToc tm("TetGen");
+	double mem0 = HMTimer::PeakMemory();
+	cb.step_after(10, "Fill input arrays");
+	aa::enumerate_ids_pvec(presurf.av);
+	vector<double> points(3*presurf.av.size());
+	for (int i=0; i<presurf.av.size(); ++i){
+		points[3*i] = presurf.av[i]->x;
+		points[3*i+1] = presurf.av[i]->y;
+		points[3*i+2] = presurf.av[i]->z;
+	}
+	vector<int> facets;
+	for (auto& ds: presurf.decomposed_surfs)
+	for (auto& s: ds)
+	for (auto& f: s){
+		auto sv = f->sorted_vertices();
+		facets.push_back(sv.size());
+		for (auto& v: sv) facets.push_back(v->id);
+	}
+
+	cb.step_after(50, "Build 3D mesh");
+	ret = HM3D::Mesher::TetgenFill(points, facets);
+	add_backend_record("TetGen", presurf, ret, tm, mem0);
+
+	//first result vertices equal input points
+	cb.step_after(30, "Restore boundary");
+	r1.insert(r1.end(), ret.vvert.begin(), ret.vvert.begin() + presurf.av.size());
+	s1.insert(s1.end(), presurf.av.begin(), presurf.av.end());
+}
+
+HM3D::GridData tree_fill(const Surface::Tree& tree, const FaceData& cond,
+		const HM3D::VertexData& pcond, const vector<double>& psizes,
+		TetrahedralBackend backend, HMCallback::Caller2& cb){
+	//decomposition
+	cb.step_after(10, "Boundary preprocessing");
+	HM3D::Mesher::SurfacePreprocess presurf(tree, 30);
+	//if whole area is meshed with pyramids
+	if (presurf.decomposed_surfs.size() == 0){
+		cb.fin();
+		return presurf.bnd_grid;
+	}
+
+	HM3D::GridData ret;
+	HM3D::VertexData r1, s1;
+	if (backend == TetrahedralBackend::TETGEN) tetgen_mesh(presurf, ret, r1, s1, cb);
+	else gmsh_mesh(presurf, ret, r1, s1, cb);
 
 	HM3D::VertexData ret_duplicates;
 	HM3D::VertexData surfs_duplicates;
@@ -380,7 +466,12 @@ HMCallback::FunctionWithCallback<TUnstructuredTetrahedral> HM3D::Mesher::Unstruc
 
 HM3D::GridData TUnstructuredTetrahedral::_run(const FaceData& source,
 		const FaceData& sinner,
-		const VertexData& pinner, const vector<double>& psizes){
+		const VertexData& pinner, const vector<double>& psizes,
+		int nthreads, TetrahedralBackend backend){
+	if (backend == TetrahedralBackend::TETGEN && !TetgenAvailable()){
+		throw std::runtime_error("TetGen backend is not available: "
+			"hybmesh was built with system libgmsh");
+	}
 	callback->step_after(20, "Surfaces nesting");
 	//main tree
 	Surface::Tree stree = Surface::Tree::Assemble(source);
@@ -401,17 +492,39 @@ HM3D::GridData TUnstructuredTetrahedral::_run(const FaceData& source,
 	//revs.emplace_back(new HM3D::SurfTReverter(cond));
 	for (auto tree: trees) revs.emplace_back(new Surface::R::RevertTree(tree));
 
-	HM3D::GridData ret;
-	for (int i=0; i<trees.size(); ++i){
-		auto cb = callback->subrange(75./trees.size(), 100.);
-		if (i == 0) ret = gmsh_fill(trees[i], cond, pinner, psizes, *cb);
-		else {
-			HM3D::GridData sg = gmsh_fill(trees[i], cond, pinner, psizes, *cb);
-			std::copy(sg.vvert.begin(), sg.vvert.end(), std::back_inserter(ret.vvert));
-			std::copy(sg.vedges.begin(), sg.vedges.end(), std::back_inserter(ret.vedges));
-			std::copy(sg.vfaces.begin(), sg.vfaces.end(), std::back_inserter(ret.vfaces));
-			std::copy(sg.vcells.begin(), sg.vcells.end(), std::back_inserter(ret.vcells));
+	//disjoint domains are meshed concurrently
+	vector<HM3D::GridData> sg(trees.size());
+	int nth = (nthreads > 0) ? nthreads : HMParallel::NThreads();
+	if (trees.size() < 2 || nth < 2 || HMParallel::InParallel()){
+		for (int i=0; i<trees.size(); ++i){
+			auto cb = callback->subrange(75./trees.size(), 100.);
+			sg[i] = tree_fill(trees[i], cond, pinner, psizes, backend, *cb);
 		}
+	} else {
+		//callback is not thread safe: domains are meshed silently and
+		//the calling thread reports number of finished domains and checks cancellation.
+		callback->step_after(75, "Meshing domains", trees.size());
+		std::thread::id caller = std::this_thread::get_id();
+		std::atomic<int> ndone(0);
+		int nreported = 0;
+		HMParallel::For(trees.size(), [&](int i){
+			HMCallback::Caller2 cb;
+			sg[i] = tree_fill(trees[i], cond, pinner, psizes, backend, cb);
+			++ndone;
+			if (std::this_thread::get_id() == caller){
+				int n = ndone;
+				callback->subprocess_step_now(n - nreported);
+				nreported = n;
+			}
+		}, 2, nth);
+	}
+
+	HM3D::GridData ret = std::move(sg[0]);
+	for (int i=1; i<sg.size(); ++i){
+		std::copy(sg[i].vvert.begin(), sg[i].vvert.end(), std::back_inserter(ret.vvert));
+		std::copy(sg[i].vedges.begin(), sg[i].vedges.end(), std::back_inserter(ret.vedges));
+		std::copy(sg[i].vfaces.begin(), sg[i].vfaces.end(), std::back_inserter(ret.vfaces));
+		std::copy(sg[i].vcells.begin(), sg[i].vcells.end(), std::back_inserter(ret.vcells));
 	}
 	
 	callback->step_after(5, "Finalizing");
@@ -435,6 +548,10 @@ HM3D::GridData TUnstructuredTetrahedral::_run(const FaceData& source,
 HM3D::GridData TUnstructuredTetrahedral::_run(const FaceData& source){
 	return _run(source, FaceData(), {}, {});
 }
+HM3D::GridData TUnstructuredTetrahedral::_run(const FaceData& source, int nthreads,
+		TetrahedralBackend backend){
+	return _run(source, FaceData(), {}, {}, nthreads, backend);
+}
 HM3D::GridData TUnstructuredTetrahedral::_run(const FaceData& source,
 		const FaceData& sinner){
 	return _run(source, sinner, {}, {});
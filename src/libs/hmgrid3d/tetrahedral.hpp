@@ -6,14 +6,28 @@
 
 namespace HM3D{ namespace Mesher{
 
+enum class TetrahedralBackend{
+	GMSH,    //gmsh model built from surface mesh
+	TETGEN   //TetGen with flat arrays input. See TetgenAvailable() in tetgen_fill.hpp
+};
+
 struct TUnstructuredTetrahedral: public HMCallback::ExecutorBase{
 	HMCB_SET_PROCNAME("Tetrahedral meshing");
 	HMCB_SET_DEFAULT_DURATION(100);
 
+	//disjoint domains of the source surfaces tree are meshed
+	//concurrently using nthreads threads. nthreads <= 0 means HMParallel::NThreads().
+	//TETGEN backend meshes domains fully concurrently.
+	//GMSH backend serializes model building and 3D meshing because of gmsh global state,
+	//only boundary preprocessing, mesh import and boundary restoring run concurrently.
+	//In concurrent mode callback reports number of meshed domains.
 	GridData _run(const FaceData& source, const FaceData& sinner,
-			const VertexData& pinner, const vector<double>& psizes);
+			const VertexData& pinner, const vector<double>& psizes,
+			int nthreads=0, TetrahedralBackend backend=TetrahedralBackend::GMSH);
 
 	GridData _run(const FaceData& source);
+	GridData _run(const FaceData& source, int nthreads,
+			TetrahedralBackend backend=TetrahedralBackend::GMSH);
 	GridData _run(const FaceData& source, const FaceData& sinner);
 	GridData _run(const FaceData& source, const VertexData& pinner,
 			const vector<double>& psizes);
@@ -54,6 +54,9 @@ double LinTriangleSize(double area, int ncells){ return 1.5*sqrt(4.0*(area/ncell
 }
 
 HMCallback::FunctionWithCallback<ToRect::TBuild> ToRect::Build;
+HMMap::Conformal::Impl::BuildCache<ToRect> ToRect::cache(32);
+void ToRect::ClearCache(){ cache.clear(); }
+
 ToRect ToRect::TBuild::_run(const vector<Point>& path, int i1, int i2, int i3, const Options& opt){
 	ToRect ret;
 
@@ -182,13 +185,28 @@ vector<Point> ToRect::RectPoints() const{
 // ================== Annulus
 shared_ptr<ToAnnulus>
 ToAnnulus::Build(const vector<Point>& outer_path, const vector<Point>& inner_path, const Options& opt){
+	//solution is taken from cache if possible
+	vector<double> key {double(outer_path.size()), double(opt.fem_nrec)};
+	for (auto& p: outer_path){ key.push_back(p.x); key.push_back(p.y); }
+	for (auto& p: inner_path){ key.push_back(p.x); key.push_back(p.y); }
+	shared_ptr<ToAnnulus> ret;
+	if (cache.get(key, ret)) return ret;
+
 	// - build mapping
-	shared_ptr<ToAnnulus> ret(new ToAnnulus(outer_path, inner_path, opt));
+	ret.reset(new ToAnnulus(outer_path, inner_path, opt));
+	if (ret->module() > 0){
+		//cached objects could be used concurrently,
+		//so lazy data is built beforehand
+		ret->InvGridContour();
+	} else ret.reset();
 	// - return
-	if (ret->module() > 0) return ret;
-	else return 0;
+	cache.set(key, ret);
+	return ret;
 }
 
+void ToAnnulus::ClearCache(){ cache.clear(); }
+HMMap::Conformal::Impl::BuildCache<ToAnnulus> ToAnnulus::cache(32);
+
 void ToAnnulus::BuildGrid1(const vector<Point>& outer_path, const vector<Point>& inner_path,
 		int n){
 	//grid
@@ -402,13 +420,14 @@ void ToAnnulus::BuildGrid2(const vector<Point>& outer_path,
 	//4) inner/outer
 	// take into account that grid has doubled points at razor sides
 	inner.clear(); outer.clear();
+	HM2D::Finder::ClosestEdgeFinder outerfinder(*outerc), innerfinder(*innerc);
 	for (auto v: allp){
-		auto fnd1 = HM2D::Finder::ClosestEdge(*outerc, *v);
+		auto fnd1 = outerfinder.find(*v);
 		if (ISZERO(std::get<1>(fnd1))){
 			outer.push_back(v->id);
 			continue;
 		} 
-		auto fnd2 = HM2D::Finder::ClosestEdge(*innerc, *v);
+		auto fnd2 = innerfinder.find(*v);
 		if (ISZERO(std::get<1>(fnd2))){
 			inner.push_back(v->id);
 			continue;
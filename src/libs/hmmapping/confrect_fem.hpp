@@ -46,6 +46,11 @@ public:
 	};
 	static HMCallback::FunctionWithCallback<TBuild> Build;
 
+	//last built objects keyed by path, corners and fem_nrec.
+	//Used by Rect::Factory to skip repeating fem solutions.
+	static BuildCache<ToRect> cache;
+	static void ClearCache();
+
 	//conformal module
 	double module() const override { return _module; }
 	//Points from rectangle to polygon
@@ -108,10 +113,13 @@ class ToAnnulus: public HMMap::Conformal::Annulus{
 	mutable shared_ptr<HM2D::EdgeData> _inv_cont;
 	const HM2D::EdgeData* InvGridContour() const;
 
+	//last built objects
+	static BuildCache<ToAnnulus> cache;
 public:
 	static shared_ptr<ToAnnulus>
 	Build(const vector<Point>& outer_path, const vector<Point>& inner_path,
 			const Options& opt=Options());
+	static void ClearCache();
 
 	//===== overriden
 	//= RadInner < 1.0
@@ -167,8 +167,13 @@ void DirectMapping::build_grid3(){
 			HM2D::Contour::Algos::GuaranteePoint(*copied_base_contour, pbase);
 		}
 	}
-	g3 = std::make_shared<HM2D::GridData>(
-		HMFem::AuxGrid3(inpgrid2, opt.fem_nrec, opt.fem_nmax));
+	if (opt.fem_tol > 0){
+		HMFem::TAdaptiveAuxGrid3::Options aopt(opt.fem_nmin, opt.fem_nmax, opt.fem_tol);
+		g3 = std::make_shared<HM2D::GridData>(HMFem::AdaptiveAuxGrid3(inpgrid2, aopt));
+	} else {
+		g3 = std::make_shared<HM2D::GridData>(
+			HMFem::AuxGrid3(inpgrid2, opt.fem_nrec, opt.fem_nmax));
+	}
 }
 void DirectMapping::solve_uv_problems(vector<double>& u, vector<double>& v){
 	u.resize(g3->vvert.size(), 0.0);
@@ -232,8 +237,13 @@ void InverseMapping::build_grid3(){
 	}
 	
 	//build grid
-	g3 = std::make_shared<HM2D::GridData>(
-		HMFem::AuxGrid3(mapped2, opt.fem_nrec, opt.fem_nmax));
+	if (opt.fem_tol > 0){
+		HMFem::TAdaptiveAuxGrid3::Options aopt(opt.fem_nmin, opt.fem_nmax, opt.fem_tol);
+		g3 = std::make_shared<HM2D::GridData>(HMFem::AdaptiveAuxGrid3(mapped2, aopt));
+	} else {
+		g3 = std::make_shared<HM2D::GridData>(
+			HMFem::AuxGrid3(mapped2, opt.fem_nrec, opt.fem_nmax));
+	}
 }
 
 void InverseMapping::solve_uv_problems(vector<double>& u, vector<double>& v){
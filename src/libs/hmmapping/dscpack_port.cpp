@@ -1,5 +1,6 @@
 #include "dscpack_port.hpp"
 #include "contour.hpp"
+#include "hmparallel.hpp"
 using namespace HMMap::Conformal::Impl::DSCPack;
 
 extern "C"{
@@ -62,6 +63,8 @@ Pt dscpack_forward_(
 
 }
 
+HMMap::Conformal::Impl::BuildCache<ToAnnulus> ToAnnulus::cache;
+
 ToAnnulus::ToAnnulus(const vector<Pt>& outer, const vector<Pt>& inner, int _prec):
 	n1(outer.size()), n2(inner.size()), prec(_prec),
 	z1(outer), z2(inner), alfa1(n1), alfa2(n2),
@@ -87,14 +90,23 @@ ToAnnulus::Build(const vector<Point>& outer, const vector<Point>& inner){
 	std::transform(inner.begin(), inner.end(), v2.begin(),
 			[](const Point& p){ return Pt{p.x, p.y}; });
 
-	shared_ptr<ToAnnulus> ret(new ToAnnulus(v1, v2, 12));
-	//if points in canonic area are distinguishable everything is ok
-	if (ret->min_wdist() > 100*geps) return ret;
-
-	//failed to build -> return nothing
-	return 0;
+	//solution of the parameter problem is taken from cache if possible
+	vector<double> key {double(v1.size())};
+	for (auto& p: v1){ key.push_back(p.x); key.push_back(p.y); }
+	for (auto& p: v2){ key.push_back(p.x); key.push_back(p.y); }
+	shared_ptr<ToAnnulus> ret;
+	if (cache.get(key, ret)) return ret;
+
+	ret.reset(new ToAnnulus(v1, v2, 12));
+	//if points in canonic area are not distinguishable
+	//building has failed -> return nothing
+	if (ret->min_wdist() <= 100*geps) ret.reset();
+	cache.set(key, ret);
+	return ret;
 }
 
+void ToAnnulus::ClearCache(){ cache.clear(); }
+
 shared_ptr<ToAnnulus>
 ToAnnulus::Build(const HM2D::EdgeData& outer, const HM2D::EdgeData& inner){
 	assert(HM2D::Contour::IsClosed(outer) && HM2D::Contour::IsClosed(inner));
@@ -125,87 +137,87 @@ double ToAnnulus::min_wdist() const{
 	return sqrt(ret);
 }
 
-vector<Point> ToAnnulus::MapToOriginal(const vector<Point>& input) const{
-	vector<Point> ret; ret.reserve(input.size());
-	auto add_point = [&ret](const Pt& p){ ret.push_back(Point(p.x, p.y)); };
-
-	for (auto& p: input){
-		Pt x {p.x, p.y};
-		//search amoung originals
-		auto fnd1 = std::find_if(w1.begin(), w1.end(), [&x](const Pt& wp){
-					return ISEQ(x.x, wp.x) && ISEQ(x.y, wp.y);}); 
-		if (fnd1 != w1.end()) {
-			add_point( z1[fnd1 - w1.begin()] );
-			continue;
-		}
-		auto fnd2 = std::find_if(w2.begin(), w2.end(), [&x](const Pt& wp){
-					return ISEQ(x.x, wp.x) && ISEQ(x.y, wp.y);}); 
-		if (fnd2 != w2.end()) {
-			add_point( z2[fnd2 - w2.begin()] );
-			continue;
-		}
-		//do mapping
-		x = dscpack_backward_(
-			&x,
-			&n1,
-			&n2,
-			&z1[0],
-			&z2[0],
-			&prec,
-			&alfa1[0],
-			&alfa2[0],
-			&w1[0],
-			&w2[0],
-			&phi1[0],
-			&phi2[0],
-			&u,
-			&c,
-			&qwork[0]
-		);
-		add_point(x);
+Point ToAnnulus::map_to_original(const Point& p) const{
+	Pt x {p.x, p.y};
+	//search amoung originals
+	auto fnd1 = std::find_if(w1.begin(), w1.end(), [&x](const Pt& wp){
+				return ISEQ(x.x, wp.x) && ISEQ(x.y, wp.y);}); 
+	if (fnd1 != w1.end()) {
+		const Pt& z = z1[fnd1 - w1.begin()];
+		return Point(z.x, z.y);
+	}
+	auto fnd2 = std::find_if(w2.begin(), w2.end(), [&x](const Pt& wp){
+				return ISEQ(x.x, wp.x) && ISEQ(x.y, wp.y);}); 
+	if (fnd2 != w2.end()) {
+		const Pt& z = z2[fnd2 - w2.begin()];
+		return Point(z.x, z.y);
+	}
+	//do mapping
+	x = dscpack_backward_(
+		&x,
+		&n1,
+		&n2,
+		&z1[0],
+		&z2[0],
+		&prec,
+		&alfa1[0],
+		&alfa2[0],
+		&w1[0],
+		&w2[0],
+		&phi1[0],
+		&phi2[0],
+		&u,
+		&c,
+		&qwork[0]
+	);
+	return Point(x.x, x.y);
+}
+
+Point ToAnnulus::map_to_annulus(const Point& p) const{
+	Pt x {p.x, p.y};
+	//search amoung originals
+	auto fnd1 = std::find_if(z1.begin(), z1.end(), [&x](const Pt& wp){
+		return ISEQ(x.x, wp.x) && ISEQ(x.y, wp.y);}); 
+	if (fnd1 != z1.end()) {
+		const Pt& w = w1[fnd1 - z1.begin()];
+		return Point(w.x, w.y);
 	}
+	auto fnd2 = std::find_if(z2.begin(), z2.end(), [&x](const Pt& wp){
+		return ISEQ(x.x, wp.x) && ISEQ(x.y, wp.y);}); 
+	if (fnd2 != z2.end()) {
+		const Pt& w = w2[fnd2 - z2.begin()];
+		return Point(w.x, w.y);
+	}
+	//do mapping
+	x = dscpack_forward_(
+		&x,
+		&n1,
+		&n2,
+		&z1[0],
+		&z2[0],
+		&prec,
+		&alfa1[0],
+		&alfa2[0],
+		&w1[0],
+		&w2[0],
+		&phi1[0],
+		&phi2[0],
+		&u,
+		&c,
+		&qwork[0]
+	);
+	return Point(x.x, x.y);
+}
+
+vector<Point> ToAnnulus::MapToOriginal(const vector<Point>& input) const{
+	vector<Point> ret(input.size());
+	HMParallel::For(input.size(), [&](int i){ ret[i] = map_to_original(input[i]); }, par_minsize);
 	return ret;
 }
 
 vector<Point> ToAnnulus::MapToAnnulus(const vector<Point>& input) const{
-	vector<Point> ret; ret.reserve(input.size());
-	auto add_point = [&ret](const Pt& p){ ret.push_back(Point(p.x, p.y)); };
-
-	for (auto& p: input){
-		Pt x {p.x, p.y};
-		//search amoung originals
-		auto fnd1 = std::find_if(z1.begin(), z1.end(), [&x](const Pt& wp){
-			return ISEQ(x.x, wp.x) && ISEQ(x.y, wp.y);}); 
-		if (fnd1 != z1.end()) {
-			add_point( w1[fnd1 - z1.begin()] );
-			continue;
-		}
-		auto fnd2 = std::find_if(z2.begin(), z2.end(), [&x](const Pt& wp){
-			return ISEQ(x.x, wp.x) && ISEQ(x.y, wp.y);}); 
-		if (fnd2 != z2.end()) {
-			add_point( w2[fnd2 - z2.begin()] );
-			continue;
-		}
-		//do mapping
-		x = dscpack_forward_(
-			&x,
-			&n1,
-			&n2,
-			&z1[0],
-			&z2[0],
-			&prec,
-			&alfa1[0],
-			&alfa2[0],
-			&w1[0],
-			&w2[0],
-			&phi1[0],
-			&phi2[0],
-			&u,
-			&c,
-			&qwork[0]
-		);
-		add_point(x);
-	}
+	vector<Point> ret(input.size());
+	HMParallel::For(input.size(), [&](int i){ ret[i] = map_to_annulus(input[i]); }, par_minsize);
 	return ret;
 }
 
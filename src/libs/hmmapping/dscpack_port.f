@@ -80,7 +80,7 @@ C input
         complex*16 w1(n1), w2(n2), c
 C external 
         complex*16 zdsc
-        external zdsc
+        external zdsc, thdata
 C other
         integer iopt, kww, ic
         !=1 IS NORMALLY ASSUMED FOR ANY GEOMETRY.
@@ -91,6 +91,9 @@ C other
         !KWW=0 AND IC=2 OTHERWISE.
         kww = 0
         ic = 2
+        ! theta-function data is kept in a common block
+        ! which could be overwritten by another mapping
+        call thdata(u)
         dscpack_backward = zdsc(ww1,kww,ic,n1,n2,u,c,w1,w2,z1,z2,
      &                          alfa1,alfa2,phi1,
      &                          phi2,prec,qwork,iopt)
@@ -119,7 +122,7 @@ C input
         complex*16 w1(n1), w2(n2), c
 C external 
         complex*16 wdsc
-        external wdsc
+        external wdsc, thdata
 C other
         integer iopt
         real*8 eps
@@ -129,6 +132,9 @@ C other
         !=1 IS NORMALLY ASSUMED FOR ANY GEOMETRY.
         !=# ASSUMES THAT ONLY LINE SEGMENT PATH IS USED.
         iopt = 1
+        ! theta-function data is kept in a common block
+        ! which could be overwritten by another mapping
+        call thdata(u)
         dscpack_forward = wdsc(zz1,n1,n2,u,c,w1,w2,z1,z2,
      &                         alfa1,alfa2,phi1,phi2,
      &                         prec,qwork,eps,iopt)
@@ -33,6 +33,15 @@ class ToAnnulus: public HMMap::Conformal::Annulus{
 	//canonic area. Used for detection of the crowding problem
 	//within Build procedure
 	double min_wdist() const;
+
+	//single point mapping
+	Point map_to_original(const Point& p) const;
+	Point map_to_annulus(const Point& p) const;
+
+	//minimum number of points for parallel mapping
+	static const int par_minsize = 8;
+	//last built objects
+	static BuildCache<ToAnnulus> cache;
 public:
 	//all contours are in anti-clockwise direction
 	//all points are unique
@@ -43,11 +52,15 @@ public:
 	static shared_ptr<ToAnnulus>
 	Build(const HM2D::EdgeData& outer, const HM2D::EdgeData& inner);
 
+	//drops all stored solutions of previous Build calls
+	static void ClearCache();
+
 	double module() const override { return _module; }
 
 	vector<Point> InnerCirclePoints() const override;
 	vector<Point> OuterCirclePoints() const override;
 
+	//large inputs are mapped in parallel
 	vector<Point> MapToOriginal(const vector<Point>& input) const override;
 	vector<Point> MapToAnnulus(const vector<Point>& input) const override;
 
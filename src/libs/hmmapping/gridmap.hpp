@@ -25,6 +25,7 @@ struct Options{
 	int fem_nmax;
 	int fem_nmin;
 	int fem_nrec;
+	double fem_tol;     //>0 - adaptive auxiliary grid starting from fem_nmin vertices
 
 	std::string snap;   //NO, ADD_VERTICES, SHIFT_VERTICES
 	std::string algo;   //direct-laplace, inverse-laplace
@@ -32,7 +33,7 @@ struct Options{
 
 	Options(std::string _algo="inverse-laplace", std::string _snap="NO",
 			bool btypes_from_contour=true):
-		fem_nmax(100000), fem_nmin(100), fem_nrec(1000),
+		fem_nmax(100000), fem_nmin(100), fem_nrec(1000), fem_tol(-1),
 		snap(_snap), algo(_algo),
 		btypes_from_contour(btypes_from_contour){}
 };
@@ -131,8 +131,16 @@ shared_ptr<Rect> Rect::Factory(
 */
 	
 	//The only chance left is a direct fem solution
-	//of the Laplace problem
-	ret = std::make_shared<Impl::ConfFem::ToRect>(Impl::ConfFem::ToRect::Build(path, i1, i2, i3, opt));
+	//of the Laplace problem. It is taken from cache if possible.
+	vector<double> key {double(i1), double(i2), double(i3), double(opt.fem_nrec)};
+	for (auto& p: path){ key.push_back(p.x); key.push_back(p.y); }
+	shared_ptr<Impl::ConfFem::ToRect> femret;
+	if (!Impl::ConfFem::ToRect::cache.get(key, femret)){
+		femret = std::make_shared<Impl::ConfFem::ToRect>(
+			Impl::ConfFem::ToRect::Build(path, i1, i2, i3, opt));
+		Impl::ConfFem::ToRect::cache.set(key, femret);
+	}
+	ret = femret;
 
 	if (!ret) throw std::runtime_error("Failed to build mapping to rectangle");
 
@@ -4,6 +4,8 @@
 #include "bgeom2d.h"
 #include "hmcallback.hpp"
 #include "primitives2d.hpp"
+#include <mutex>
+#include <functional>
 
 namespace HMMap{ namespace Conformal{
 
@@ -141,6 +143,53 @@ public:
 
 namespace Impl{
 
+//Thread safe storage of last built mappings keyed by exact input data.
+//Used to skip solution of the parameter problem for repeating geometries.
+//Keys are compared by their hashes first.
+template<class T>
+class BuildCache{
+public:
+	BuildCache(int maxsize=16): maxsize(maxsize){}
+
+	//returns false if key was not found
+	bool get(const vector<double>& key, shared_ptr<T>& ret){
+		size_t h = hash(key);
+		std::lock_guard<std::mutex> lk(mut);
+		for (auto it=data.begin(); it!=data.end(); ++it)
+		if (it->hash == h && it->key == key){
+			ret = it->val;
+			data.splice(data.begin(), data, it);
+			return true;
+		}
+		return false;
+	}
+	void set(const vector<double>& key, shared_ptr<T> val){
+		size_t h = hash(key);
+		std::lock_guard<std::mutex> lk(mut);
+		data.push_front(Entry{h, key, val});
+		if (data.size() > maxsize) data.pop_back();
+	}
+	void clear(){
+		std::lock_guard<std::mutex> lk(mut);
+		data.clear();
+	}
+private:
+	struct Entry{
+		size_t hash;
+		vector<double> key;
+		shared_ptr<T> val;
+	};
+	static size_t hash(const vector<double>& key){
+		size_t ret = key.size();
+		std::hash<double> hd;
+		for (auto& k: key) ret ^= hd(k) + 0x9e3779b9 + (ret << 6) + (ret >> 2);
+		return ret;
+	}
+	const int maxsize;
+	std::list<Entry> data;
+	std::mutex mut;
+};
+
 //Approximatin of conformal mapping to rectangle using simple geometry
 class RectApprox: public Rect{
 	double _len_top, _len_bot, _len_left, _len_right;
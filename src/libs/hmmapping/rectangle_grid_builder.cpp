@@ -26,8 +26,11 @@ HM2D::EdgeData deepcopy(const HM2D::EdgeData& cont, bool isrev){
 
 bool has_self_cross(const HM2D::EdgeData& cont){
 	double ksieta[2];
-	for (int i=0; i<(int)cont.size()-2; ++i){
-		for (int j=i+2; j<cont.size(); ++j){
+	vector<BoundingBox> boxes;
+	for (auto& e: cont) boxes.push_back(HM2D::Finder::CrossBox(*e->first(), *e->last()));
+	for (auto& ij: HM2D::Finder::BoxPairs(boxes)){
+		int i = ij.first, j = ij.second;
+		if (j >= i+2){
 			Point& p1 = *cont[i]->first();
 			Point& p2 = *cont[i]->last();
 			Point& p3 = *cont[j]->first();
@@ -1,4 +1,5 @@
 #include "scpack_port.hpp"
+#include "hmparallel.hpp"
 
 using namespace HMMap::Conformal::Impl::SCPack;
 
@@ -58,6 +59,8 @@ Pt scpack_backward_(
 
 }
 
+HMMap::Conformal::Impl::BuildCache<ToRect> ToRect::cache;
+
 ToRect::ToRect(const vector<Pt>& dt, Pt p0, std::array<int, 4> i1, int _prec):
 		wcoords(dt), w0(p0),
 		corners({i1[0]+1, i1[1]+1, i1[2]+1, i1[3]+1}),
@@ -95,12 +98,21 @@ ToRect::Build(const vector<Point>& pnt, int i1, int i2, int i3){
 	std::transform(pnt.begin(), pnt.end(), input.begin(),
 			[](const Point& p){ return Pt{p.x, p.y}; }
 	);
-	
-	auto ret =  new ToRect(input, pc, std::array<int, 4>{0, i1, i2, i3}, 12);
-	if (ret->module() < 0) return 0;
-	else return shared_ptr<ToRect>(ret);
+
+	//solution of the parameter problem is taken from cache if possible
+	vector<double> key {double(i1), double(i2), double(i3)};
+	for (auto& p: input){ key.push_back(p.x); key.push_back(p.y); }
+	shared_ptr<ToRect> ret;
+	if (cache.get(key, ret)) return ret;
+
+	ret.reset(new ToRect(input, pc, std::array<int, 4>{0, i1, i2, i3}, 12));
+	if (ret->module() < 0) ret.reset();
+	cache.set(key, ret);
+	return ret;
 }
 
+void ToRect::ClearCache(){ cache.clear(); }
+
 shared_ptr<ToRect>
 ToRect::Build(const HM2D::EdgeData& left, const HM2D::EdgeData& right,
 		const HM2D::EdgeData& bot, const HM2D::EdgeData& top){
@@ -110,67 +122,62 @@ ToRect::Build(const HM2D::EdgeData& left, const HM2D::EdgeData& right,
 	return Build(vp, a[1], a[2], a[3]);
 }
 
-vector<Point> ToRect::MapToPolygon(const vector<Point>& input) const{
-	vector<Point> ret; ret.reserve(input.size());
-	for (auto& p: input){
-		//find among corner points
-		auto fnd = std::find_if(wcoords2.begin(), wcoords2.end(), [&](const Pt& x){
-			return ISEQ(x.x, p.x) && ISEQ(x.y, p.y);
-		});
-		if (fnd!=wcoords2.end()){
-			int i = fnd - wcoords2.begin();
-			const Pt& pt = wcoords[corners[i] - 1];
-			ret.push_back(Point(pt.x, pt.y));
-		} else {
-		//Do mapping
-			Pt t{p.x, p.y};
-			Pt t2 = scpack_backward_(
-				&t, &N,
-				&wcoords[0], &w0,
-				&wcoords2[0], &w02,
-				&zcoords[0], &zcoords2[0],
-				&factor, &factor2,
-				&betam[0], &qwork[0], &qwork2[0],
-				&prec
-			);
-			ret.push_back(Point(t2.x, t2.y));
-		}
+Point ToRect::map_to_polygon(const Point& p) const{
+	//find among corner points
+	auto fnd = std::find_if(wcoords2.begin(), wcoords2.end(), [&](const Pt& x){
+		return ISEQ(x.x, p.x) && ISEQ(x.y, p.y);
+	});
+	if (fnd!=wcoords2.end()){
+		int i = fnd - wcoords2.begin();
+		const Pt& pt = wcoords[corners[i] - 1];
+		return Point(pt.x, pt.y);
 	}
-	return ret;
+	//Do mapping
+	Pt t{p.x, p.y};
+	Pt t2 = scpack_backward_(
+		&t, &N,
+		&wcoords[0], &w0,
+		&wcoords2[0], &w02,
+		&zcoords[0], &zcoords2[0],
+		&factor, &factor2,
+		&betam[0], &qwork[0], &qwork2[0],
+		&prec
+	);
+	return Point(t2.x, t2.y);
+}
+
+Point ToRect::map_to_rectangle(const Point& p) const{
+	//find among corner points
+	auto fnd = std::find_if(wcoords.begin(), wcoords.end(), [&](const Pt& x){
+		return ISEQ(x.x, p.x) && ISEQ(x.y, p.y);
+	});
+	int i = fnd - wcoords.begin();
+	for (int k=0; k<4; ++k) if (i == corners[k] - 1){
+		return Point(wcoords2[k].x, wcoords2[k].y);
+	}
+	//Do mapping
+	Pt t{p.x, p.y};
+	Pt t2 = scpack_forward_(
+		&t, &N,
+		&wcoords[0], &w0,
+		&wcoords2[0], &w02,
+		&zcoords[0], &zcoords2[0],
+		&factor, &factor2,
+		&betam[0], &qwork[0], &qwork2[0],
+		&prec
+	);
+	return Point(t2.x, t2.y);
 }
 
+vector<Point> ToRect::MapToPolygon(const vector<Point>& input) const{
+	vector<Point> ret(input.size());
+	HMParallel::For(input.size(), [&](int i){ ret[i] = map_to_polygon(input[i]); }, par_minsize);
+	return ret;
+}
 
 vector<Point> ToRect::MapToRectangle(const vector<Point>& input) const{
-	vector<Point> ret; ret.reserve(input.size());
-	for (auto& p: input){
-		//find among corner points
-		auto fnd = std::find_if(wcoords.begin(), wcoords.end(), [&](const Pt& x){
-			return ISEQ(x.x, p.x) && ISEQ(x.y, p.y);
-		});
-		int i = fnd - wcoords.begin();
-		if (i == corners[0] - 1){
-			ret.push_back(Point(wcoords2[0].x, wcoords2[0].y));
-		} else if (i == corners[1] - 1){
-			ret.push_back(Point(wcoords2[1].x, wcoords2[1].y));
-		} else if (i == corners[2] - 1){
-			ret.push_back(Point(wcoords2[2].x, wcoords2[2].y));
-		} else if (i == corners[3] - 1){
-			ret.push_back(Point(wcoords2[3].x, wcoords2[3].y));
-		} else {
-		//Do mapping
-			Pt t{p.x, p.y};
-			Pt t2 = scpack_forward_(
-				&t, &N,
-				&wcoords[0], &w0,
-				&wcoords2[0], &w02,
-				&zcoords[0], &zcoords2[0],
-				&factor, &factor2,
-				&betam[0], &qwork[0], &qwork2[0],
-				&prec
-			);
-			ret.push_back(Point(t2.x, t2.y));
-		}
-	}
+	vector<Point> ret(input.size());
+	HMParallel::For(input.size(), [&](int i){ ret[i] = map_to_rectangle(input[i]); }, par_minsize);
 	return ret;
 }
 
@@ -180,11 +187,3 @@ vector<Point> ToRect::RectPoints() const{
 			[](const Pt& p){ return Point(p.x, p.y); });
 	return MapToRectangle(inp);
 }
-
-
-
-
-
-
-
-
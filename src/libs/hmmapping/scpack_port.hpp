@@ -33,6 +33,15 @@ class ToRect: public HMMap::Conformal::Rect{
 	//prec is number of Gauss-Jacobi integration points.
 	//Result will be approximated as O(1E-prec)
 	ToRect(const vector<Pt>& pnt, Pt p0, std::array<int, 4> cor, int prec);
+
+	//single point mapping
+	Point map_to_polygon(const Point& p) const;
+	Point map_to_rectangle(const Point& p) const;
+
+	//minimum number of points for parallel mapping
+	static const int par_minsize = 8;
+	//last built objects
+	static BuildCache<ToRect> cache;
 public:
 	//assemble from path given by ordered set of points
 	//in an anti-clockwise direction
@@ -49,12 +58,15 @@ public:
 	Build(const HM2D::EdgeData& left, const HM2D::EdgeData& right,
 		const HM2D::EdgeData& bot, const HM2D::EdgeData& top);
 
+	//drops all stored solutions of previous Build calls
+	static void ClearCache();
+
 	double module() const override { return _module; }
 
-	//Points from rectangle to polygon
+	//Points from rectangle to polygon. Large inputs are mapped in parallel.
 	vector<Point> MapToPolygon(const vector<Point>& input) const override;
 
-	//Points from polygon to rectangle
+	//Points from polygon to rectangle. Large inputs are mapped in parallel.
 	vector<Point> MapToRectangle(const vector<Point>& input) const override;
 
 	//Mapped Rectangle
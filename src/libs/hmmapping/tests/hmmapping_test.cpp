@@ -625,6 +625,120 @@ void test15(){
 	}
 }
 
+void test16(){
+	std::cout<<"16. Batch SCPACK/DSCPACK mapping"<<std::endl;
+	using namespace HMMap::Conformal::Impl;
+	int sz1 = 13;
+	auto r1 = HM2D::Contour::Constructor::Circle(sz1, 10, Point(0,0));
+	auto inp1 = HMMap::Conformal::Rect::FactoryInput(r1, {0, sz1/4, sz1/2, 3*sz1/4});
+	auto& path = std::get<0>(inp1);
+	auto& cor = std::get<1>(inp1);
+	auto trans1 = SCPack::ToRect::Build(path, cor[1], cor[2], cor[3]);
+	auto trans2 = SCPack::ToRect::Build(path, cor[1], cor[2], cor[3]);
+	add_check(trans1 == trans2, "cached rectangle solution");
+
+	vector<Point> p1;
+	for (int i=0; i<100; ++i) p1.push_back(Point(7.0*cos(0.1*i), 5.0*sin(0.13*i)));
+	vector<Point> r1b = trans1->MapToRectangle(p1);
+	vector<Point> p1b = trans1->MapToPolygon(r1b);
+	double d1 = 0, d2 = 0;
+	for (int i=0; i<p1.size(); i+=10){
+		d1 = std::max(d1, Point::meas(r1b[i], trans1->MapToRectangle1(p1[i])));
+	}
+	for (int i=0; i<p1.size(); ++i) d2 = std::max(d2, Point::meas(p1[i], p1b[i]));
+	add_check(d1 < 1e-24 && d2 < 1e-16, "rectangle batch mapping");
+
+	auto bot1 = HM2D::Contour::Constructor::Circle(8, 2, Point(0,0.1));
+	auto top1 = HM2D::Contour::Constructor::Circle(10, 4, Point(0,0.1));
+	auto top2 = HM2D::Contour::Constructor::Circle(12, 5, Point(0,1.1));
+	auto ann1 = DSCPack::ToAnnulus::Build(top1, bot1);
+	auto ann2 = DSCPack::ToAnnulus::Build(top2, bot1);
+	add_check(ann1 == DSCPack::ToAnnulus::Build(top1, bot1), "cached annulus solution");
+	vector<Point> p2;
+	for (int i=0; i<50; ++i) p2.push_back(Point(3*cos(0.2*i), 0.1 + 3*sin(0.2*i)));
+	vector<Point> a2 = ann1->MapToAnnulus(p2);
+	vector<Point> p2b = ann1->MapToOriginal(a2);
+	d1 = d2 = 0;
+	for (int i=0; i<p2.size(); i+=10){
+		d1 = std::max(d1, Point::meas(a2[i], ann1->MapToAnnulus1(p2[i])));
+	}
+	for (int i=0; i<p2.size(); ++i) d2 = std::max(d2, Point::meas(p2[i], p2b[i]));
+	add_check(d1 < 1e-24 && d2 < 1e-16, "annulus batch mapping");
+}
+
+void test17(){
+	std::cout<<"17. Cached fem conformal mappings"<<std::endl;
+	using namespace HMMap::Conformal;
+	Options opt;
+	opt.use_rect_approx = false;
+	opt.use_scpack = false;
+	opt.fem_nrec = 500;
+	auto c1 = HM2D::Contour::Constructor::Circle(16, 1, Point(0, 0));
+	auto inp1 = Rect::FactoryInput(c1, {0, 4, 8, 12});
+	auto r1 = Rect::Factory(std::get<0>(inp1), std::get<1>(inp1), opt);
+	auto r2 = Rect::Factory(std::get<0>(inp1), std::get<1>(inp1), opt);
+	opt.fem_nrec = 600;
+	auto r3 = Rect::Factory(std::get<0>(inp1), std::get<1>(inp1), opt);
+	add_check(r1 == r2 && r1 != r3, "rectangle fem solution");
+
+	vector<Point> outer, inner;
+	for (int i=0; i<16; ++i){
+		outer.push_back(Point(2*cos(M_PI*i/8), 2*sin(M_PI*i/8)));
+		inner.push_back(Point(0.2+cos(M_PI*i/8), sin(M_PI*i/8)));
+	}
+	auto a1 = Impl::ConfFem::ToAnnulus::Build(outer, inner, opt);
+	auto a2 = Impl::ConfFem::ToAnnulus::Build(outer, inner, opt);
+	Impl::ConfFem::ToAnnulus::ClearCache();
+	auto a3 = Impl::ConfFem::ToAnnulus::Build(outer, inner, opt);
+	add_check(a1 && a1 == a2 && a3 && a1 != a3 &&
+		fabs(a1->module() - a3->module()) < 1e-12, "annulus fem solution");
+}
+
+void test18(){
+	std::cout<<"18. Map grid with adaptive auxiliary triangulation"<<std::endl;
+	HM2D::GridData base = HM2D::Grid::Constructor::RectGrid01(10, 10);
+	auto square = HM2D::Contour::Constructor::FromPoints({0,0, 1,0, 1,1, 0,1}, true);
+	//area with a notch
+	auto notch = HM2D::Contour::Constructor::FromPoints({
+		0,0, 1,0, 1,1, 0.55,1, 0.55,0.5, 0.45,0.5, 0.45,1, 0,1}, true);
+	vector<Point> p1 {Point(0, 0), Point(1, 0), Point(1, 1), Point(0, 1)};
+	auto map = [&](const HM2D::GridData& from, const HM2D::EdgeData& to,
+			std::string algo, double tol, int nrec)->HM2D::GridData{
+		HMMap::Options opt(algo);
+		opt.fem_tol = tol;
+		opt.fem_nrec = nrec;
+		return HMMap::MapGrid(from, to, p1, p1, false, opt);
+	};
+	//maximum vertex displacement relative to the reference solution
+	auto diff = [](const HM2D::GridData& g1, const HM2D::GridData& g2)->double{
+		double ret = 0;
+		for (int i=0; i<g1.vvert.size(); ++i){
+			ret = std::max(ret, Point::dist(*g1.vvert[i], *g2.vvert[i]));
+		}
+		return ret;
+	};
+	//both algorithms solve Laplace problem within the notched area:
+	//inverse-laplace maps square grid onto the notch,
+	//direct-laplace maps notched grid back onto the square.
+	HM2D::GridData notched = map(base, notch, "inverse-laplace", -1, 20000);
+	for (std::string algo: {"inverse-laplace", "direct-laplace"}){
+		const HM2D::GridData& from = (algo == "inverse-laplace") ? base : notched;
+		const HM2D::EdgeData& to = (algo == "inverse-laplace") ? notch : square;
+		HM2D::GridData ref = (algo == "inverse-laplace") ? notched
+		                                                 : map(from, to, algo, -1, 20000);
+		HM2D::GridData g1 = map(from, to, algo, -1, 1000);
+		HM2D::GridData g2 = map(from, to, algo, 0.1, 1000);
+		HM2D::GridData g3 = map(from, to, algo, 0.05, 1000);
+		add_check(g1.vvert.size() == base.vvert.size() &&
+		          g2.vvert.size() == base.vvert.size() &&
+		          g3.vvert.size() == base.vvert.size(), algo + ": nodes number");
+		double d1 = diff(g1, ref), d2 = diff(g2, ref), d3 = diff(g3, ref);
+		add_check(d2 < d1 && d3 < d1, algo + ": adaptive grid accuracy");
+		//for direct-laplace the accuracy is limited by interpolation from the base grid
+		if (algo == "inverse-laplace") add_check(d3 < d2, algo + ": fem_tol controls accuracy");
+	}
+}
+
 int main(){
 	test01();
 	test02();
@@ -641,6 +755,9 @@ int main(){
 	test13();
 	test14();
 	test15();
+	test16();
+	test17();
+	test18();
 
 	HMTesting::check_final_report();
 	std::cout<<"DONE"<<std::endl;
@@ -0,0 +1,304 @@
+#include "hmatrix.hpp"
+#include "hmtimer.hpp"
+
+using namespace HMMath;
+
+// ============================ HMatrix
+double HMatrix::Cluster::diam() const{
+	return sqrt((x1-x0)*(x1-x0) + (y1-y0)*(y1-y0));
+}
+
+double HMatrix::Cluster::dist(const Cluster& c) const{
+	double dx = std::max(0.0, std::max(c.x0 - x1, x0 - c.x1));
+	double dy = std::max(0.0, std::max(c.y0 - y1, y0 - c.y1));
+	return sqrt(dx*dx + dy*dy);
+}
+
+HMatrix::HMatrix(const vector<double>& x, const vector<double>& y, TEntry entry, Options opt)
+		: N(x.size()), opt(opt){
+	assert(x.size() == y.size());
+	perm.resize(N);
+	for (int i=0; i<N; ++i) perm[i] = i;
+	if (N == 0) return;
+	int root = build_cluster(x, y, 0, N);
+	build_blocks(root, root, entry);
+}
+
+int HMatrix::build_cluster(const vector<double>& x, const vector<double>& y, int start, int end){
+	Cluster c;
+	c.start = start; c.end = end;
+	c.child1 = c.child2 = -1;
+	c.x0 = c.x1 = x[perm[start]];
+	c.y0 = c.y1 = y[perm[start]];
+	for (int i=start+1; i<end; ++i){
+		int k = perm[i];
+		if (x[k] < c.x0) c.x0 = x[k];
+		if (x[k] > c.x1) c.x1 = x[k];
+		if (y[k] < c.y0) c.y0 = y[k];
+		if (y[k] > c.y1) c.y1 = y[k];
+	}
+	int ret = clusters.size();
+	clusters.push_back(c);
+	if (end - start <= opt.leaf_size) return ret;
+
+	//median split along the longest bounding box side
+	int mid = (start + end)/2;
+	const vector<double>& crd = (c.x1 - c.x0 > c.y1 - c.y0) ? x : y;
+	std::nth_element(perm.begin()+start, perm.begin()+mid, perm.begin()+end,
+		[&crd](int a, int b){ return crd[a] < crd[b]; });
+	int c1 = build_cluster(x, y, start, mid);
+	int c2 = build_cluster(x, y, mid, end);
+	clusters[ret].child1 = c1;
+	clusters[ret].child2 = c2;
+	return ret;
+}
+
+void HMatrix::build_blocks(int rcl, int ccl, const TEntry& entry){
+	const Cluster& cr = clusters[rcl];
+	const Cluster& cc = clusters[ccl];
+	if (std::min(cr.diam(), cc.diam()) <= opt.eta*cr.dist(cc)){
+		//admissible block
+		blocks.emplace_back();
+		Block& b = blocks.back();
+		b.rcl = rcl; b.ccl = ccl;
+		if (!aca_block(b, entry)) dense_block(b, entry);
+		return;
+	}
+	if (cr.isleaf() && cc.isleaf()){
+		blocks.emplace_back();
+		Block& b = blocks.back();
+		b.rcl = rcl; b.ccl = ccl;
+		dense_block(b, entry);
+		return;
+	}
+	vector<int> rch, cch;
+	if (cr.isleaf()) rch = {rcl};
+	else rch = {cr.child1, cr.child2};
+	if (cc.isleaf()) cch = {ccl};
+	else cch = {cc.child1, cc.child2};
+	for (int r: rch)
+	for (int c: cch) build_blocks(r, c, entry);
+}
+
+void HMatrix::dense_block(Block& b, const TEntry& entry) const{
+	const Cluster& cr = clusters[b.rcl];
+	const Cluster& cc = clusters[b.ccl];
+	b.rank = -1;
+	b.b.clear();
+	b.a.resize((cr.end - cr.start)*(cc.end - cc.start));
+	auto it = b.a.begin();
+	for (int i=cr.start; i<cr.end; ++i)
+	for (int j=cc.start; j<cc.end; ++j){
+		*it++ = entry(perm[i], perm[j]);
+	}
+}
+
+bool HMatrix::aca_block(Block& b, const TEntry& entry) const{
+	//partially pivoted adaptive cross approximation
+	const Cluster& cr = clusters[b.rcl];
+	const Cluster& cc = clusters[b.ccl];
+	int m = cr.end - cr.start, n = cc.end - cc.start;
+	//low rank storage is not profitable if rank*(m+n) >= m*n
+	int maxrank = m*n/(m+n);
+	vector<vector<double>> U, V;
+	vector<bool> usedrow(m, false);
+	double norm2 = 0;
+	int istar = 0;
+	bool converged = false;
+	while (U.size() < maxrank){
+		usedrow[istar] = true;
+		vector<double> r(n);
+		for (int j=0; j<n; ++j){
+			r[j] = entry(perm[cr.start+istar], perm[cc.start+j]);
+			for (int l=0; l<U.size(); ++l) r[j] -= U[l][istar]*V[l][j];
+		}
+		int jstar = 0;
+		for (int j=1; j<n; ++j) if (fabs(r[j]) > fabs(r[jstar])) jstar = j;
+		if (fabs(r[jstar]) < 1e-300 || (U.size() > 0 &&
+				fabs(r[jstar]) <= geps2*sqrt(norm2))){
+			//zero residual row
+			if (U.size() > 0) { converged = true; break; }
+			istar = std::find(usedrow.begin(), usedrow.end(), false) - usedrow.begin();
+			if (istar == m) { converged = true; break; }
+			continue;
+		}
+		double piv = r[jstar];
+		for (int j=0; j<n; ++j) r[j] /= piv;
+		vector<double> col(m);
+		for (int i=0; i<m; ++i){
+			col[i] = entry(perm[cr.start+i], perm[cc.start+jstar]);
+			for (int l=0; l<U.size(); ++l) col[i] -= V[l][jstar]*U[l][i];
+		}
+		//frobenius norm estimation of the approximation
+		double un = std::inner_product(col.begin(), col.end(), col.begin(), 0.0);
+		double vn = std::inner_product(r.begin(), r.end(), r.begin(), 0.0);
+		for (int l=0; l<U.size(); ++l){
+			norm2 += 2*std::inner_product(U[l].begin(), U[l].end(), col.begin(), 0.0)*
+				std::inner_product(V[l].begin(), V[l].end(), r.begin(), 0.0);
+		}
+		norm2 += un*vn;
+		U.push_back(std::move(col));
+		V.push_back(std::move(r));
+		if (sqrt(un*vn) <= opt.aca_tol*sqrt(fabs(norm2))) { converged = true; break; }
+
+		//next row: maximum of the last column amoung unused rows
+		istar = -1;
+		for (int i=0; i<m; ++i) if (!usedrow[i]){
+			if (istar < 0 || fabs(U.back()[i]) > fabs(U.back()[istar])) istar = i;
+		}
+		if (istar < 0) { converged = true; break; }
+	}
+	if (!converged) return false;
+
+	int k = U.size();
+	b.rank = k;
+	b.a.resize(m*k);
+	b.b.resize(n*k);
+	for (int l=0; l<k; ++l){
+		for (int i=0; i<m; ++i) b.a[i*k+l] = U[l][i];
+		for (int j=0; j<n; ++j) b.b[j*k+l] = V[l][j];
+	}
+	return true;
+}
+
+void HMatrix::MultVec(const vector<double>& u, vector<double>& res) const{
+	vector<double> uloc, t;
+	for (auto& b: blocks){
+		const Cluster& cr = clusters[b.rcl];
+		const Cluster& cc = clusters[b.ccl];
+		int m = cr.end - cr.start, n = cc.end - cc.start;
+		uloc.resize(n);
+		for (int j=0; j<n; ++j) uloc[j] = u[perm[cc.start+j]];
+		if (b.rank < 0){
+			auto it = b.a.begin();
+			for (int i=0; i<m; ++i){
+				res[perm[cr.start+i]] += std::inner_product(it, it+n, uloc.begin(), 0.0);
+				it += n;
+			}
+		} else if (b.rank > 0){
+			int k = b.rank;
+			t.assign(k, 0.0);
+			for (int j=0; j<n; ++j)
+			for (int l=0; l<k; ++l) t[l] += b.b[j*k+l]*uloc[j];
+			for (int i=0; i<m; ++i){
+				res[perm[cr.start+i]] += std::inner_product(t.begin(), t.end(), b.a.begin()+i*k, 0.0);
+			}
+		}
+	}
+}
+
+vector<double> HMatrix::diag() const{
+	vector<double> ret(N, 0);
+	vector<int> pos(N);
+	for (int i=0; i<N; ++i) pos[perm[i]] = i;
+	for (auto& b: blocks) if (b.rank < 0){
+		const Cluster& cr = clusters[b.rcl];
+		const Cluster& cc = clusters[b.ccl];
+		int n = cc.end - cc.start;
+		for (int i=cr.start; i<cr.end; ++i){
+			int j = pos[perm[i]];
+			if (j >= cc.start && j < cc.end){
+				ret[perm[i]] = b.a[(i-cr.start)*n + j-cc.start];
+			}
+		}
+	}
+	return ret;
+}
+
+size_t HMatrix::stored() const{
+	size_t ret = 0;
+	for (auto& b: blocks) ret += b.a.size() + b.b.size();
+	return ret;
+}
+
+// ============================ GMRES
+GMRESSolver::GMRESSolver(int N, TOperator op, const vector<double>& diag,
+		double tol, int restart, int maxit)
+		: N(N), op(op), invdiag(N, 1.0), tol(tol), restart(restart), maxit(maxit), iters(0){
+	for (int i=0; i<diag.size(); ++i) if (diag[i] != 0) invdiag[i] = 1.0/diag[i];
+}
+
+namespace{
+double norm2(const vector<double>& v){
+	return sqrt(std::inner_product(v.begin(), v.end(), v.begin(), 0.0));
+}
+}
+
+void GMRESSolver::Solve(const vector<double>& rhs, vector<double>& x){
+	HMTimer::TicToc tm("GMRES");
+	double beta = 0, bnorm = 0;
+	auto record = [&](bool converged){
+		if (!HMTimer::IsRecording()) return;
+		HMTimer::AddRecord(HMTimer::Record("MatSolve", "GMRES")
+			.add("rows", N).add("iterations", iters)
+			.add("residual", (bnorm > 0) ? beta/bnorm : 0.0)
+			.add("converged", converged).add("time", tm.elapsed()));
+	};
+	//right preconditioned restarted gmres
+	x.resize(N, 0.0);
+	iters = 0;
+	bnorm = norm2(rhs);
+	if (bnorm == 0){ std::fill(x.begin(), x.end(), 0.0); return record(true); }
+
+	vector<double> r(N), w(N), z(N);
+	auto residual = [&](){
+		op(x, w);
+		for (int i=0; i<N; ++i) r[i] = rhs[i] - w[i];
+		return norm2(r);
+	};
+	beta = residual();
+	if (beta <= tol*bnorm) return record(true);
+
+	vector<vector<double>> V(restart+1, vector<double>(N));
+	vector<vector<double>> H(restart+1, vector<double>(restart, 0.0));
+	vector<double> cs(restart), sn(restart), g(restart+1);
+	while (iters < maxit){
+		for (int i=0; i<N; ++i) V[0][i] = r[i]/beta;
+		std::fill(g.begin(), g.end(), 0.0);
+		g[0] = beta;
+		int kend = 0;
+		for (int k=0; k<restart && iters<maxit; ++k){
+			++iters;
+			for (int i=0; i<N; ++i) z[i] = invdiag[i]*V[k][i];
+			op(z, w);
+			//modified Gram-Schmidt
+			for (int i=0; i<=k; ++i){
+				H[i][k] = std::inner_product(w.begin(), w.end(), V[i].begin(), 0.0);
+				for (int j=0; j<N; ++j) w[j] -= H[i][k]*V[i][j];
+			}
+			H[k+1][k] = norm2(w);
+			if (H[k+1][k] != 0) for (int j=0; j<N; ++j) V[k+1][j] = w[j]/H[k+1][k];
+			//Givens rotations
+			for (int i=0; i<k; ++i){
+				double t = cs[i]*H[i][k] + sn[i]*H[i+1][k];
+				H[i+1][k] = -sn[i]*H[i][k] + cs[i]*H[i+1][k];
+				H[i][k] = t;
+			}
+			double d = sqrt(H[k][k]*H[k][k] + H[k+1][k]*H[k+1][k]);
+			cs[k] = H[k][k]/d;
+			sn[k] = H[k+1][k]/d;
+			H[k][k] = d;
+			H[k+1][k] = 0;
+			g[k+1] = -sn[k]*g[k];
+			g[k] = cs[k]*g[k];
+			kend = k+1;
+			if (fabs(g[k+1]) <= tol*bnorm) break;
+		}
+		//update solution
+		vector<double> y(kend);
+		for (int i=kend-1; i>=0; --i){
+			y[i] = g[i];
+			for (int j=i+1; j<kend; ++j) y[i] -= H[i][j]*y[j];
+			y[i] /= H[i][i];
+		}
+		std::fill(z.begin(), z.end(), 0.0);
+		for (int i=0; i<kend; ++i)
+		for (int j=0; j<N; ++j) z[j] += y[i]*V[i][j];
+		for (int j=0; j<N; ++j) x[j] += invdiag[j]*z[j];
+
+		beta = residual();
+		if (beta <= tol*bnorm) return record(true);
+	}
+	record(false);
+	throw std::runtime_error("GMRES solver failed to converge");
+}
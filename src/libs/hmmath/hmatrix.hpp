@@ -0,0 +1,82 @@
+#ifndef HYBMESH_HMATRIX_HPP
+#define HYBMESH_HMATRIX_HPP
+
+#include "hmproject.h"
+#include <functional>
+
+namespace HMMath{
+
+//Hierarchical matrix approximation of a dense NxN matrix
+//which i-th row and j-th column correspond to (x[i], y[i]) and (x[j], y[j]) points.
+//Matrix entries are given by entry(i, j) function.
+//Blocks of well separated point clusters are approximated by
+//low rank products built by adaptive cross approximation (ACA).
+//All other blocks are stored as dense matrices.
+class HMatrix{
+public:
+	typedef std::function<double(int, int)> TEntry;
+	struct Options{
+		Options(): leaf_size(32), eta(1.0), aca_tol(1e-8){}
+		int leaf_size;  //maximum number of points in a leaf cluster
+		double eta;     //admissibility: min(diam1, diam2) <= eta*dist(1, 2)
+		double aca_tol; //relative tolerance of low rank approximation
+	};
+
+	HMatrix(const vector<double>& x, const vector<double>& y, TEntry entry, Options opt=Options());
+
+	int rows() const { return N; }
+	//res += H*u
+	void MultVec(const vector<double>& u, vector<double>& res) const;
+	//main diagonal
+	vector<double> diag() const;
+	//number of stored doubles. Equals N*N for an uncompressed matrix
+	size_t stored() const;
+private:
+	struct Cluster{
+		int start, end;
+		double x0, x1, y0, y1;
+		int child1, child2;
+		bool isleaf() const { return child1 < 0; }
+		double diam() const;
+		double dist(const Cluster& c) const;
+	};
+	struct Block{
+		int rcl, ccl;
+		int rank;         //-1 for dense blocks
+		vector<double> a; //dense (rows x cols) or U (rows x rank)
+		vector<double> b; //V (cols x rank)
+	};
+	int N;
+	Options opt;
+	vector<int> perm;
+	vector<Cluster> clusters;
+	vector<Block> blocks;
+
+	int build_cluster(const vector<double>& x, const vector<double>& y, int start, int end);
+	void build_blocks(int rcl, int ccl, const TEntry& entry);
+	void dense_block(Block& b, const TEntry& entry) const;
+	bool aca_block(Block& b, const TEntry& entry) const;
+};
+
+//Restarted GMRES for matrix-free operators with diagonal (Jacobi) preconditioning.
+//op(u, res) should assign res = A*u.
+class GMRESSolver{
+public:
+	typedef std::function<void(const vector<double>&, vector<double>&)> TOperator;
+	GMRESSolver(int N, TOperator op, const vector<double>& diag=vector<double>(),
+			double tol=1e-10, int restart=100, int maxit=2000);
+	//throws if failed to converge.
+	//x is used as an initial guess.
+	void Solve(const vector<double>& rhs, vector<double>& x);
+	int iterations() const { return iters; }
+private:
+	int N;
+	TOperator op;
+	vector<double> invdiag;
+	double tol;
+	int restart, maxit;
+	int iters;
+};
+
+}
+#endif
@@ -19,8 +19,84 @@ std::vector<int> subgraph(std::vector<bool>& used,
 	return ret;
 }
 
+//breadth-first search from s.
+//Fills lev with vertex levels and visited with visited vertices.
+//Returns vertices of the last level.
+std::vector<int> bfs_levels(const std::vector<std::vector<int>>& graph, int s,
+		std::vector<int>& lev, std::vector<int>& visited){
+	for (auto v: visited) lev[v] = -1;
+	visited.assign(1, s);
+	lev[s] = 0;
+	for (size_t k=0; k<visited.size(); ++k){
+		int v = visited[k];
+		for (auto a: graph[v]) if (lev[a] < 0){
+			lev[a] = lev[v] + 1;
+			visited.push_back(a);
+		}
+	}
+	int maxlev = lev[visited.back()];
+	std::vector<int> ret;
+	for (auto it=visited.rbegin(); it!=visited.rend() && lev[*it] == maxlev; ++it){
+		ret.push_back(*it);
+	}
+	return ret;
+}
+
+//vertex from the last bfs level of lowest degree
+//until eccentricity stops growing
+int pseudo_peripheral(const std::vector<std::vector<int>>& graph, int s,
+		std::vector<int>& lev, std::vector<int>& visited){
+	int ecc = -1;
+	for (int it=0; it<10; ++it){
+		std::vector<int> last = bfs_levels(graph, s, lev, visited);
+		if (lev[last[0]] <= ecc) break;
+		ecc = lev[last[0]];
+		s = *std::min_element(last.begin(), last.end(), [&](int a, int b){
+			return graph[a].size() < graph[b].size() ||
+				(graph[a].size() == graph[b].size() && a < b);
+		});
+	}
+	return s;
+}
+
 };
 
+std::vector<int> Graph::RCM(const std::vector<std::vector<int>>& graph){
+	int n = graph.size();
+	std::vector<int> ret;
+	ret.reserve(n);
+	std::vector<bool> used(n, false);
+	std::vector<int> lev(n, -1), visited;
+
+	//components are started from lowest degree vertices
+	std::vector<int> bydeg(n);
+	for (int i=0; i<n; ++i) bydeg[i] = i;
+	std::stable_sort(bydeg.begin(), bydeg.end(), [&](int a, int b){
+		return graph[a].size() < graph[b].size();
+	});
+
+	std::vector<int> nb;
+	for (int s: bydeg) if (!used[s]){
+		s = pseudo_peripheral(graph, s, lev, visited);
+		size_t k0 = ret.size();
+		ret.push_back(s);
+		used[s] = true;
+		for (size_t k=k0; k<ret.size(); ++k){
+			nb.clear();
+			for (auto a: graph[ret[k]]) if (!used[a]){
+				used[a] = true;
+				nb.push_back(a);
+			}
+			std::stable_sort(nb.begin(), nb.end(), [&](int a, int b){
+				return graph[a].size() < graph[b].size();
+			});
+			ret.insert(ret.end(), nb.begin(), nb.end());
+		}
+		std::reverse(ret.begin() + k0, ret.end());
+	}
+	return ret;
+}
+
 std::vector<std::vector<int>>
 Graph::SplitGraph(const std::vector<std::vector<int>>& graph){
 	std::vector<std::vector<int>> ret;
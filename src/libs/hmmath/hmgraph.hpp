@@ -7,6 +7,11 @@ namespace HMMath{ namespace Graph{
 //split bidirectional graph into clusters.
 std::vector<std::vector<int>> SplitGraph(const std::vector<std::vector<int>>& graph);
 
+//Reverse Cuthill-McKee ordering of bidirectional graph.
+//Returns old vertex indices in new order.
+//Each connected component starts from a pseudo-peripheral vertex.
+std::vector<int> RCM(const std::vector<std::vector<int>>& graph);
+
 
 }}
 
@@ -0,0 +1,112 @@
+#include "spacefill.hpp"
+#include "hmparallel.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+using namespace HMMath;
+
+namespace{
+
+//number of bits per coordinate so that a key fits into 63 bits
+int nbits(int dim){
+	if (dim == 2) return 31;
+	else if (dim == 3) return 21;
+	else throw std::runtime_error("space filling curves are defined for 2 and 3 dimensions");
+}
+
+//integer coordinates in [0, 2^b) within points bounding box
+std::vector<uint32_t> integer_coords(const std::vector<double>& coords, int dim, int b){
+	int n = coords.size()/dim;
+	std::vector<double> cmin(dim, std::numeric_limits<double>::max());
+	std::vector<double> cmax(dim, std::numeric_limits<double>::lowest());
+	for (int i=0; i<n; ++i)
+	for (int k=0; k<dim; ++k){
+		cmin[k] = std::min(cmin[k], coords[dim*i+k]);
+		cmax[k] = std::max(cmax[k], coords[dim*i+k]);
+	}
+	//common scale keeps aspect ratio
+	double len = 0;
+	for (int k=0; k<dim; ++k) len = std::max(len, cmax[k] - cmin[k]);
+	double maxint = (double)((1u << b) - 1);
+	double sc = (len > 0) ? maxint/len : 0;
+
+	std::vector<uint32_t> ret(coords.size());
+	HMParallel::For(n, [&](int i){
+		for (int k=0; k<dim; ++k){
+			double v = (coords[dim*i+k] - cmin[k])*sc;
+			ret[dim*i+k] = (uint32_t)std::min(std::max(v, 0.), maxint);
+		}
+	}, 10000);
+	return ret;
+}
+
+//bits of x[0..dim) from the highest to the lowest interleaved
+uint64_t interleave(const uint32_t* x, int dim, int b){
+	uint64_t ret = 0;
+	for (int bit=b-1; bit>=0; --bit)
+	for (int k=0; k<dim; ++k){
+		ret = (ret << 1) | ((x[k] >> bit) & 1u);
+	}
+	return ret;
+}
+
+//J.Skilling, Programming the Hilbert curve, 2004.
+//Converts coordinates into transposed Hilbert index.
+void axes_to_transpose(uint32_t* x, int dim, int b){
+	uint32_t m = 1u << (b-1), p, q, t;
+	//inverse undo
+	for (q=m; q>1; q>>=1){
+		p = q - 1;
+		for (int i=0; i<dim; ++i){
+			if (x[i] & q) x[0] ^= p;
+			else{
+				t = (x[0] ^ x[i]) & p;
+				x[0] ^= t;
+				x[i] ^= t;
+			}
+		}
+	}
+	//gray encode
+	for (int i=1; i<dim; ++i) x[i] ^= x[i-1];
+	t = 0;
+	for (q=m; q>1; q>>=1) if (x[dim-1] & q) t ^= q - 1;
+	for (int i=0; i<dim; ++i) x[i] ^= t;
+}
+
+std::vector<int> sorted_by_keys(const std::vector<uint64_t>& keys){
+	std::vector<int> ret(keys.size());
+	for (int i=0; i<ret.size(); ++i) ret[i] = i;
+	std::stable_sort(ret.begin(), ret.end(), [&](int a, int b){ return keys[a] < keys[b]; });
+	return ret;
+}
+
+}
+
+std::vector<uint64_t> SFC::HilbertKeys(const std::vector<double>& coords, int dim){
+	int b = nbits(dim);
+	std::vector<uint32_t> x = integer_coords(coords, dim, b);
+	std::vector<uint64_t> ret(coords.size()/dim);
+	HMParallel::For(ret.size(), [&](int i){
+		axes_to_transpose(&x[dim*i], dim, b);
+		ret[i] = interleave(&x[dim*i], dim, b);
+	}, 10000);
+	return ret;
+}
+
+std::vector<uint64_t> SFC::MortonKeys(const std::vector<double>& coords, int dim){
+	int b = nbits(dim);
+	std::vector<uint32_t> x = integer_coords(coords, dim, b);
+	std::vector<uint64_t> ret(coords.size()/dim);
+	HMParallel::For(ret.size(), [&](int i){
+		ret[i] = interleave(&x[dim*i], dim, b);
+	}, 10000);
+	return ret;
+}
+
+std::vector<int> SFC::HilbertOrder(const std::vector<double>& coords, int dim){
+	return sorted_by_keys(HilbertKeys(coords, dim));
+}
+
+std::vector<int> SFC::MortonOrder(const std::vector<double>& coords, int dim){
+	return sorted_by_keys(MortonKeys(coords, dim));
+}
@@ -0,0 +1,21 @@
+#ifndef HYBMESH_HMMATH_SPACEFILL_HPP
+#define HYBMESH_HMMATH_SPACEFILL_HPP
+#include <vector>
+#include <cstdint>
+
+namespace HMMath{ namespace SFC{
+
+//Space filling curves for points given by flat coordinates arrays
+//[x0, y0, (z0), x1, y1, (z1), ...]; dim = 2 or 3.
+//Points bounding box is mapped onto the curve domain.
+
+//curve keys of points
+std::vector<uint64_t> HilbertKeys(const std::vector<double>& coords, int dim);
+std::vector<uint64_t> MortonKeys(const std::vector<double>& coords, int dim);
+
+//point indices in order of their positions along the curve
+std::vector<int> HilbertOrder(const std::vector<double>& coords, int dim);
+std::vector<int> MortonOrder(const std::vector<double>& coords, int dim);
+
+}}
+#endif
@@ -2,6 +2,7 @@
 #include "cholmod.h"
 #include "umfpack.h"
 #include "SuiteSparseQR_C.h"
+#include "hmtimer.hpp"
 
 using namespace HMMath;
 
@@ -131,18 +132,29 @@ SeidelSolver::SeidelSolver(const Mat& m, Options opt): MatSolve(m){
 }
 
 void SeidelSolver::Solve(const vector<double>& rhs, vector<double>& u){
+	HMTimer::TicToc tm("Seidel");
 	vector<double> diag = m->diag();
 	assert(std::all_of(diag.begin(), diag.end(), [](double x){ return x>0; }));
 	u.resize(diag.size(), 0.0);
+	auto record = [&](int it, double rNorm){
+		if (!HMTimer::IsRecording()) return;
+		HMTimer::AddRecord(HMTimer::Record("MatSolve", "Seidel")
+			.add("rows", m->rows()).add("nnz", m->nnz())
+			.add("iterations", it).add("residual", rNorm)
+			.add("converged", rNorm<=tol).add("time", tm.elapsed()));
+	};
+	double rNorm = 0;
 	for (int it=0; it<MaxIt; ++it){
-		double rNorm = 0, r=0;
+		double r=0;
+		rNorm = 0;
 		for (int i=0; i<m->rows(); ++i){
 			r = rhs[i] - m->RowMultVec(u, i);
 			u[i] += r/diag[i];
 			if (fabs(r)>rNorm) rNorm = fabs(r);
 		}
-		if (rNorm<=tol) return;
+		if (rNorm<=tol) return record(it+1, rNorm);
 	}
+	record(MaxIt, rNorm);
 	throw std::runtime_error("Seidel solver failed to converge");
 }
 
@@ -215,17 +227,35 @@ struct SPQR{
 }
 
 SuiteSparseQRSolver::SuiteSparseQRSolver(const Mat& m, Options opt): MatSolve(m){
+	HMTimer::TicToc tm("SuiteSparseQR");
 	auto slv1 = new QRImpl::SPQR();
 	slv1->InitMat(m);
 	slv1->InitSlv();
 	slv = slv1;
+	record_factorization(tm.elapsed());
 }
 
 SuiteSparseQRSolver::SuiteSparseQRSolver(const Mat& m, int Ncols): MatSolve(m){
+	HMTimer::TicToc tm("SuiteSparseQR");
 	auto slv1 = new QRImpl::SPQR();
 	slv1->InitMat(m, Ncols);
 	slv1->InitSlv();
 	slv = slv1;
+	record_factorization(tm.elapsed());
+}
+
+void SuiteSparseQRSolver::record_factorization(double tm) const{
+	if (!HMTimer::IsRecording()) return;
+	auto s = static_cast<QRImpl::SPQR*>(slv);
+	//SPQR_istat: [0] - nnz(R) bound, [1] - nnz(H) bound, [4] - estimated rank
+	HMTimer::AddRecord(HMTimer::Record("MatSolve", "SuiteSparseQR.factorize")
+		.add("rows", s->A->nrow).add("cols", s->A->ncol)
+		.add("nnz", m->nnz())
+		.add("nnz_R", s->common.SPQR_istat[0])
+		.add("nnz_H", s->common.SPQR_istat[1])
+		.add("rank", s->common.SPQR_istat[4])
+		.add("flops", s->common.SPQR_flopcount_bound)
+		.add("time", tm));
 }
 
 SuiteSparseQRSolver::~SuiteSparseQRSolver(){
@@ -233,7 +263,13 @@ SuiteSparseQRSolver::~SuiteSparseQRSolver(){
 }
 
 void SuiteSparseQRSolver::Solve(const vector<double>& rhs, vector<double>& x){
+	HMTimer::TicToc tm("SuiteSparseQR");
 	int ans = static_cast<QRImpl::SPQR*>(slv)->Solve(&rhs[0], &x[0]);
+	if (HMTimer::IsRecording()){
+		HMTimer::AddRecord(HMTimer::Record("MatSolve", "SuiteSparseQR.solve")
+			.add("rows", m->rows()).add("success", ans == 1)
+			.add("time", tm.elapsed()));
+	}
 	if (ans != 1) throw std::runtime_error("QRSolver matrix solution failed");
 }
 
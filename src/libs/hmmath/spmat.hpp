@@ -80,6 +80,7 @@ public:
 
 class SuiteSparseQRSolver: public MatSolve{
 	void* slv;
+	void record_factorization(double tm) const;
 public:
 	// solver for square matrix
 	SuiteSparseQRSolver(const Mat& m, Options opt=Options());
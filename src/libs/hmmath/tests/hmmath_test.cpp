@@ -1,5 +1,10 @@
 #include "piecewise.hpp"
+#include "hmatrix.hpp"
 #include "hmtesting.hpp"
+#include "spmat.hpp"
+#include "hmtimer.hpp"
+#include "hmgraph.hpp"
+#include "spacefill.hpp"
 using HMTesting::add_check;
 
 void test01(){
@@ -38,8 +43,143 @@ void test01(){
 		ISEQ(f2.Integral(-1, 1), 0), "linear piecewise 2");
 }
 
+void test02(){
+	std::cout<<"02. Hierarchical matrix"<<std::endl;
+	int N = 2000;
+	vector<double> x(N), y(N);
+	for (int i=0; i<N; ++i){
+		double t = 2*M_PI*i/N;
+		x[i] = cos(t)*(1+0.3*cos(5*t));
+		y[i] = sin(t)*(1+0.3*cos(5*t));
+	}
+	auto entry = [&](int i, int j){
+		if (i == j) return 10.0;
+		return -0.5*log(sqr(x[i]-x[j]) + sqr(y[i]-y[j]))/N;
+	};
+	HMMath::HMatrix hm(x, y, entry);
+	vector<double> u(N), r1(N, 0), r2(N, 0);
+	for (int i=0; i<N; ++i) u[i] = sin(0.01*i);
+	hm.MultVec(u, r1);
+	for (int i=0; i<N; ++i)
+	for (int j=0; j<N; ++j) r2[i] += entry(i, j)*u[j];
+	double err = 0;
+	for (int i=0; i<N; ++i) err = std::max(err, fabs(r1[i]-r2[i]));
+	add_check(err < 1e-8, "hmatrix product");
+	add_check(hm.stored() < N*N/2, "hmatrix compression");
+
+	HMMath::GMRESSolver slv(N, [&](const vector<double>& a, vector<double>& b){
+			std::fill(b.begin(), b.end(), 0.0);
+			hm.MultVec(a, b);
+		}, hm.diag());
+	vector<double> sol(N, 0);
+	slv.Solve(r1, sol);
+	err = 0;
+	for (int i=0; i<N; ++i) err = std::max(err, fabs(sol[i]-u[i]));
+	add_check(err < 1e-8, "gmres solution");
+}
+
+void test03(){
+	std::cout<<"03. Solver performance records"<<std::endl;
+	int N = 100;
+	HMMath::Mat m;
+	m.data.resize(N);
+	for (int i=0; i<N; ++i){
+		m.set(i, i, 4.0);
+		if (i > 0) m.set(i, i-1, -1.0);
+		if (i < N-1) m.set(i, i+1, -1.0);
+	}
+	vector<double> rhs(N, 1.0), x1, x2(N, 0.0);
+
+	HMTimer::ClearRecords();
+	HMTimer::SetRecording(true);
+	HMMath::MatSolve::Options opt;
+	opt.iter_tol = 1e-12;
+	auto tp = std::chrono::steady_clock::now();
+	HMMath::SeidelSolver(m, opt).Solve(rhs, x1);
+	HMMath::GMRESSolver slv(N, [&m](const vector<double>& a, vector<double>& b){
+			m.MultVec(a, b); }, m.diag());
+	slv.Solve(rhs, x2);
+	double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+	int its = slv.iterations();
+	HMTimer::SetRecording(false);
+	slv.Solve(rhs, x2);
+
+	auto recs = HMTimer::Records();
+	add_check(recs.size() == 2 &&
+		recs[0].name == "Seidel" && recs[1].name == "GMRES" &&
+		recs[1].fields[1].first == "iterations" &&
+		recs[1].fields[1].second == its && its > 0, "records");
+	bool good_time = recs.size() == 2;
+	for (auto& r: recs)
+	for (auto& f: r.fields) if (f.first == "time"){
+		good_time = good_time && f.second >= 0 && f.second <= wall;
+	}
+	HMTimer::TicToc tm("started timer");
+	add_check(good_time && tm.elapsed() < wall + 1.0, "records timing");
+	std::string js = HMTimer::RecordsToJson();
+	add_check(js.substr(0, 44) == "[{\"category\": \"MatSolve\", \"name\": \"Seidel\", ", "json");
+	HMTimer::ClearRecords();
+}
+
+void test04(){
+	std::cout<<"04. Graph and space filling curve orderings"<<std::endl;
+	//shuffled 2d structured grid graph
+	int nx = 20, ny = 30, n = nx*ny;
+	vector<int> perm(n);
+	for (int i=0; i<n; ++i) perm[i] = (i*379) % n;
+	vector<vector<int>> graph(n);
+	auto connect = [&](int i, int j){
+		graph[perm[i]].push_back(perm[j]);
+		graph[perm[j]].push_back(perm[i]);
+	};
+	for (int j=0; j<ny; ++j)
+	for (int i=0; i<nx; ++i){
+		if (i < nx-1) connect(j*nx+i, j*nx+i+1);
+		if (j < ny-1) connect(j*nx+i, (j+1)*nx+i);
+	}
+	auto bandwidth = [&graph](const vector<int>& newind){
+		int ret = 0;
+		for (int i=0; i<graph.size(); ++i)
+		for (int j: graph[i]) ret = std::max(ret, std::abs(newind[i]-newind[j]));
+		return ret;
+	};
+	vector<int> ind(n);
+	for (int i=0; i<n; ++i) ind[i] = i;
+	int bw0 = bandwidth(ind);
+	vector<int> ord = HMMath::Graph::RCM(graph);
+	vector<int> used(n, 0);
+	for (int i=0; i<n; ++i) { ind[ord[i]] = i; used[ord[i]] += 1; }
+	add_check(std::all_of(used.begin(), used.end(), [](int a){ return a == 1; }), "rcm permutation");
+	add_check(bandwidth(ind) <= nx+1 && bandwidth(ind) < bw0, "rcm bandwidth");
+
+	//points on a line: curve order should follow the line
+	vector<double> pts;
+	for (int i=0; i<100; ++i) { pts.push_back((i*37)%100); pts.push_back(0); }
+	vector<int> h = HMMath::SFC::HilbertOrder(pts, 2);
+	vector<int> m = HMMath::SFC::MortonOrder(pts, 2);
+	bool good = true;
+	for (int i=1; i<100; ++i){
+		if (pts[2*m[i]] <= pts[2*m[i-1]]) good = false;
+		if (std::abs(pts[2*h[i]] - pts[2*h[i-1]]) > 3) good = false;
+	}
+	add_check(good, "curve orders of collinear points");
+
+	//unit square corners in Hilbert order are adjacent
+	vector<double> sq {0, 0, 1, 1, 0, 1, 1, 0};
+	h = HMMath::SFC::HilbertOrder(sq, 2);
+	good = true;
+	for (int i=1; i<4; ++i){
+		double d = std::abs(sq[2*h[i]]-sq[2*h[i-1]]) + std::abs(sq[2*h[i]+1]-sq[2*h[i-1]+1]);
+		if (d != 1) good = false;
+	}
+	add_check(good && h[0] == 0, "hilbert square");
+}
+
 int main(){
 	test01();
+	test02();
+	test03();
+	test04();
 
 	HMTesting::check_final_report();
 	std::cout<<"DONE"<<std::endl;
@@ -8,6 +8,8 @@
 #include "finder2d.hpp"
 #include "buildcont.hpp"
 #include "treverter2d.hpp"
+#include "buildgrid.hpp"
+#include "hmfem.hpp"
 
 using namespace HMFem;
 
@@ -628,14 +630,16 @@ void adopt_lost(int ilost, vector<vector<Point>>& veclost, Point& ret){
 		//place ret to veclost points.
 		//We hope they are sorted (is it guaranteed ???).
 		HM2D::EdgeData contlost = HM2D::Contour::Constructor::FromPoints(lost);
-		HM2D::Contour::Algos::GuaranteePoint(contlost, ret);
+		auto gp = HM2D::Contour::Algos::GuaranteePoint(contlost, ret);
+		//ret is projected to lost line
+		ret = *std::get<1>(gp);
 		lost.clear();
 		for (auto p: HM2D::Contour::OrderedPoints1(contlost)) {
+			if (p == std::get<1>(gp)) idiv = lost.size();
 			lost.push_back(*p);
-			if (*p == ret) idiv = lost.size();
 		}
 	}
-	if (idiv<1 && idiv > lost.size()-2){
+	if (idiv<1 || idiv > lost.size()-2){
 	} else if (idiv == 1){
 		lost.erase(lost.begin());
 	} else if (idiv == lost.size()-2){
@@ -648,10 +652,9 @@ void adopt_lost(int ilost, vector<vector<Point>>& veclost, Point& ret){
 	if (lost.size()<3){ veclost.erase(veclost.begin()+ilost); }
 }
 
-Point divide_edge(const HM2D::Edge* ed, vector<vector<Point>>& lost){
-	//if this edge exists amoung lost points, restore it from those points
-	Point p1 = *ed->first(), p2 = *ed->last();
-	Point ret = ed->center();
+Point divide_segment(const Point& p1, const Point& p2, vector<vector<Point>>& lost){
+	//if this segment exists amoung lost points, restore it from those points
+	Point ret = Point::Weigh(p1, p2, 0.5);
 	for (int i=0; i<lost.size(); ++i){
 		if ((p1 == lost[i][0] && p2 == lost[i].back()) ||
 		    (p2 == lost[i][0] && p1 == lost[i].back())){
@@ -661,6 +664,10 @@ Point divide_edge(const HM2D::Edge* ed, vector<vector<Point>>& lost){
 	}
 	return ret;
 }
+
+Point divide_edge(const HM2D::Edge* ed, vector<vector<Point>>& lost){
+	return divide_segment(*ed->first(), *ed->last(), lost);
+}
 };
 
 void TAuxGrid3::adopt_complicated_connections(HM2D::Contour::Tree& tree,
@@ -705,17 +712,16 @@ void TAuxGrid3::adopt_complicated_connections(HM2D::Contour::Tree& tree,
 	return adopt_complicated_connections(tree, lost);
 }
 
-HM2D::GridData HMFem::TAuxGrid3::_run(const HM2D::Contour::Tree& _tree,
+HM2D::GridData HMFem::TAuxGrid3::coarse_grid(const HM2D::Contour::Tree& _tree,
 		const vector<HM2D::EdgeData>& _constraints,
-		int nrec, int nmax, double hrec){
-	assert(nrec<nmax);
+		int nrec, int nmax, double hrec,
+		vector<vector<Point>>& lost_points){
 	//1)
 	callback->step_after(5, "Estimate step");
 	double hest = step_estimate(_tree, nrec, hrec);
 	//2)
 	callback->step_after(15, "Adopt boundary");
 	input(_tree, _constraints);
-	vector<vector<Point>> lost_points;
 	adopt_boundary(tree, CORRECTION_FACTOR*hest, lost_points);
 	for (auto c: constraints) adopt_contour(*c, CORRECTION_FACTOR*hest, lost_points);
 	for (auto c: constraints) tree.add_detached_contour(std::move(*c));
@@ -729,6 +735,15 @@ HM2D::GridData HMFem::TAuxGrid3::_run(const HM2D::Contour::Tree& _tree,
 	auto subcaller = callback->bottom_line_subrange(60);
 	auto ret = HM2D::Mesher::UnstructuredTriangle.UseCallback(subcaller, tree);
 	if (ret.vvert.size() > nmax) { clear(); throw std::runtime_error("Failed to build auxiliary triangle grid");}
+	return ret;
+}
+
+HM2D::GridData HMFem::TAuxGrid3::_run(const HM2D::Contour::Tree& _tree,
+		const vector<HM2D::EdgeData>& _constraints,
+		int nrec, int nmax, double hrec){
+	assert(nrec<nmax);
+	vector<vector<Point>> lost_points;
+	auto ret = coarse_grid(_tree, _constraints, nrec, nmax, hrec, lost_points);
 	if (lost_points.size() == 0) return ret;
 	//4)
 	callback->step_after(20, "Snapping");
@@ -750,3 +765,238 @@ HM2D::GridData HMFem::TAuxGrid3::_run(const HM2D::EdgeData& cont, int nrec, int
 	tree.add_contour(cont);
 	return _run(tree, nrec, nmax, hrec);
 }
+
+// ================================ Adaptive auxiliary triangulation
+HMCallback::FunctionWithCallback<HMFem::TAdaptiveAuxGrid3> HMFem::AdaptiveAuxGrid3;
+namespace{
+
+//flat triangulation which is refined by longest edge bisection
+struct AdaptiveTri{
+	vector<Point> pts;
+	vector<std::array<int, 3>> tris;        //counterclockwise
+	vector<double> bpar;                    //normalized arc length for boundary vertices or -1
+	std::set<std::pair<int, int>> bedges;   //boundary edges
+	std::map<std::pair<int, int>, int> mids;//edge -> midpoint vertex
+	vector<vector<Point>>* lost;
+
+	static std::pair<int, int> key(int a, int b){
+		return (a<b) ? std::make_pair(a, b) : std::make_pair(b, a);
+	}
+	int longest(const std::array<int, 3>& t) const{
+		int ret = 0;
+		double m = Point::meas(pts[t[0]], pts[t[1]]);
+		for (int i=1; i<3; ++i){
+			double m1 = Point::meas(pts[t[i]], pts[t[(i+1)%3]]);
+			if (m1 > m) { m = m1; ret = i; }
+		}
+		return ret;
+	}
+	int midpoint(int a, int b){
+		auto k = key(a, b);
+		auto fnd = mids.find(k);
+		if (fnd != mids.end()) return fnd->second;
+
+		int ret = pts.size();
+		pts.push_back(divide_segment(pts[a], pts[b], *lost));
+		if (bedges.find(k) != bedges.end()){
+			double s1 = bpar[a], s2 = bpar[b];
+			if (fabs(s1 - s2) > 0.5) { if (s1 < s2) s1 += 1; else s2 += 1; }
+			double s = (s1 + s2)/2.0;
+			bpar.push_back(s >= 1 ? s - 1 : s);
+			bedges.insert(key(a, ret));
+			bedges.insert(key(ret, b));
+		} else bpar.push_back(-1);
+		mids.emplace(k, ret);
+		return ret;
+	}
+	bool has_hanging(const std::array<int, 3>& t) const{
+		for (int i=0; i<3; ++i)
+		if (mids.find(key(t[i], t[(i+1)%3])) != mids.end()) return true;
+		return false;
+	}
+
+	//bisects marked triangles and all triangles required for conformity
+	void refine(const vector<int>& marked){
+		for (int it: marked){
+			auto& t = tris[it];
+			int i = longest(t);
+			midpoint(t[i], t[(i+1)%3]);
+		}
+		bool changed = true;
+		while (changed){
+			changed = false;
+			vector<std::array<int, 3>> newtris;
+			newtris.reserve(tris.size() + 2*marked.size());
+			for (auto& t: tris){
+				if (!has_hanging(t)){
+					newtris.push_back(t);
+					continue;
+				}
+				int i = longest(t);
+				int a = t[i], b = t[(i+1)%3], c = t[(i+2)%3];
+				int m = midpoint(a, b);
+				newtris.push_back({a, m, c});
+				newtris.push_back({m, b, c});
+				changed = true;
+			}
+			std::swap(tris, newtris);
+		}
+	}
+
+	HM2D::GridData to_grid() const{
+		HM2D::VertexData vv(pts.size());
+		for (int i=0; i<pts.size(); ++i) vv[i].reset(new HM2D::Vertex(pts[i]));
+		vector<vector<int>> cv(tris.size());
+		for (int i=0; i<tris.size(); ++i) cv[i] = vector<int>(tris[i].begin(), tris[i].end());
+		return HM2D::Grid::Constructor::FromTab(std::move(vv), cv);
+	}
+
+	//residual estimator of linear fem solution u.
+	//returns squared cell estimators and squared energy norm of u.
+	vector<double> estimate(const vector<double>& u, double& unorm2) const{
+		vector<Vect> grad(tris.size());
+		unorm2 = 0;
+		for (int i=0; i<tris.size(); ++i){
+			auto& t = tris[i];
+			const Point &p0 = pts[t[0]], &p1 = pts[t[1]], &p2 = pts[t[2]];
+			double a2 = vecCrossZ(p1-p0, p2-p0);
+			double du1 = u[t[1]] - u[t[0]], du2 = u[t[2]] - u[t[0]];
+			grad[i].x = (du1*(p2.y-p0.y) - du2*(p1.y-p0.y))/a2;
+			grad[i].y = (du2*(p1.x-p0.x) - du1*(p2.x-p0.x))/a2;
+			unorm2 += a2/2.0*vecDot(grad[i], grad[i]);
+		}
+		//normal derivative jumps across internal edges
+		vector<double> ret(tris.size(), 0);
+		std::map<std::pair<int, int>, int> first_cell;
+		for (int i=0; i<tris.size(); ++i)
+		for (int j=0; j<3; ++j){
+			int a = tris[i][j], b = tris[i][(j+1)%3];
+			auto er = first_cell.emplace(key(a, b), i);
+			if (er.second) continue;
+			int k = er.first->second;
+			Vect v = pts[b] - pts[a];
+			double jump = vecCrossZ(grad[i] - grad[k], v);
+			double val = 0.5*jump*jump;
+			ret[i] += val;
+			ret[k] += val;
+		}
+		return ret;
+	}
+};
+
+//bulk (Doerfler) marking
+vector<int> mark_cells(const vector<double>& eta2, double bulk){
+	vector<int> ind(eta2.size());
+	for (int i=0; i<ind.size(); ++i) ind[i] = i;
+	std::sort(ind.begin(), ind.end(), [&](int a, int b){ return eta2[a] > eta2[b]; });
+	double total = std::accumulate(eta2.begin(), eta2.end(), 0.0);
+	double sum = 0;
+	vector<int> ret;
+	for (int i: ind){
+		if (sum >= bulk*total) break;
+		ret.push_back(i);
+		sum += eta2[i];
+	}
+	return ret;
+}
+
+}
+
+HM2D::GridData HMFem::TAdaptiveAuxGrid3::_run(const HM2D::Contour::Tree& _tree,
+		const vector<HM2D::EdgeData>& _constraints,
+		Options opt){
+	assert(opt.nstart<opt.nmax);
+	vector<vector<Point>> lost_points;
+	HM2D::GridData coarse = coarse_grid(_tree, _constraints, opt.nstart, opt.nmax, -1, lost_points);
+
+	callback->step_after(15, "Refinement");
+	//flat representation of coarse grid
+	AdaptiveTri d;
+	d.lost = &lost_points;
+	aa::enumerate_ids_pvec(coarse.vvert);
+	for (auto& v: coarse.vvert) d.pts.push_back(*v);
+	for (auto& c: coarse.vcells){
+		auto op = HM2D::Contour::OrderedPoints1(c->edges);
+		assert(op.size() == 3);
+		std::array<int, 3> t {op[0]->id, op[1]->id, op[2]->id};
+		if (triarea(*op[0], *op[1], *op[2]) < 0) std::swap(t[1], t[2]);
+		d.tris.push_back(t);
+	}
+	HM2D::EdgeData cbnd = HM2D::ECol::Assembler::GridBoundary(coarse);
+	d.bpar.resize(d.pts.size(), -1);
+	for (auto& e: cbnd) d.bedges.insert(AdaptiveTri::key(e->first()->id, e->last()->id));
+	//arc length coordinates of boundary vertices
+	CoordinateMap2D<double> bmap;
+	for (auto& n: tree.bound_contours()){
+		auto op = HM2D::Contour::OrderedPoints(n->contour);
+		double len = HM2D::Contour::Length(n->contour);
+		double s = 0;
+		for (int i=0; i<op.size()-1; ++i){
+			bmap.add(*op[i], s/len);
+			s += Point::meas(*op[i], *op[i+1]);
+		}
+	}
+	for (auto& e: cbnd)
+	for (auto& v: e->vertices){
+		auto fnd = bmap.find(*v);
+		d.bpar[v->id] = (fnd != bmap.end()) ? fnd.data() : 0;
+	}
+
+	//refinement loop
+	bool refined = false;
+	for (int it=0; it<opt.maxit; ++it){
+		HM2D::GridData g = d.to_grid();
+		aa::enumerate_ids_pvec(g.vvert);
+		vector<double> bval(d.pts.size(), 0);
+		vector<int> bind;
+		for (int i=0; i<d.bpar.size(); ++i) if (d.bpar[i] >= 0){
+			bind.push_back(i);
+			bval[i] = (opt.bfun) ? opt.bfun(d.pts[i]) : cos(2*M_PI*d.bpar[i]);
+		}
+		LaplaceProblem lp(g);
+		lp.SetDirichlet(bind, [&bval](const HM2D::Vertex* v){ return bval[v->id]; });
+		vector<double> u(d.pts.size(), 0);
+		lp.Solve(u);
+
+		double unorm2;
+		vector<double> eta2 = d.estimate(u, unorm2);
+		double err2 = std::accumulate(eta2.begin(), eta2.end(), 0.0);
+		if (err2 <= opt.tol*opt.tol*unorm2) break;
+
+		vector<int> marked = mark_cells(eta2, opt.bulk);
+		if (d.pts.size() + marked.size() > opt.nmax) break;
+		//conformity closure adds an unknown number of vertices,
+		//so refinement is done on a copy which is dropped if it exceeds nmax
+		vector<vector<Point>> lost2 = lost_points;
+		AdaptiveTri d2 = d;
+		d2.lost = &lost2;
+		d2.refine(marked);
+		if (d2.pts.size() > opt.nmax) break;
+		d = std::move(d2);
+		d.lost = &lost_points;
+		std::swap(lost_points, lost2);
+		refined = true;
+	}
+	clear();
+
+	HM2D::GridData ret;
+	if (refined){
+		ret = d.to_grid();
+		auto gbnd = HM2D::ECol::Assembler::GridBoundary(ret);
+		HM2D::ECol::Algos::AssignBTypes(cbnd, gbnd);
+	} else ret = std::move(coarse);
+
+	if (lost_points.size() == 0) return ret;
+	callback->step_after(5, "Snapping");
+	Grid43::AddSegments(ret, lost_points);
+	return ret;
+}
+
+HM2D::GridData HMFem::TAdaptiveAuxGrid3::_run(const HM2D::Contour::Tree& tree, Options opt){
+	return _run(tree, {}, opt);
+}
+HM2D::GridData HMFem::TAdaptiveAuxGrid3::_run(const HM2D::EdgeData& cont, Options opt){
+	HM2D::Contour::Tree tree;
+	tree.add_contour(cont);
+	return _run(tree, opt);
+}
@@ -124,7 +124,7 @@ struct TAuxGrid3: public HMCallback::ExecutorBase{
 			int nrec, int nmax, double hrec=-1);
 	HM2D::GridData _run(const HM2D::Contour::Tree& tree, int nrec, int nmax, double hrec=-1);
 	HM2D::GridData _run(const HM2D::EdgeData& cont, int nrec, int nmax, double hrec=-1);
-private:
+protected:
 	HM2D::Contour::Tree tree;
 	ShpVector<HM2D::EdgeData> constraints;
 	HM2D::Contour::Tree ttree;
@@ -143,9 +143,48 @@ private:
 	void mandatory_intersections(HM2D::EdgeData& c1, HM2D::EdgeData& c2);
 	static bool angle_check(const vector<Point*>& line);
 	void clear();
+
+	//steps 1-3 of the algorithm: uses 80 units of callback.
+	//builds triangulation without snapping to lost points
+	HM2D::GridData coarse_grid(const HM2D::Contour::Tree& tree,
+			const vector<HM2D::EdgeData>& constraints,
+			int nrec, int nmax, double hrec,
+			vector<vector<Point>>& lost_points);
 };
 extern HMCallback::FunctionWithCallback<TAuxGrid3> AuxGrid3;
 
+//adaptive version of auxiliary triangulation.
+//Starts from a coarse AuxGrid3 grid with nstart recommended vertices and
+//refines it by longest edge bisection of cells with the largest
+//values of residual error estimator of a model Laplace problem.
+//Refinement stops if relative (energy norm) error estimation is less than tol,
+//or if next refinement would give more than nmax vertices, or after maxit iterations.
+//Model problem is a Dirichlet problem with bfun boundary values.
+//If bfun is not set then cos(2*pi*s) is used, where s is a
+//normalized arc length coordinate of a bounding contour.
+struct TAdaptiveAuxGrid3: public TAuxGrid3{
+	HMCB_SET_PROCNAME("Adaptive auxiliary triangulation");
+	HMCB_SET_DEFAULT_DURATION(100);
+
+	struct Options{
+		Options(int nstart=500, int nmax=100000, double tol=0.05):
+			nstart(nstart), nmax(nmax), tol(tol), bulk(0.5), maxit(30){}
+		int nstart;
+		int nmax;
+		double tol;
+		double bulk;  //fraction of total estimated error refined at each iteration
+		int maxit;
+		std::function<double(const Point&)> bfun;
+	};
+
+	HM2D::GridData _run(const HM2D::Contour::Tree& tree,
+			const vector<HM2D::EdgeData>& constraints,
+			Options opt);
+	HM2D::GridData _run(const HM2D::Contour::Tree& tree, Options opt);
+	HM2D::GridData _run(const HM2D::EdgeData& cont, Options opt);
+};
+extern HMCallback::FunctionWithCallback<TAdaptiveAuxGrid3> AdaptiveAuxGrid3;
+
 
 }
 #endif
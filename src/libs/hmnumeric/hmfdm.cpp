@@ -1,4 +1,5 @@
 #include "hmfdm.hpp"
+#include "hmtimer.hpp"
 using namespace HMFdm;
 
 void LaplaceSolver::set_predef_value(int i, int j, double val){
@@ -44,6 +45,12 @@ void LaplaceSolver::SetBndValues(Bnd b, const std::function<double(int, int)>& f
 void LaplaceSolver::Solve(vector<double>& ans){
 	if (was_init() == false) initialize();
 	assemble_rhs();
+	if (mg != nullptr){
+		if (mg->Solve(rhs, ans)) return;
+		//multigrid failed to converge: switch to direct solution
+		mg.reset();
+		initialize_direct();
+	}
 	solver->Solve(rhs, ans);
 }
 
@@ -54,6 +61,13 @@ void LaplaceSolver::assemble_rhs(){
 }
 
 void LaplaceSolver::initialize(){
+	if (!use_multigrid || Nx() < 2 || Ny() < 2) return initialize_direct();
+	vector<char> fixed(N(), 0);
+	for (auto& v: predefined_values) fixed[v.first] = 1;
+	mg.reset(new RectMultigrid(x, y, fixed));
+}
+
+void LaplaceSolver::initialize_direct(){
 	HMMath::Mat m;
 	m.data.resize(N());
 	//internal, left, right
@@ -211,3 +225,270 @@ void LaplaceSolver::initialize(){
 
 	solver = HMMath::MatSolve::Factory(m);
 }
+
+// ============================== RectMultigrid
+namespace{
+//indices of coarse level nodes in a fine level
+vector<int> coarse_indices(int n){
+	vector<int> ret;
+	if (n <= 3){
+		for (int i=0; i<n; ++i) ret.push_back(i);
+		return ret;
+	}
+	for (int i=0; i<n; i+=2) ret.push_back(i);
+	if (ret.back() != n-1) ret.push_back(n-1);
+	return ret;
+}
+//left coarse index and its weight for each fine node
+void fill_prolongation(const vector<double>& fine, const vector<double>& coarse,
+		vector<int>& pind, vector<double>& pw){
+	pind.resize(fine.size());
+	pw.resize(fine.size());
+	int ic = 0;
+	for (int i=0; i<fine.size(); ++i){
+		while (ic < (int)coarse.size()-2 && coarse[ic+1] <= fine[i]) ++ic;
+		pind[i] = ic;
+		if (coarse.size() == 1) pw[i] = 1;
+		else pw[i] = (coarse[ic+1] - fine[i])/(coarse[ic+1] - coarse[ic]);
+	}
+}
+//one dimensional stencil of LaplaceSolver with neumann ends
+void fill_stencil(const vector<double>& x, vector<double>& w, vector<double>& e,
+		vector<double>& d, vector<double>& v){
+	int n = x.size();
+	w.assign(n, 0); e.assign(n, 0); d.assign(n, 0); v.assign(n, 1);
+	if (n < 2) return;
+	for (int i=0; i<n; ++i){
+		double h1 = (i > 0) ? x[i] - x[i-1] : 0;
+		double h2 = (i < n-1) ? x[i+1] - x[i] : 0;
+		double C = 2.0/(h1 + h2);
+		if (i > 0) w[i] = -C/h1;
+		if (i < n-1) e[i] = -C/h2;
+		d[i] = -w[i] - e[i];
+		v[i] = (h1 + h2)/2.0;
+	}
+}
+//tridiagonal solution: a - sub, b - diagonal, c - super diagonal.
+//c and r are destroyed.
+void thomas(const vector<double>& a, const vector<double>& b, vector<double>& c,
+		vector<double>& r, int n){
+	c[0] /= b[0];
+	r[0] /= b[0];
+	for (int i=1; i<n; ++i){
+		double m = b[i] - a[i]*c[i-1];
+		c[i] /= m;
+		r[i] = (r[i] - a[i]*r[i-1])/m;
+	}
+	for (int i=n-2; i>=0; --i) r[i] -= c[i]*r[i+1];
+}
+}
+
+void RectMultigrid::Level::build_stencil(){
+	nx = x.size(); ny = y.size();
+	fill_stencil(x, xw, xe, xd, vx);
+	fill_stencil(y, ys, yn, yd, vy);
+	u.assign(nx*ny, 0);
+	f.assign(nx*ny, 0);
+	r.assign(nx*ny, 0);
+}
+
+double RectMultigrid::Level::residual(){
+	double ret = 0;
+	for (int j=0; j<ny; ++j)
+	for (int i=0; i<nx; ++i){
+		int k = j*nx + i;
+		if (fixed[k]) { r[k] = 0; continue; }
+		double lu = (xd[i] + yd[j])*u[k];
+		if (i > 0) lu += xw[i]*u[k-1];
+		if (i < nx-1) lu += xe[i]*u[k+1];
+		if (j > 0) lu += ys[j]*u[k-nx];
+		if (j < ny-1) lu += yn[j]*u[k+nx];
+		r[k] = f[k] - lu;
+		//residual scaled by diagonal gives a local correction size
+		double rs = fabs(r[k])/(xd[i] + yd[j]);
+		if (rs > ret) ret = rs;
+	}
+	return ret;
+}
+
+void RectMultigrid::Level::smooth_x(){
+	vector<double> a(nx), b(nx), c(nx), rhs(nx);
+	for (int j=0; j<ny; ++j){
+		for (int i=0; i<nx; ++i){
+			int k = j*nx + i;
+			if (fixed[k]){
+				a[i] = c[i] = 0; b[i] = 1; rhs[i] = f[k];
+				continue;
+			}
+			a[i] = xw[i]; c[i] = xe[i]; b[i] = xd[i] + yd[j];
+			rhs[i] = f[k];
+			if (j > 0) rhs[i] -= ys[j]*u[k-nx];
+			if (j < ny-1) rhs[i] -= yn[j]*u[k+nx];
+		}
+		thomas(a, b, c, rhs, nx);
+		std::copy(rhs.begin(), rhs.end(), u.begin() + j*nx);
+	}
+}
+
+void RectMultigrid::Level::smooth_y(){
+	//zebra line relaxation: even columns, then odd columns.
+	//Tridiagonal systems of all columns of one color are solved
+	//simultaneously to keep row-wise memory access.
+	cp.resize(nx*ny);
+	for (int color=0; color<2; ++color){
+		//forward elimination
+		for (int j=0; j<ny; ++j)
+		for (int i=color; i<nx; i+=2){
+			int k = j*nx + i;
+			double a, b, c, rhs;
+			if (fixed[k]){
+				a = c = 0; b = 1; rhs = f[k];
+			} else {
+				a = (j > 0) ? ys[j] : 0;
+				c = yn[j];
+				b = xd[i] + yd[j];
+				rhs = f[k];
+				if (i > 0) rhs -= xw[i]*u[k-1];
+				if (i < nx-1) rhs -= xe[i]*u[k+1];
+			}
+			if (j == 0){
+				cp[k] = c/b;
+				u[k] = rhs/b;
+			} else {
+				double m = b - a*cp[k-nx];
+				cp[k] = c/m;
+				u[k] = (rhs - a*u[k-nx])/m;
+			}
+		}
+		//back substitution
+		for (int j=ny-2; j>=0; --j)
+		for (int i=color; i<nx; i+=2){
+			int k = j*nx + i;
+			u[k] -= cp[k]*u[k+nx];
+		}
+	}
+}
+
+RectMultigrid::RectMultigrid(const vector<double>& x, const vector<double>& y, const vector<char>& fixed): iters(0){
+	levels.emplace_back();
+	levels[0].x = x;
+	levels[0].y = y;
+	levels[0].fixed = fixed;
+	levels[0].build_stencil();
+	while (true){
+		Level& fine = levels.back();
+		vector<int> ci = coarse_indices(fine.nx), cj = coarse_indices(fine.ny);
+		if (ci.size() == fine.nx && cj.size() == fine.ny) break;
+		Level coarse;
+		for (int i: ci) coarse.x.push_back(fine.x[i]);
+		for (int j: cj) coarse.y.push_back(fine.y[j]);
+		coarse.fixed.resize(ci.size()*cj.size());
+		for (int j=0; j<cj.size(); ++j)
+		for (int i=0; i<ci.size(); ++i){
+			coarse.fixed[j*ci.size() + i] = fine.fixed[cj[j]*fine.nx + ci[i]];
+		}
+		coarse.build_stencil();
+		fill_prolongation(fine.x, coarse.x, coarse.px, coarse.pwx);
+		fill_prolongation(fine.y, coarse.y, coarse.py, coarse.pwy);
+		levels.push_back(std::move(coarse));
+	}
+}
+
+void RectMultigrid::restrict_residual(int lev){
+	Level& fine = levels[lev];
+	Level& coarse = levels[lev+1];
+	//volume weighted transpose of bilinear prolongation
+	std::fill(coarse.f.begin(), coarse.f.end(), 0.0);
+	vector<double> sx(coarse.nx, 0), sy(coarse.ny, 0);
+	for (int i=0; i<fine.nx; ++i){
+		int I = coarse.px[i];
+		sx[I] += coarse.pwx[i]*fine.vx[i];
+		if (coarse.pwx[i] < 1) sx[I+1] += (1-coarse.pwx[i])*fine.vx[i];
+	}
+	for (int j=0; j<fine.ny; ++j){
+		int J = coarse.py[j];
+		sy[J] += coarse.pwy[j]*fine.vy[j];
+		if (coarse.pwy[j] < 1) sy[J+1] += (1-coarse.pwy[j])*fine.vy[j];
+	}
+	for (int j=0; j<fine.ny; ++j)
+	for (int i=0; i<fine.nx; ++i){
+		double rv = fine.r[j*fine.nx + i]*fine.vx[i]*fine.vy[j];
+		if (rv == 0) continue;
+		int I = coarse.px[i], J = coarse.py[j];
+		double wx[2] = {coarse.pwx[i], 1 - coarse.pwx[i]};
+		double wy[2] = {coarse.pwy[j], 1 - coarse.pwy[j]};
+		for (int q=0; q<2; ++q) if (wy[q] > 0)
+		for (int p=0; p<2; ++p) if (wx[p] > 0){
+			coarse.f[(J+q)*coarse.nx + I+p] += wx[p]*wy[q]*rv;
+		}
+	}
+	for (int J=0; J<coarse.ny; ++J)
+	for (int I=0; I<coarse.nx; ++I){
+		int k = J*coarse.nx + I;
+		if (coarse.fixed[k]) coarse.f[k] = 0;
+		else coarse.f[k] /= (sx[I]*sy[J]);
+	}
+	std::fill(coarse.u.begin(), coarse.u.end(), 0.0);
+}
+
+void RectMultigrid::prolongate_correction(int lev){
+	Level& fine = levels[lev];
+	Level& coarse = levels[lev+1];
+	for (int j=0; j<fine.ny; ++j)
+	for (int i=0; i<fine.nx; ++i){
+		int k = j*fine.nx + i;
+		if (fine.fixed[k]) continue;
+		int I = coarse.px[i], J = coarse.py[j];
+		double wx[2] = {coarse.pwx[i], 1 - coarse.pwx[i]};
+		double wy[2] = {coarse.pwy[j], 1 - coarse.pwy[j]};
+		for (int q=0; q<2; ++q) if (wy[q] > 0)
+		for (int p=0; p<2; ++p) if (wx[p] > 0){
+			fine.u[k] += wx[p]*wy[q]*coarse.u[(J+q)*coarse.nx + I+p];
+		}
+	}
+}
+
+void RectMultigrid::vcycle(int lev){
+	Level& L = levels[lev];
+	if (lev == levels.size()-1){
+		for (int k=0; k<50; ++k){ L.smooth_x(); L.smooth_y(); }
+		return;
+	}
+	L.smooth_x();
+	L.smooth_y();
+	L.residual();
+	restrict_residual(lev);
+	vcycle(lev+1);
+	prolongate_correction(lev);
+	L.smooth_y();
+	L.smooth_x();
+}
+
+bool RectMultigrid::Solve(const vector<double>& rhs, vector<double>& ans, double tol, int maxit){
+	Level& L = levels[0];
+	std::copy(rhs.begin(), rhs.end(), L.f.begin());
+	if (ans.size() == L.u.size()) std::copy(ans.begin(), ans.end(), L.u.begin());
+	else std::fill(L.u.begin(), L.u.end(), 0.0);
+	for (int k=0; k<L.u.size(); ++k) if (L.fixed[k]) L.u[k] = L.f[k];
+
+	double umax = 0;
+	for (int k=0; k<L.u.size(); ++k) umax = std::max(umax, fabs(L.u[k]));
+	if (umax == 0) umax = 1;
+
+	HMTimer::TicToc tm("RectMultigrid");
+	double res = L.residual();
+	bool ret = (res <= tol*umax);
+	for (iters=0; iters<maxit && !ret; ++iters){
+		vcycle(0);
+		res = L.residual();
+		ret = (res <= tol*umax);
+	}
+	ans = L.u;
+	if (HMTimer::IsRecording()){
+		HMTimer::AddRecord(HMTimer::Record("MatSolve", "RectMultigrid")
+			.add("rows", L.u.size()).add("levels", levels.size())
+			.add("iterations", iters).add("residual", res/umax)
+			.add("converged", ret).add("time", tm.elapsed()));
+	}
+	return ret;
+}
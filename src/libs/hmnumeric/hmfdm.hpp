@@ -5,15 +5,58 @@
 
 namespace HMFdm{
 
+//Matrix-free geometric multigrid for the LaplaceSolver stencil
+//on a tensor product grid with non-uniform steps.
+//Uses V-cycles with alternating line Gauss-Seidel smoothing.
+//Nodes with fixed[glob_index]=true have predefined values u = rhs.
+//Other boundary nodes have zero normal derivative condition.
+class RectMultigrid{
+	struct Level{
+		int nx, ny;
+		vector<double> x, y;
+		vector<char> fixed;
+		//separable stencil: west/east/diagonal x-coefficients
+		//and south/north/diagonal y-coefficients
+		vector<double> xw, xe, xd, ys, yn, yd;
+		//control volumes for restriction
+		vector<double> vx, vy;
+		//prolongation from this level to the finer one:
+		//for each finer node: left coarse index and its weight
+		vector<int> px, py;
+		vector<double> pwx, pwy;
+		vector<double> u, f, r, cp;
+		void build_stencil();
+		//returns maximum residual scaled by diagonal
+		double residual();
+		void smooth_x();
+		void smooth_y();
+	};
+	vector<Level> levels;
+	int iters;
+
+	void vcycle(int lev);
+	void restrict_residual(int lev);
+	void prolongate_correction(int lev);
+public:
+	RectMultigrid(const vector<double>& x, const vector<double>& y, const vector<char>& fixed);
+	//returns false if scaled residual did not reach tol*max(|u|) in maxit V-cycles.
+	//ans is used as an initial guess if it has proper size.
+	bool Solve(const vector<double>& rhs, vector<double>& ans, double tol=1e-13, int maxit=100);
+	int iterations() const { return iters; }
+};
+
 //laplas solver is square area with regular mesh
 class LaplaceSolver{
 	vector<double> x, y;
 	vector<double> rhs;
 	std::map<int, double> predefined_values;
 	void set_predef_value(int i, int j, double val);
+	bool use_multigrid;
+	shared_ptr<RectMultigrid> mg;
 	shared_ptr<HMMath::MatSolve> solver;
-	bool was_init(){ return solver != nullptr; }
+	bool was_init(){ return solver != nullptr || mg != nullptr; }
 	void initialize(); 
+	void initialize_direct(); 
 	void assemble_rhs();
 public:
 	// ==== properties
@@ -24,7 +67,9 @@ public:
 	std::pair<int, int> sub_index(int gi) const { return std::make_pair<int, int>(gi%Nx(), gi/Nx()); }
 
 	// ==== conststructor
-	LaplaceSolver(const vector<double>& _x, const vector<double>& _y): x(_x), y(_y){}
+	//multigrid=false forces assembling of sparse matrix and direct solution
+	LaplaceSolver(const vector<double>& _x, const vector<double>& _y, bool multigrid=true):
+		x(_x), y(_y), use_multigrid(multigrid){}
 
 	// ==== set boundary conditions
 	enum class Bnd {All, Top, Bottom, Left, Right};
@@ -1,5 +1,6 @@
 #include "laplace_bem2d.hpp"
 #include "densemat.hpp"
+#include "hmatrix.hpp"
 #include "treverter2d.hpp"
 #include "hmtimer.hpp"
 
@@ -46,7 +47,12 @@ LaplaceCE2D::LaplaceCE2D(const HM2D::Contour::Tree& area){
 	}
 };
 
-void LaplaceCE2D::Solve(){
+void LaplaceCE2D::Solve(int dense_nmax){
+	if (N < dense_nmax) SolveDense();
+	else SolveCompressed();
+}
+
+void LaplaceCE2D::SolveDense(){
 	HMMath::DenseMat mat(N);
 	std::vector<double> rhs(N, 0);
 	vector<double>::iterator matiter = mat.dt.begin();
@@ -73,6 +79,51 @@ void LaplaceCE2D::Solve(){
 	}
 }
 
+void LaplaceCE2D::SolveCompressed(double tol){
+	//single (G) and double (H) layer operators
+	HMMath::HMatrix::Options hopt;
+	hopt.aca_tol = tol;
+	HMMath::HMatrix G(xm, ym, [this](int i, int j){ return Ffun(j, xm[i], ym[i]).first; }, hopt);
+	HMMath::HMatrix H(xm, ym, [this](int i, int j){ return Ffun(j, xm[i], ym[i]).second; }, hopt);
+
+	//dirichlet columns: -G; neumann columns: H - I/2
+	vector<double> gdiag = G.diag(), hdiag = H.diag();
+	vector<double> adiag(N);
+	for (int i=0; i<N; ++i) adiag[i] = isdir[i] ? -gdiag[i] : hdiag[i] - 0.5;
+	vector<double> zd(N), zn(N), t(N);
+	auto op = [&](const vector<double>& z, vector<double>& res){
+		for (int i=0; i<N; ++i){
+			zd[i] = isdir[i] ? z[i] : 0;
+			zn[i] = isdir[i] ? 0 : z[i];
+		}
+		std::fill(t.begin(), t.end(), 0.0);
+		std::fill(res.begin(), res.end(), 0.0);
+		G.MultVec(zd, t);
+		H.MultVec(zn, res);
+		for (int i=0; i<N; ++i) res[i] -= t[i] + 0.5*zn[i];
+	};
+
+	//rhs = (I/2 - H)*dirvals + G*neuvals for known values
+	vector<double> rhs(N, 0);
+	for (int i=0; i<N; ++i){
+		zd[i] = isdir[i] ? dirvals[i] : 0;
+		zn[i] = isdir[i] ? 0 : neuvals[i];
+	}
+	std::fill(t.begin(), t.end(), 0.0);
+	H.MultVec(zd, t);
+	G.MultVec(zn, rhs);
+	for (int i=0; i<N; ++i) rhs[i] += 0.5*zd[i] - t[i];
+
+	HMMath::GMRESSolver slv(N, op, adiag, tol);
+	std::vector<double> z(N, 0);
+	slv.Solve(rhs, z);
+
+	for (int i=0; i<N; ++i){
+		if (isdir[i]) neuvals[i] = z[i];
+		else dirvals[i] = z[i];
+	}
+}
+
 int LaplaceCE2D::where_is(double x, double y) const{
 	_THROW_NOT_IMP_;
 }
@@ -22,7 +22,14 @@ class LaplaceCE2D{
 	double E(int k, double x, double y) const;
 public:
 	LaplaceCE2D(const HM2D::Contour::Tree& area);
-	void Solve();
+	//uses dense system for less than dense_nmax elements,
+	//hierarchical matrix compression with gmres otherwise.
+	void Solve(int dense_nmax=1000);
+	//O(N^3) lu solution
+	void SolveDense();
+	//O(N log N) memory and matrix-vector product.
+	//tol - relative tolerance of the compression and iterative solution
+	void SolveCompressed(double tol=1e-8);
 	//set boundary values
 	//default is df/dn=0
 	void dirichlet_value(int i, double value){ isdir[i]=true; dirvals[i]=value; }
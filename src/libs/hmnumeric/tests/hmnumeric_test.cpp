@@ -15,6 +15,7 @@
 #include "hmtimer.hpp"
 #include "treverter2d.hpp"
 #include "densemat.hpp"
+#include "hmfdm.hpp"
 using HMTesting::add_check;
 
 double maxskew(const HM2D::GridData& g){
@@ -243,14 +244,86 @@ void test04(){
 			integral += HM2D::Contour::Area(c->edges)*v;
 		}
 		add_check(fabs(integral - 2.28922)<1e-2, "bem for dirichlet poisson problem");
+
+		HMBem::LaplaceCE2D bemslv2(t1);
+		it = 0;
+		for (auto e: t1.alledges()){
+			double dv = e->boundary_type == 1 ? 1 : 2;
+			bemslv2.dirichlet_value(it++, dv);
+		}
+		bemslv2.SolveCompressed(1e-10);
+		double maxdiff = 0;
+		for (int i=0; i<it; ++i){
+			double d = fabs(bemslv.boundary_data(i).second - bemslv2.boundary_data(i).second);
+			maxdiff = std::max(maxdiff, d);
+		}
+		add_check(maxdiff < 1e-6, "bem with hierarchical matrix compression");
 	}
 };
 
+void test05(){
+	std::cout<<"05. Adaptive auxiliary triangulation"<<std::endl;
+	{
+		//rectangle with a thin slot
+		auto rcont = HM2D::Contour::Constructor::FromPoints({
+			0.0,0.0, 2.0,0.0, 2.0,1.0, 1.02,1.0, 1.02,0.2, 0.98,0.2, 0.98,1.0, 0.0,1.0}, true);
+		HMFem::TAdaptiveAuxGrid3::Options opt(200, 20000, 0.1);
+		HM2D::GridData ans1 = HMFem::AdaptiveAuxGrid3(rcont, opt);
+		add_check(ans1.vvert.size() > 200 && ans1.vvert.size() < 20000, "number of vertices");
+		add_check(fabs(HM2D::Grid::Area(ans1) - fabs(HM2D::Contour::Area(rcont)))<1e-8,
+				"adaptive grid area");
+		add_check([&](){
+			for (auto& c: ans1.vcells) if (c->edges.size() != 3) return false;
+			return true;
+		}(), "adaptive grid is triangular");
+		//grid should be finer near the slot tip
+		double lnear = 0, lfar = 0;
+		int nnear = 0, nfar = 0;
+		for (auto& e: ans1.vedges){
+			Point c = e->center();
+			if (Point::meas(c, Point(1, 0.2)) < 0.01) { lnear += e->length(); ++nnear; }
+			if (Point::meas(c, Point(0.2, 0.5)) < 0.01) { lfar += e->length(); ++nfar; }
+		}
+		add_check(nnear > 0 && nfar > 0 && lnear/nnear < 0.5*lfar/nfar, "refinement near thin feature");
+
+		//refinement stops before vertex limit is exceeded
+		HMFem::TAdaptiveAuxGrid3::Options opt2(200, 400, 1e-6);
+		HM2D::GridData ans2 = HMFem::AdaptiveAuxGrid3(rcont, opt2);
+		add_check(ans2.vvert.size() > 200 && ans2.vvert.size() <= 400, "vertex limit");
+	}
+}
+
+void test06(){
+	std::cout<<"06. Multigrid fdm laplace solver"<<std::endl;
+	int nx = 129, ny = 70;
+	vector<double> x(nx), y(ny);
+	for (int i=0; i<nx; ++i) x[i] = (double)i/(nx-1) + 0.1*sin(3.0*i/(nx-1));
+	for (int j=0; j<ny; ++j) y[j] = 0.5*(exp(4.0*j/(ny-1))-1)/(exp(4.0)-1);
+	auto bfun = [&](int i, int j){ return x[i]*x[i] - y[j]*y[j]; };
+
+	HMFdm::LaplaceSolver slv1(x, y, true), slv2(x, y, false);
+	slv1.SetBndValues(HMFdm::LaplaceSolver::Bnd::All, bfun);
+	slv2.SetBndValues(HMFdm::LaplaceSolver::Bnd::All, bfun);
+	vector<double> ans1, ans2(nx*ny, 0);
+	slv1.Solve(ans1);
+	slv2.Solve(ans2);
+	double err1 = 0, err2 = 0;
+	for (int j=0; j<ny; ++j)
+	for (int i=0; i<nx; ++i){
+		err1 = std::max(err1, fabs(ans1[slv1.glob_index(i, j)] - bfun(i, j)));
+		err2 = std::max(err2, fabs(ans1[slv1.glob_index(i, j)] - ans2[slv2.glob_index(i, j)]));
+	}
+	add_check(err1 < 1e-10, "multigrid for quadratic harmonic function");
+	add_check(err2 < 1e-10, "multigrid vs direct solution");
+}
+
 int main(){
 	test01();
 	test02();
 	test03();
 	test04();
+	test05();
+	test06();
 
 
 	HMTesting::check_final_report();
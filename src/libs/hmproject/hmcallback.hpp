@@ -2,6 +2,7 @@
 #define HYBMESH_CALLBACK_HPP
 #include <functional>
 #include "hmproject.h"
+#include "hmparallel.hpp"
 
 namespace HMCallback{
 struct Caller2;
@@ -146,6 +147,13 @@ class FunctionWithCallback{
 	using TRet = decltype( std::declval<TExecutor>()._run(std::declval<Args>()...) );
 	TExecutor exe;
 
+	//Function objects are global and so are shared between threads.
+	//Calls from parallel loop workers use their own executor.
+	shared_ptr<TExecutor> instance(){
+		if (HMParallel::InParallel()) return std::make_shared<TExecutor>();
+		return shared_ptr<TExecutor>(&exe, [](TExecutor*){});
+	}
+
 	//execution with callback function reset
 	template<class... Args>
 	struct Beholder{
@@ -157,14 +165,14 @@ class FunctionWithCallback{
 	};
 
 	template<class... Args>
-	TRet<Args...> invoke(Args&&... arg){
-		Beholder<Args...> b(&exe);  //to call exe->fin() before return;
+	TRet<Args...> invoke(TExecutor& e, Args&&... arg){
+		Beholder<Args...> b(&e);  //to call exe->fin() before return;
 		try{
-			return exe._run(std::forward<Args>(arg)...);
+			return e._run(std::forward<Args>(arg)...);
 		} catch (...){
 			//exe->fin calls callback with (100% Done) parameters.
 			//if error we suppress this message
-			exe.suppress_done = true;
+			e.suppress_done = true;
 			throw;
 		}
 	}
@@ -179,22 +187,32 @@ class FunctionWithCallback{
 	};
 	template<class... Args>
 	TRet<Args...> invoke1(Caller2& cb, Args&&... arg){
-		Beholder1<Args...> b(cb, &exe);  //to call exe->fin() before return;
-		return exe._run(std::forward<Args>(arg)...);
+		auto e = instance();
+		Beholder1<Args...> b(cb, e.get());  //to call exe->fin() before return;
+		return e->_run(std::forward<Args>(arg)...);
 	}
 	
 	//execution with exeisted callback function with reset
 	template<class... Args>
 	TRet<Args...> invoke2(shared_ptr<Caller2> cb, Args&&... arg){
-		exe.set_callback(cb);
-		Beholder<Args...> b(&exe);  //to call exe->fin() before return;
+		auto e = instance();
+		e->set_callback(cb);
+		Beholder<Args...> b(e.get());  //to call exe->fin() before return;
 		try{
-			return exe._run(std::forward<Args>(arg)...);
+			return e->_run(std::forward<Args>(arg)...);
 		} catch(...){
-			exe.suppress_done = true;
+			e->suppress_done = true;
 			throw;
 		}
 	}
+
+	//execution with a callback function
+	template<class TCallback, class... Args>
+	TRet<Args...> invoke3(TCallback&& cb, Args&&... arg){
+		auto e = instance();
+		e->set_callback(std::forward<TCallback>(cb));
+		return invoke(*e, std::forward<Args>(arg)...);
+	}
 public:
 	FunctionWithCallback(): exe(){}
 
@@ -204,43 +222,37 @@ public:
 	//call with inactive callback
 	template<class... Args>
 	TRet<Args...> operator()(Args&&... arg){
-		exe.set_callback(silent2);
-		return invoke(std::forward<Args>(arg)...);
+		return invoke3(silent2, std::forward<Args>(arg)...);
 	}
 
 	//call with inactive callback
 	template<class... Args>
 	TRet<Args...> Silent(Args&&... arg){
-		exe.set_callback(silent2);
-		return invoke(std::forward<Args>(arg)...);
+		return invoke3(silent2, std::forward<Args>(arg)...);
 	}
 
 	//call with cout callback
 	template<class... Args>
 	TRet<Args...> ToCout(Args&&... arg){
-		exe.set_callback(to_cout2);
-		return invoke(std::forward<Args>(arg)...);
+		return invoke3(to_cout2, std::forward<Args>(arg)...);
 	}
 
 	//call with callback with timer
 	template<class... Args>
 	TRet<Args...> WTimer(Args&&... arg){
-		exe.set_callback(to_cout2_timer);
-		return invoke(std::forward<Args>(arg)...);
+		return invoke3(to_cout2_timer, std::forward<Args>(arg)...);
 	}
 	
 	//call with callback with timer including bottom lines
 	template<class... Args>
 	TRet<Args...> WVerbTimer(Args&&... arg){
-		exe.set_callback(to_cout2_verbtimer);
-		return invoke(std::forward<Args>(arg)...);
+		return invoke3(to_cout2_verbtimer, std::forward<Args>(arg)...);
 	}
 
 	//call with defined callback with its copy and initializing
 	template<class TCallback, class... Args>
 	TRet<Args...> WithCallback(TCallback&& cb, Args&&... arg){
-		exe.set_callback(std::forward<TCallback>(cb));
-		return invoke(std::forward<Args>(arg)...);
+		return invoke3(std::forward<TCallback>(cb), std::forward<Args>(arg)...);
 	}
 
 	//run with existing callback without it reinitializing
@@ -0,0 +1,41 @@
+#include "hmparallel.hpp"
+#include <cstdlib>
+
+namespace{
+int default_nthreads(){
+	const char* env = std::getenv("HYBMESH_NUM_THREADS");
+	if (env != nullptr){
+		int n = std::atoi(env);
+		if (n > 0) return n;
+	}
+	int n = std::thread::hardware_concurrency();
+	return (n > 0) ? n : 1;
+}
+std::atomic<int> _nthreads(0);
+thread_local int _worker_depth = 0;
+std::mutex _gmsh_mutex;
+}
+
+int HMParallel::NThreads(){
+	int n = _nthreads.load();
+	if (n <= 0){
+		n = default_nthreads();
+		_nthreads = n;
+	}
+	return n;
+}
+
+void HMParallel::SetNThreads(int n){
+	_nthreads = (n > 0) ? n : 0;
+}
+
+bool HMParallel::InParallel(){
+	return _worker_depth > 0;
+}
+
+HMParallel::WorkerScope::WorkerScope(){ ++_worker_depth; }
+HMParallel::WorkerScope::~WorkerScope(){ --_worker_depth; }
+
+std::mutex& HMParallel::GmshMutex(){
+	return _gmsh_mutex;
+}
@@ -0,0 +1,74 @@
+#ifndef HMPROJECT_PARALLEL_HPP
+#define HMPROJECT_PARALLEL_HPP
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <vector>
+#include <algorithm>
+
+namespace HMParallel{
+
+//Number of worker threads used by parallel algorithms.
+//Defaults to HYBMESH_NUM_THREADS environment variable or hardware concurrency.
+int NThreads();
+//n <= 0 restores the default value
+void SetNThreads(int n);
+//true if called from inside a parallel loop body.
+//Nested parallel loops are executed serially.
+bool InParallel();
+
+//gmsh keeps its state in global variables.
+//All gmsh model building and meshing should be guarded by this mutex.
+std::mutex& GmshMutex();
+
+//marks the current thread as a parallel loop worker while alive
+struct WorkerScope{
+	WorkerScope();
+	~WorkerScope();
+};
+
+//calls fun(i) for i in [0, n) using at most nthreads threads.
+//Indices are processed in chunks of consecutive values.
+//If n < minsize, only one thread is available or the loop is nested
+//into another parallel loop, it is executed serially.
+//The first exception thrown by fun is rethrown in the calling thread.
+template<class Fun>
+void For(int n, Fun&& fun, int minsize=2, int nthreads=0){
+	if (nthreads <= 0) nthreads = NThreads();
+	nthreads = std::min(nthreads, n);
+	if (n < minsize || nthreads < 2 || InParallel()){
+		for (int i=0; i<n; ++i) fun(i);
+		return;
+	}
+	int chunk = std::max(1, n/(8*nthreads));
+	std::atomic<int> next(0);
+	std::exception_ptr err;
+	std::mutex errmut;
+
+	auto worker = [&](){
+		WorkerScope ws;
+		try{
+			while (true){
+				int s = next.fetch_add(chunk);
+				if (s >= n) break;
+				int e = std::min(n, s + chunk);
+				for (int i=s; i<e; ++i) fun(i);
+			}
+		} catch (...){
+			std::lock_guard<std::mutex> lk(errmut);
+			if (!err) err = std::current_exception();
+			next = n;
+		}
+	};
+	std::vector<std::thread> pool;
+	for (int i=0; i<nthreads-1; ++i) pool.emplace_back(worker);
+	worker();
+	for (auto& t: pool) t.join();
+	if (err) std::rethrow_exception(err);
+}
+
+}
+
+#endif
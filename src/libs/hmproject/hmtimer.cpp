@@ -3,6 +3,14 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <sstream>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
 
 using namespace HMTimer;
 
@@ -30,6 +38,25 @@ struct _tclass{
 	}
 };
 _tclass _alltimers;
+
+struct _rclass{
+	_rclass(): on(std::getenv("HYBMESH_RECORDS") != nullptr){}
+	std::atomic<bool> on;
+	std::vector<Record> data;
+	std::mutex mut;
+};
+_rclass _allrecords;
+
+void json_string(std::ostream& os, const std::string& s){
+	os<<'"';
+	for (char c: s){
+		if (c == '"' || c == '\\') os<<'\\'<<c;
+		else if (c == '\n') os<<"\\n";
+		else if (c == '\t') os<<"\\t";
+		else os<<c;
+	}
+	os<<'"';
+}
 }
 
 void HMTimer::Tic(std::string s){
@@ -78,7 +105,8 @@ void HMTimer::FinReport(std::string s){
 	}
 }
 
-TicToc::TicToc(const char* _name, bool start):name(_name), is_working(start), dur(TDuration::zero()){
+TicToc::TicToc(const char* _name, bool start):name(_name), is_working(false), dur(TDuration::zero()){
+	//tic() sets the start time only for a stopped timer
 	if (start) tic();
 }
 void TicToc::init(){
@@ -105,4 +133,60 @@ double TicToc::elapsed() const{
 	else return  (dur + std::chrono::duration_cast<TDuration>(TClock::now() - tp)).count();
 }
 
+double HMTimer::PeakMemory(){
+#ifndef WIN32
+	struct rusage u;
+	if (getrusage(RUSAGE_SELF, &u) != 0) return 0;
+#ifdef __APPLE__
+	return u.ru_maxrss;
+#else
+	//linux reports kilobytes
+	return 1024.0*u.ru_maxrss;
+#endif
+#else
+	return 0;
+#endif
+}
+
+bool HMTimer::IsRecording(){ return _allrecords.on; }
+void HMTimer::SetRecording(bool val){ _allrecords.on = val; }
+
+void HMTimer::AddRecord(const Record& rec){
+	if (!_allrecords.on) return;
+	std::lock_guard<std::mutex> lk(_allrecords.mut);
+	_allrecords.data.push_back(rec);
+}
+
+std::vector<Record> HMTimer::Records(){
+	std::lock_guard<std::mutex> lk(_allrecords.mut);
+	return _allrecords.data;
+}
+
+void HMTimer::ClearRecords(){
+	std::lock_guard<std::mutex> lk(_allrecords.mut);
+	_allrecords.data.clear();
+}
 
+std::string HMTimer::RecordsToJson(){
+	std::ostringstream os;
+	os.precision(10);
+	os<<"[";
+	auto recs = Records();
+	for (int i=0; i<recs.size(); ++i){
+		if (i > 0) os<<", ";
+		os<<"{\"category\": "; json_string(os, recs[i].category);
+		os<<", \"name\": "; json_string(os, recs[i].name);
+		os<<", \"fields\": {";
+		for (int j=0; j<recs[i].fields.size(); ++j){
+			if (j > 0) os<<", ";
+			json_string(os, recs[i].fields[j].first);
+			double v = recs[i].fields[j].second;
+			//json has no representation for nan and inf
+			if (std::isfinite(v)) os<<": "<<v;
+			else os<<": null";
+		}
+		os<<"}}";
+	}
+	os<<"]";
+	return os.str();
+}
@@ -3,6 +3,7 @@
 
 #include <chrono>
 #include <string>
+#include <vector>
 
 namespace HMTimer{
 
@@ -36,6 +37,31 @@ void Toc(std::string s="");        //stops it or all if ""
 void Report(std::string s="");     //reports timer with string id or all
 void FinReport(std::string s="");  //reports and deletes timer with id or all
 
+//peak resident set size of the process in bytes. Returns 0 if not supported.
+double PeakMemory();
+
+//Structured performance records.
+//Solvers and other heavy procedures push a record with a category
+//(f.e. "MatSolve"), a name (f.e. "SuiteSparseQR") and a set of named numeric values.
+//Recording is off by default. It is switched on by SetRecording(true)
+//or by HYBMESH_RECORDS environment variable.
+struct Record{
+	Record(std::string category, std::string name): category(category), name(name){}
+	Record& add(std::string key, double val){ fields.emplace_back(key, val); return *this; }
+
+	std::string category;
+	std::string name;
+	std::vector<std::pair<std::string, double>> fields;
+};
+bool IsRecording();
+void SetRecording(bool val);
+//thread safe. Does nothing if recording is off.
+void AddRecord(const Record& rec);
+std::vector<Record> Records();
+void ClearRecords();
+//json array of {"category": ..., "name": ..., "fields": {key: value, ...}} objects
+std::string RecordsToJson();
+
 }
 
 #endif
@@ -2,6 +2,8 @@
 #include "clipper_core.hpp"
 #include "gpc_core.hpp"
 #include "assemble2d.hpp"
+#include "hmparallel.hpp"
+#include "spacefill.hpp"
 
 namespace ci = HM2D::Contour::Clip;
 using namespace ci;
@@ -33,6 +35,34 @@ TRet assign_btypes(const ECont& c1, const vector<ECont>& c2, TRet&& ret){
 	HM2D::ECol::Algos::AssignBTypes(ac, ae);
 	return ret;
 }
+
+//indices of contours sorted along z-order curve built by their bounding box centers.
+//Neighbouring entries of the result are likely to be spatially close.
+vector<int> spatial_order(const vector<ECont>& cont){
+	vector<double> centers(2*cont.size());
+	for (int i=0; i<cont.size(); ++i){
+		Point c = HM2D::BBox(cont[i]).center();
+		centers[2*i] = c.x;
+		centers[2*i+1] = c.y;
+	}
+	return HMMath::SFC::MortonOrder(centers, 2);
+}
+
+//pairwise reduction: data[0] = op(data[0], data[1], ... data[n-1]).
+//Pairs of each tree level are processed in parallel.
+//op should be associative.
+template<class T, class TOp>
+T& tree_reduce(vector<T>& data, TOp&& op){
+	int n = data.size();
+	for (int step=1; step<n; step*=2){
+		int npairs = (n + 2*step - 1)/(2*step);
+		HMParallel::For(npairs, [&](int k){
+			int i = 2*step*k;
+			if (i + step < n) data[i] = op(data[i], data[i+step]);
+		});
+	}
+	return data[0];
+}
 };
 
 //#define USE_LIBCLIPPER_FOR_CLIPPING
@@ -223,7 +253,10 @@ TRet ci::Difference(const ETree& c1, const ECont& c2){
 }
 
 TRet ci::Difference(const ECont& c1, const ETree& c2){
-	_THROW_NOT_IMP_;
+	Impl::GpcTree p1(c1), p2(c2);
+	return assign_btypes(
+		c1, c2.alledges(),
+		Impl::GpcTree::Substract(p1, p2).ToContourTree());
 }
 
 //two trees
@@ -258,32 +291,40 @@ TRet ci::XOR(const ETree& c1, const ETree& c2){
 
 //multiple contours operation.
 //Direction of each contour is not taken into account.
+namespace{
+//contours sorted in spatial order are processed by pairwise reduction
+//so that each clipping involves only neighbouring contours.
+using HM2D::Impl::GpcTree;
+GpcTree gpc_reduce(const vector<ECont>& cont,
+		GpcTree (*op)(const GpcTree&, const GpcTree&)){
+	vector<GpcTree> p1; p1.reserve(cont.size());
+	for (int i: spatial_order(cont)) p1.push_back(GpcTree(cont[i]));
+	return std::move(tree_reduce(p1, op));
+}
+}
+
 TRet ci::Intersection(const vector<ECont>& cont){
-	_THROW_NOT_IMP_;
+	if (cont.size() == 0) return TRet();
+	return assign_btypes(
+		cont,
+		gpc_reduce(cont, &Impl::GpcTree::Intersect).ToContourTree());
 }
 
 TRet ci::Union(const vector<ECont>& cont){
 	if (cont.size() == 0) return TRet();
-	vector<Impl::GpcTree> p1; p1.reserve(cont.size());
-	for (auto& c: cont) p1.push_back(Impl::GpcTree(c));
-	for (int i=1; i<cont.size(); ++i){
-		p1[0] = Impl::GpcTree::Union(p1[0], p1[i]);
-	}
 	return assign_btypes(
 		cont,
-		p1[0].ToContourTree());
+		gpc_reduce(cont, &Impl::GpcTree::Union).ToContourTree());
 }
 
 TRet ci::Difference(const ETree& c1, const vector<ECont>& cont){
 	if (cont.size() == 0) return Contour::Tree::DeepCopy(c1);
+	//c1 - (cont[0] + cont[1] + ...)
 	Impl::GpcTree p1(c1);
-	for (auto& c: cont){
-		Impl::GpcTree g(c);
-		p1 = Impl::GpcTree::Substract(p1, g);
-	}
+	Impl::GpcTree p2 = gpc_reduce(cont, &Impl::GpcTree::Union);
 	return assign_btypes(
 		c1.alledges(), cont,
-		p1.ToContourTree());
+		Impl::GpcTree::Substract(p1, p2).ToContourTree());
 }
 
 void ci::Heal(TRet& c1){
@@ -1,5 +1,6 @@
 #include "export2d_vtk.hpp"
 #include <fstream>
+#include <cstdio>
 #include "contour.hpp"
 #include "contour_tree.hpp"
 
@@ -119,6 +120,68 @@ void Export::GridVDataVTK(const GridData& g, const vector<double>& dt, std::stri
 	add_vtk_data(dt, "vertex_data", fn, false, true);
 }
 
+Export::GridVTKStream::GridVTKStream(std::string fn): fn(fn),
+		fnpts(fn + ".points.tmp"), fncells(fn + ".cells.tmp"),
+		fpts(fnpts), fcells(fncells),
+		npts(0), ncells(0), ncellvert(0), finished(false){
+	if (!fpts || !fcells) throw std::runtime_error("failed to open " + fn + " temporary files");
+}
+
+Export::GridVTKStream::~GridVTKStream(){
+	if (!finished){
+		fpts.close();
+		fcells.close();
+		std::remove(fnpts.c_str());
+		std::remove(fncells.c_str());
+	}
+}
+
+void Export::GridVTKStream::add_points(const vector<Point>& pts){
+	for (auto& p: pts){
+		fpts<<(float)p.x<<" "<<(float)p.y<<" 0"<<'\n';
+	}
+	npts += pts.size();
+}
+
+void Export::GridVTKStream::add_cells(const vector<vector<int>>& cellvert){
+	for (auto& c: cellvert){
+		fcells<<c.size()<<"  ";
+		for (auto i: c) fcells<<i<<" ";
+		fcells<<'\n';
+		ncellvert += c.size() + 1;
+	}
+	ncells += cellvert.size();
+}
+
+void Export::GridVTKStream::fin(){
+	//lines are not flushed one by one, temporary files are flushed here
+	fpts.close();
+	fcells.close();
+	std::ofstream fs(fn);
+	fs<<"# vtk DataFile Version 3.0"<<std::endl;
+	fs<<"HybMesh Grid 2D"<<std::endl;
+	fs<<"ASCII"<<std::endl;
+	//Points
+	fs<<"DATASET UNSTRUCTURED_GRID"<<std::endl;
+	fs<<"POINTS "<<npts<< " float"<<std::endl;
+	{
+		std::ifstream f(fnpts);
+		if (npts > 0) fs<<f.rdbuf();
+	}
+	//Cells
+	fs<<"CELLS  "<<ncells<<"   "<<ncellvert<<std::endl;
+	{
+		std::ifstream f(fncells);
+		if (ncells > 0) fs<<f.rdbuf();
+	}
+	fs<<"CELL_TYPES  "<<ncells<<std::endl;
+	for (int i=0;i<ncells;++i) fs<<7<<'\n';
+	fs.close();
+	std::remove(fnpts.c_str());
+	std::remove(fncells.c_str());
+	finished = true;
+}
+
 void Export::BoundaryVTK(const GridData& g, std::string fn){
 	//save contour
 	auto ct = HM2D::Contour::Tree::GridBoundary(g).alledges();
@@ -2,6 +2,7 @@
 #define HYBMESH_VTK_EXPORT2D
 
 #include "primitives2d.hpp"
+#include <fstream>
 
 namespace HM2D{ namespace Export{
 
@@ -16,5 +17,26 @@ void GridVDataVTK(const GridData& g, const vector<double>& dt, std::string fn);
 
 void BoundaryVTK(const GridData& g, std::string fn);
 
+//Writes a grid which is given by parts without keeping it in memory.
+//Points and cells are buffered in temporary files next to fn
+//which are assembled into fn by fin().
+class GridVTKStream{
+public:
+	GridVTKStream(std::string fn);
+	~GridVTKStream();
+
+	//points get consecutive indices in order of addition
+	void add_points(const vector<Point>& pts);
+	//cells are given by indices of their points
+	void add_cells(const vector<vector<int>>& cellvert);
+	//writes resulting file and removes temporary ones
+	void fin();
+private:
+	std::string fn, fnpts, fncells;
+	std::ofstream fpts, fcells;
+	int npts, ncells, ncellvert;
+	bool finished;
+};
+
 }}
 #endif
@@ -3,6 +3,7 @@
 #include "clipper_core.hpp"
 #include "modcont.hpp"
 #include "hmtimer.hpp"
+#include "hmparallel.hpp"
 
 using namespace HM2D;
 
@@ -88,6 +89,164 @@ std::tuple<int, double> Finder::ClosestPoint(const VertexData& dt, const Point&
 	return ret;
 }
 
+// =============== closest edge/point finders
+namespace{
+
+//calls fun(entry) for bbf entries from squares lying layer by layer around p.
+//fun returns squared radius of the area which still should be examined.
+template<class TFun>
+void ring_search(const BoundingBoxFinder& bbf, const Point& p, TFun&& fun){
+	int nx = bbf.nx(), ny = bbf.ny();
+	double hx = bbf.stepx(), hy = bbf.stepy();
+	Point p0 = bbf.pmin(), p1 = bbf.pmax();
+	//square containing p (or closest to p if p is outside)
+	int cx = std::min(double(nx-1), std::max(0.0, floor((p.x - p0.x)/hx)));
+	int cy = std::min(double(ny-1), std::max(0.0, floor((p.y - p0.y)/hy)));
+	//distance from p to the finder area in x and y directions
+	double dxo = std::max(0.0, std::max(p0.x - p.x, p.x - p1.x));
+	double dyo = std::max(0.0, std::max(p0.y - p.y, p.y - p1.y));
+
+	double rad2 = std::numeric_limits<double>::max();
+	auto visit = [&](int ix, int iy){
+		for (int e: bbf.sqr_entries(iy*nx + ix)) rad2 = fun(e);
+	};
+	for (int k=0; ; ++k){
+		int ix0 = cx-k, ix1 = cx+k, iy0 = cy-k, iy1 = cy+k;
+		//k-th layer
+		if (k == 0) visit(cx, cy);
+		else {
+			int jx0 = std::max(0, ix0), jx1 = std::min(nx-1, ix1);
+			int jy0 = std::max(0, iy0+1), jy1 = std::min(ny-1, iy1-1);
+			if (iy0 >= 0) for (int ix=jx0; ix<=jx1; ++ix) visit(ix, iy0);
+			if (iy1 < ny) for (int ix=jx0; ix<=jx1; ++ix) visit(ix, iy1);
+			if (ix0 >= 0) for (int iy=jy0; iy<=jy1; ++iy) visit(ix0, iy);
+			if (ix1 < nx) for (int iy=jy0; iy<=jy1; ++iy) visit(ix1, iy);
+		}
+		//squared distance to the area outside examined layers
+		double lb2 = std::numeric_limits<double>::max();
+		if (ix1 < nx-1) lb2 = std::min(lb2, sqr(p0.x + (ix1+1)*hx - p.x) + dyo*dyo);
+		if (ix0 > 0) lb2 = std::min(lb2, sqr(p.x - p0.x - ix0*hx) + dyo*dyo);
+		if (iy1 < ny-1) lb2 = std::min(lb2, sqr(p0.y + (iy1+1)*hy - p.y) + dxo*dxo);
+		if (iy0 > 0) lb2 = std::min(lb2, sqr(p.y - p0.y - iy0*hy) + dxo*dxo);
+		if (lb2 == std::numeric_limits<double>::max() || lb2 > rad2) break;
+	}
+}
+
+//step of the finder grid for n entries within bb
+double finder_step(const BoundingBox& bb, int n){
+	return std::max(geps, bb.maxlen()/std::max(1.0, sqrt(n)));
+}
+
+//squared distances to edges closer than sqrt(minimal squared distance + d2tol).
+//Sorted by edge index
+vector<std::pair<int, double>>
+closest_edge_candidates(const EdgeData& data, const BoundingBoxFinder& bbf,
+		const Point& p, std::function<double(double)> rad2){
+	vector<std::pair<int, double>> cand;
+	double best = std::numeric_limits<double>::max();
+	double r2 = best;
+	ring_search(bbf, p, [&](int i)->double{
+		double m = Point::meas_section(p, *data[i]->pfirst(), *data[i]->plast());
+		if (m <= r2) {
+			cand.emplace_back(i, m);
+			if (m < best){ best = m; r2 = rad2(best); }
+		}
+		return r2;
+	});
+	auto it = std::remove_if(cand.begin(), cand.end(),
+		[&r2](const std::pair<int, double>& c){ return c.second > r2; });
+	cand.resize(it - cand.begin());
+	std::sort(cand.begin(), cand.end());
+	it = std::unique(cand.begin(), cand.end());
+	cand.resize(it - cand.begin());
+	return cand;
+}
+}
+
+Finder::ClosestEdgeFinder::ClosestEdgeFinder(const EdgeData& dt): data(&dt){
+	if (dt.size() == 0) return;
+	auto bb = HM2D::BBox(dt);
+	bbf.reset(new BoundingBoxFinder(bb, finder_step(bb, dt.size())));
+	for (auto& e: dt){
+		bbf->raw_addentry(bbf->sqrs_by_segment(*e->pfirst(), *e->plast()));
+	}
+}
+
+std::tuple<int, double, double>
+Finder::ClosestEdgeFinder::find(const Point& p) const{
+	if (data->size() == 0) return ClosestEdge(*data, p);
+	//ClosestEdge takes the last edge among those with squared distances
+	//differing by less than geps^2 (or the first edge containing p).
+	//Here we gather all edges within certain tolerance and repeat its choice.
+	const double e2 = geps*geps, tol = 1e4*e2;
+	auto cand = closest_edge_candidates(*data, *bbf, p,
+		[&tol](double m){ return m + tol; });
+	auto mincand = std::min_element(cand.begin(), cand.end(),
+		[](const std::pair<int, double>& a, const std::pair<int, double>& b){
+			return a.second < b.second; });
+	int ind = mincand->first;
+	double dist = mincand->second;
+	if (dist < e2){
+		//first edge containing p
+		for (auto& c: cand) if (c.second < e2) { ind = c.first; break; }
+	} else {
+		for (auto it=mincand+1; it!=cand.end(); ++it) if (it->second - dist < e2){
+			ind = it->first;
+			dist = it->second;
+		}
+		//tolerance was not enough to repeat ClosestEdge. Use it explicitly.
+		if (dist + e2 > mincand->second + tol) return ClosestEdge(*data, p);
+	}
+	double ksi;
+	auto& e = (*data)[ind];
+	dist = Point::meas_section(p, *e->first(), *e->last(), ksi);
+	return std::make_tuple(ind, sqrt(dist), ksi);
+}
+
+Point Finder::ClosestEdgeFinder::find_point(const Point& p) const{
+	auto fec = find(p);
+	auto e = (*data)[std::get<0>(fec)];
+	return Point::Weigh(*e->first(), *e->last(), std::get<2>(fec));
+}
+
+int Finder::ClosestEdgeFinder::find_first(const Point& p) const{
+	if (data->size() == 0) return -1;
+	auto cand = closest_edge_candidates(*data, *bbf, p,
+		[](double m){ return sqr(sqrt(m) + geps); });
+	double mindist = std::min_element(cand.begin(), cand.end(),
+		[](const std::pair<int, double>& a, const std::pair<int, double>& b){
+			return a.second < b.second; })->second;
+	if (mindist < geps*geps){
+		for (auto& c: cand) if (c.second < geps*geps) return c.first;
+	}
+	mindist = sqrt(mindist);
+	for (auto& c: cand) if (sqrt(c.second) < mindist + geps) return c.first;
+	return cand[0].first;
+}
+
+Finder::ClosestPointFinder::ClosestPointFinder(const VertexData& dt): data(&dt){
+	if (dt.size() == 0) return;
+	auto bb = BoundingBox::PBuild(dt.begin(), dt.end());
+	bbf.reset(new BoundingBoxFinder(bb, finder_step(bb, dt.size())));
+	for (auto& v: dt) bbf->addentry(BoundingBox(*v));
+}
+
+std::tuple<int, double> Finder::ClosestPointFinder::find(const Point& p) const{
+	if (data->size() == 0) return std::tuple<int, double>(-1, -1);
+	//first point among those with minimal distance
+	int bind = -1;
+	double bm = std::numeric_limits<double>::max();
+	ring_search(*bbf, p, [&](int i)->double{
+		double m = Point::meas(*(*data)[i], p);
+		if (m < bm || (m == bm && i < bind)){
+			bm = m;
+			bind = i;
+		}
+		return bm;
+	});
+	return std::tuple<int, double>(bind, sqrt(bm));
+}
+
 // =============== EdgeFinder
 Finder::EdgeFinder::EdgeFinder(const EdgeData& d){
 	ve = Connectivity::VertexEdge(d);
@@ -184,11 +343,75 @@ NEXTTRY:
 }
 
 // =============== Crosses
+BoundingBox Finder::CrossBox(const Point& p1, const Point& p2){
+	return BoundingBox(p1, p2, geps*(1.0 + Point::dist(p1, p2)));
+}
+
+namespace{
+//fills ret with pairs (i, j) where b1[i] and b2[j] intersect and i<j if self = true.
+//Set self = true for b1 == b2.
+vector<std::pair<int, int>> box_pairs(const vector<BoundingBox>& b1,
+		const vector<BoundingBox>& b2, bool self){
+	vector<std::pair<int, int>> ret;
+	if (b1.size() == 0 || b2.size() == 0) return ret;
+	//brute force for small inputs
+	if (b1.size()*b2.size() < 500){
+		for (int i=0; i<b1.size(); ++i)
+		for (int j=(self ? i+1 : 0); j<b2.size(); ++j)
+			if (b1[i].has_common_points(b2[j])) ret.emplace_back(i, j);
+		return ret;
+	}
+	BoundingBox area1(b1), area2(b2);
+	if (!area1.has_common_points(area2)) return ret;
+	//only common area matters
+	BoundingBox area(std::max(area1.xmin, area2.xmin), std::max(area1.ymin, area2.ymin),
+	                 std::min(area1.xmax, area2.xmax), std::min(area1.ymax, area2.ymax));
+	area.widen(geps);
+	//grid step: mean box size but not more than 4 squares per box
+	double meanlen = 0;
+	for (auto& bb: b2) meanlen += bb.maxlen();
+	meanlen /= b2.size();
+	double L = std::max(meanlen, sqrt(area.lenx()*area.leny()/(4.0*b2.size())));
+	BoundingBoxFinder bbf(area, std::max(L, geps));
+	for (auto& bb: b2) bbf.addentry(bb);
+
+	vector<vector<int>> found(b1.size());
+	HMParallel::For(b1.size(), [&](int i){
+		if (!b1[i].has_common_points(area)) return;
+		for (int j: bbf.suspects(b1[i])){
+			if (self && j <= i) continue;
+			if (b1[i].has_common_points(b2[j])) found[i].push_back(j);
+		}
+		std::sort(found[i].begin(), found[i].end());
+		found[i].resize(std::unique(found[i].begin(), found[i].end()) - found[i].begin());
+	}, 1000);
+	for (int i=0; i<b1.size(); ++i)
+	for (int j: found[i]) ret.emplace_back(i, j);
+	return ret;
+}
+
+vector<BoundingBox> cross_boxes(const VertexData& op){
+	vector<BoundingBox> ret;
+	for (int i=0; i<(int)op.size()-1; ++i) ret.push_back(Finder::CrossBox(*op[i], *op[i+1]));
+	return ret;
+}
+}
+
+vector<std::pair<int, int>>
+Finder::BoxPairs(const vector<BoundingBox>& b1, const vector<BoundingBox>& b2){
+	return box_pairs(b1, b2, false);
+}
+vector<std::pair<int, int>>
+Finder::BoxPairs(const vector<BoundingBox>& b){
+	return box_pairs(b, b, true);
+}
+
 namespace{
 vector<std::tuple<bool, Point, double, double>>
 cross_core(const EdgeData& c1, const EdgeData& c2, bool is1){
 	typedef std::tuple<bool, Point, double, double> RetT;
 	vector<RetT> retv;
+	if (c1.size() == 0 || c2.size() == 0) return retv;
 	auto bb1 = HM2D::BBox(c1), bb2 = HM2D::BBox(c2);
 	if (!bb1.has_common_points(bb2)) return retv;
 
@@ -198,32 +421,35 @@ cross_core(const EdgeData& c1, const EdgeData& c2, bool is1){
 	auto lens1 = Contour::ELengths(c1), lens2 = Contour::ELengths(c2);
 	double flen1 = std::accumulate(lens1.begin(), lens1.end(), 0.0);
 	double flen2 = std::accumulate(lens2.begin(), lens2.end(), 0.0);
+	//lengths coordinates of section starts
+	vector<double> L1(lens1.size(), 0), L2(lens2.size(), 0);
+	std::partial_sum(lens1.begin(), lens1.end()-1, L1.begin()+1);
+	std::partial_sum(lens2.begin(), lens2.end()-1, L2.begin()+1);
 
 	auto addcross = [&](Point p, double w1, double w2){
 		retv.push_back(std::make_tuple(true, p, w1, w2));
 	};
+	//only sections which boxes intersect could cross
+	auto pairs = Finder::BoxPairs(cross_boxes(op1), cross_boxes(op2));
 	double ksieta[2];
-	double L1=0.0, L2=0.0;
-	for (int i=0; i<op1.size()-1; ++i){
-		L2 = 0;
-		for (int j=0; j<op2.size()-1; ++j){
-			SectCross(*op1[i], *op1[i+1], *op2[j], *op2[j+1], ksieta);
-			if (ksieta[0]>-geps && ksieta[0]<1+geps && ksieta[1]>-geps && ksieta[1]<1+geps){
-				addcross(Point::Weigh(*op1[i], *op1[i+1], ksieta[0]),
-					(L1 + lens1[i]*ksieta[0])/flen1,
-					(L2 + lens2[j]*ksieta[1])/flen2
-				);
-			}
-			L2+=lens2[j];
+	for (int k=0; k<pairs.size(); ++k){
+		int i = pairs[k].first, j = pairs[k].second;
+		SectCross(*op1[i], *op1[i+1], *op2[j], *op2[j+1], ksieta);
+		if (ksieta[0]>-geps && ksieta[0]<1+geps && ksieta[1]>-geps && ksieta[1]<1+geps){
+			addcross(Point::Weigh(*op1[i], *op1[i+1], ksieta[0]),
+				(L1[i] + lens1[i]*ksieta[0])/flen1,
+				(L2[j] + lens2[j]*ksieta[1])/flen2
+			);
 		}
-		if (is1 && retv.size()>0) {
+		//first section of c1 which has crosses
+		bool lasti = (k == pairs.size()-1 || pairs[k+1].first != i);
+		if (is1 && lasti && retv.size()>0) {
 			if (retv.size() == 1) return retv;
 			auto me = min_element(retv.begin(), retv.end(),
 				[](const RetT& a, const RetT& b){
 					return std::get<2>(a)<std::get<2>(b);});
 			return {*me};
 		}
-		L1 += lens1[i];
 	}
 	if (retv.size() < 2) return retv;
 
@@ -258,8 +484,11 @@ Contour::Finder::SelfCross(const EdgeData& c1){
 	double ksi[2];
 	bool closed = IsClosed(c1);
 
-	for (int i=0; i<c1.size(); ++i)
-	for (int j=i+2; j<c1.size(); ++j){
+	vector<BoundingBox> boxes;
+	for (auto& e: c1) boxes.push_back(HM2D::Finder::CrossBox(*e->first(), *e->last()));
+	for (auto& ij: HM2D::Finder::BoxPairs(boxes)){
+		int i = ij.first, j = ij.second;
+		if (j < i+2) continue;
 		if (closed && i==0 && j==c1.size()-1) continue;
 		SectCross(*c1[i]->first(), *c1[i]->last(),
 		          *c1[j]->first(), *c1[j]->last(), ksi);
@@ -30,6 +30,50 @@ Point ClosestEPoint(const EdgeData& dt, const Point& p);
 //<1> - squared distance to point
 std::tuple<int, double> ClosestPoint(const VertexData& dt, const Point& p);
 
+//Spatial index for multiple closest edge queries.
+//Edges are registered in squares of a regular grid which are
+//examined layer by layer around the query point.
+//Input data order and coordinates should not be changed while using the finder.
+//All find methods are thread safe.
+class ClosestEdgeFinder{
+	const EdgeData* data;
+	shared_ptr<BoundingBoxFinder> bbf;
+public:
+	ClosestEdgeFinder(const EdgeData& data);
+
+	//same result as ClosestEdge(data, p)
+	std::tuple<int, double, double> find(const Point& p) const;
+	//same result as ClosestEPoint(data, p)
+	Point find_point(const Point& p) const;
+	//closest edge index or -1 if data is empty.
+	//Among edges which distances to p differ by less than geps the first one is taken.
+	//If p lies on edges the first of them is taken.
+	int find_first(const Point& p) const;
+};
+
+//Spatial index for multiple closest point queries.
+//Input data order and coordinates should not be changed while using the finder.
+class ClosestPointFinder{
+	const VertexData* data;
+	shared_ptr<BoundingBoxFinder> bbf;
+public:
+	ClosestPointFinder(const VertexData& data);
+
+	//same result as ClosestPoint(data, p)
+	std::tuple<int, double> find(const Point& p) const;
+};
+
+//Broad phase of segments crossing detection.
+//Bounding box of [p1, p2] segment widened by SectCross tolerance:
+//if SectCross ksi, eta lie within [-geps, 1+geps] then cross point
+//lies within boxes of both segments.
+BoundingBox CrossBox(const Point& p1, const Point& p2);
+//all (i, j) pairs for which b1[i] and b2[j] have common points sorted by i, then by j.
+//Boxes are registered in squares of a regular grid so only neighbouring boxes are compared.
+vector<std::pair<int, int>> BoxPairs(const vector<BoundingBox>& b1, const vector<BoundingBox>& b2);
+//same for a single set of boxes. Only i < j pairs are returned.
+vector<std::pair<int, int>> BoxPairs(const vector<BoundingBox>& b);
+
 //Finds edge by two vertices.
 class EdgeFinder{
 	vector<Connectivity::VertexEdgeR> ve;
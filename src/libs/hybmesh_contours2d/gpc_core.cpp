@@ -82,6 +82,14 @@ GpcTree& GpcTree::operator=(const GpcTree& other){
 	return *this;
 }
 
+GpcTree& GpcTree::operator=(GpcTree&& other) noexcept{
+	if (&other == this) return *this;
+	gpc_free_polygon(&poly);
+	poly = other.poly;
+	other.poly = {0, 0, 0};
+	return *this;
+}
+
 GpcTree::~GpcTree(){
 	gpc_free_polygon(&poly);
 }
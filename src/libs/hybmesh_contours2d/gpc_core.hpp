@@ -18,6 +18,7 @@ public:
 	GpcTree(const GpcTree& other);
 	GpcTree(GpcTree&& other) noexcept;
 	GpcTree& operator=(const GpcTree& other);
+	GpcTree& operator=(GpcTree&& other) noexcept;
 	~GpcTree();
 
 	Contour::Tree ToContourTree() const;
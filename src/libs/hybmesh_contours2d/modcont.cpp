@@ -210,15 +210,11 @@ EdgeData eal::NoCrosses(const EdgeData& ecol){
 	EdgeData ret;
 	DeepCopy(ecol, ret);
 	//Find crosses
-	BoundingBox area = BBox(ret, geps);
-	BoundingBoxFinder finder(area, area.maxlen()/20);
-	for (auto e: ret) finder.addentry(BoundingBox(*e->first(), *e->last()));
+	vector<BoundingBox> boxes;
+	for (auto e: ret) boxes.push_back(Finder::CrossBox(*e->first(), *e->last()));
 	_TEdgeCrossAnalyser ec(ret.size());
-	for (int i=0; i<ecol.size(); ++i){
-		auto s = finder.suspects(BoundingBox(*ret[i]->first(), *ret[i]->last()));
-		for (auto ei: s) if (ei!=i){
-			ec.add_crosses(ret[i].get(), ret[ei].get(), i, ei);
-		}
+	for (auto& ij: Finder::BoxPairs(boxes)){
+		ec.add_crosses(ret[ij.first].get(), ret[ij.second].get(), ij.first, ij.second);
 	}
 	//Part edges
 	ec.divide_edges(ret);
@@ -330,29 +326,13 @@ void eal::AssignBTypes(const EdgeData& from, EdgeData& to){
 		for (auto& e: to) e->boundary_type = bt[0];
 		return;
 	}
-	//using custom Finder::ClosestEdge implementation
-	//to use epsilon comparison instead of '<'. 
-	//This is done to guarantee that amoung all equal distanced 'from'
+	//Finder::ClosestEdgeFinder::find_first uses epsilon comparison
+	//instead of '<' to guarantee that among all equal distanced 'from'
 	//edges the first one will be taken.
+	Finder::ClosestEdgeFinder finder(from);
 	for (int ei=0; ei<to.size(); ++ei){
 		HM2D::Edge& e = *to[ei];
-		Point p = e.center();
-		double mindist = std::numeric_limits<double>::max();
-		int imin = -1;
-
-		for (int i=0; i<from.size(); ++i){
-			double meas = Point::meas_section(p, *from[i]->pfirst(), *from[i]->plast());
-			if (meas < geps * geps){
-				imin = i;
-				break;
-			}
-			meas = sqrt(meas);
-			if (meas < mindist - geps){
-				imin = i;
-				mindist = meas;
-			}
-		}
-		e.boundary_type = from[imin]->boundary_type;
+		e.boundary_type = from[finder.find_first(e.center())]->boundary_type;
 	}
 }
 
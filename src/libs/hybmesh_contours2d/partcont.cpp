@@ -2,9 +2,11 @@
 #include "piecewise.hpp"
 #include "partition01.hpp"
 #include "assemble2d.hpp"
-#include "treverter2d.hpp"
 #include "finder2d.hpp"
 #include "modcont.hpp"
+#include "hmparallel.hpp"
+#include "hmtimer.hpp"
+#include <unordered_map>
 
 using namespace HM2D;
 using namespace HM2D::Contour;
@@ -14,6 +16,43 @@ namespace{
 typedef std::list<shared_ptr<Vertex>> Vlist;
 typedef std::set<shared_ptr<Vertex>> Vset;
 
+//contour data computed once and used for partition of all its sections
+struct ContourInfo{
+	const EdgeData* cont;
+	bool closed;
+	//weights of ordered points
+	vector<double> ew;
+	//first position of vertex in ordered points
+	std::unordered_map<const Vertex*, int> index;
+
+	ContourInfo(const EdgeData& c): cont(&c), closed(IsClosed(c)), ew(EWeights(c)){
+		auto op = OrderedPoints(c);
+		for (int i=op.size()-1; i>=0; --i) index[op[i].get()] = i;
+	}
+	int pindex(const Vertex* p) const{
+		auto fnd = index.find(p);
+		assert(fnd != index.end());
+		return fnd->second;
+	}
+	//same as Assembler::ShrinkContour
+	EdgeData shrink(const Vertex* p0, const Vertex* p1) const{
+		int n = cont->size();
+		int i0 = pindex(p0), i1 = pindex(p1);
+		if (closed){
+			if (i0 == i1) i1 = i0 + n;
+			if (i1 == 0) i1 = n;
+			if (i1 < i0) i1 += n;
+		} else if (i1 < i0){
+			EdgeData r(cont->begin() + i1, cont->begin() + i0);
+			cns::Reverse(r);
+			return r;
+		}
+		EdgeData ret; ret.reserve(i1 - i0);
+		for (int i=i0; i<i1; ++i) ret.push_back((*cont)[i % n]);
+		return ret;
+	}
+};
+
 vector<double> partition_new_points_w(double step, const EdgeData& contour){
 	double len = Length(contour);
 	if (len<1.5*step){
@@ -60,46 +99,77 @@ vector<double> partition_new_points_w(std::map<double, double> basis, const Edge
 	else return ret;
 }
 
-double build_substep(double step, const EdgeData&, shared_ptr<Vertex>, shared_ptr<Vertex>){ return step; }
+double build_substep(double step, const ContourInfo&, shared_ptr<Vertex>, shared_ptr<Vertex>){ return step; }
+
+//Condition sources rasterized onto a regular grid.
+//Each grid cell keeps indices of conditions which influence zone touches the cell
+//so that a size value is computed only from conditions which could affect it.
+//Built once and shared between all copies of Conditions2D.
+struct ConditionsField{
+	ConditionsField(const vector<EdgeData>& cc, const vector<std::pair<Point, double>>& pc,
+			double influence): contcond(cc), pointcond(pc){
+		for (auto& c: contcond) finders.emplace_back(new HM2D::Finder::ClosestEdgeFinder(c));
+
+		vector<BoundingBox> bb;
+		for (auto& c: cc) if (c.size() > 0) bb.push_back(BBox(c, influence));
+		for (auto& p: pc) bb.push_back(BoundingBox(p.first, influence));
+		if (bb.size() == 0) return;
+		area = BoundingBox(bb);
+		//cells are not smaller than influence zone and their number is limited
+		double L = std::max(influence, area.maxlen()/500);
+		raster.reset(new BoundingBoxFinder(area, L));
+
+		for (int i=0; i<cc.size(); ++i){
+			vector<int> sqrs;
+			for (auto& e: cc[i]){
+				auto s = raster->sqrs_by_bbox(BoundingBox(*e->pfirst(), *e->plast(), influence));
+				sqrs.insert(sqrs.end(), s.begin(), s.end());
+			}
+			std::sort(sqrs.begin(), sqrs.end());
+			sqrs.erase(std::unique(sqrs.begin(), sqrs.end()), sqrs.end());
+			raster->raw_addentry(sqrs);
+		}
+		for (auto& p: pc) raster->addentry(BoundingBox(p.first, influence));
+	}
+	vector<EdgeData> contcond;
+	vector<std::pair<Point, double>> pointcond;
+	vector<shared_ptr<HM2D::Finder::ClosestEdgeFinder>> finders;
+	BoundingBox area;
+	shared_ptr<BoundingBoxFinder> raster;
+
+	//sorted indices of conditions which could influence the point
+	vector<int> candidates(const Point& p) const{
+		if (!raster || area.whereis(p) == OUTSIDE) return vector<int>();
+		return raster->suspects(p);
+	}
+};
 
 struct Conditions2D{
 	static const int LINEARIZE = 50;
-	vector<EdgeData> contcond;
-	vector<std::pair<Point, double>> pointcond;
+	Conditions2D(const vector<EdgeData>& cc, const vector<std::pair<Point, double>>& pc,
+			double step, double influence, double pw)
+		:field(new ConditionsField(cc, pc, influence)),
+		 default_step(step), influence_dist(influence), pw(pw){}
+	shared_ptr<const ConditionsField> field;
 	double default_step;
 	double influence_dist;
-	int Ncond() const {return contcond.size() + pointcond.size(); }
 	double pw;
 
-	std::vector<BoundingBox> boxes;
-	
-	bool is_out_of_box(int i, const Point& p){
-		if (boxes.size() == 0){
-			for (auto& cnt: contcond){
-				boxes.push_back(BBox(cnt, influence_dist));
-			}
-			for (auto& p: pointcond){
-				boxes.push_back(BoundingBox(p.first, influence_dist));
-			}
-		};
-		return boxes[i].whereis(p) == OUTSIDE;
-	}
-
 	//returns step size and weight
 	std::pair<double, double> cond_for_point(int i, const Point& p){
-		double dist = Point::dist(pointcond[i].first, p);
+		double dist = Point::dist(field->pointcond[i].first, p);
 		if (dist > influence_dist) return std::make_pair(1.0, 0.0);
-		double h = pointcond[i].second;
+		double h = field->pointcond[i].second;
 		double w = (influence_dist - dist)/influence_dist;
 		return std::make_pair(h, w);
 	}
 
 	//returns step size and weight
 	std::pair<double, double> cond_for_contour(int i, const Point& p){
-		auto cle = HM2D::Finder::ClosestEdge(contcond[i], p);
+		auto cle = field->finders[i]->find(p);
 		double dist = std::get<1>(cle);
 		if (dist > influence_dist) return std::make_pair(1.0, 0.0);
-		double h = contcond[i][std::get<0>(cle)]->length();
+		double h = field->contcond[i][std::get<0>(cle)]->length();
 		double w = (influence_dist - dist)/influence_dist;
 		return std::make_pair(h, w);
 	}
@@ -118,29 +188,15 @@ struct Conditions2D{
 		return ret/std::accumulate(w.begin(), w.end(), 0.0);
 	}
 
-	double stepfrom(int i, const Point& p){
-		if (is_out_of_box(i, p)) return default_step;
-
-		std::pair<double, double> step_delta;
-		if (i < contcond.size()){
-			step_delta = cond_for_contour(i, p);
-		} else {
-			step_delta = cond_for_point(i-contcond.size(), p);
-		}
-		return aver(step_delta.second, step_delta.first, default_step);
-	}
-
 	double Value(const Point& p){
-		//vector<double> hs;
-		//for (int i=0; i<Ncond(); ++i) hs.push_back(stepfrom(i, p));
-		//return *min_element(hs.begin(), hs.end());
 		std::vector<std::pair<double, double>> ws;  //weight-step
-		for (int i=0; i<Ncond(); ++i){
+		int ncont = field->contcond.size();
+		for (int i: field->candidates(p)){
 			std::pair<double, double> step_delta;
-			if (i < contcond.size()){
+			if (i < ncont){
 				step_delta = cond_for_contour(i, p);
 			} else {
-				step_delta = cond_for_point(i-contcond.size(), p);
+				step_delta = cond_for_point(i-ncont, p);
 			}
 			if (step_delta.second > geps){
 				ws.emplace_back(
@@ -175,7 +231,7 @@ struct Conditions2D{
 		return ret;
 	}
 };
-Conditions2D build_substep(Conditions2D step, const EdgeData&,
+Conditions2D build_substep(Conditions2D step, const ContourInfo&,
 		shared_ptr<Vertex>, shared_ptr<Vertex>){
 	return step;
 }
@@ -215,11 +271,11 @@ std::map<double, double> shrink01_basismap(std::map<double, double>& m,
 	return ret;
 }
 std::map<double, double> build_substep(std::map<double, double> step,
-		const EdgeData& cont, shared_ptr<Vertex> p0, shared_ptr<Vertex> p1){
-	int i0 = PInfo(cont, p0.get()).index, i1 = PInfo(cont, p1.get()).index;
-	if (IsOpen(cont)){
+		const ContourInfo& cont, shared_ptr<Vertex> p0, shared_ptr<Vertex> p1){
+	int i0 = cont.pindex(p0.get()), i1 = cont.pindex(p1.get());
+	if (!cont.closed){
 		assert(i1 > i0);
-		if (i0 == 0 && i1 == cont.size()){
+		if (i0 == 0 && i1 == cont.cont->size()){
 			insert_into_basismap(step, 0);
 			insert_into_basismap(step, 1);
 			return step;
@@ -227,9 +283,9 @@ std::map<double, double> build_substep(std::map<double, double> step,
 	} else {
 		if (i0 == 0 && i1 == 0) return step;
 	}
-	auto ew = EWeights(cont);
+	const vector<double>& ew = cont.ew;
 	double w0 = ew[i0], w1 = ew[i1];
-	if (IsClosed(cont)){
+	if (cont.closed){
 		//enlarge step by adding fictive entries to its end
 		for (auto it = step.begin(); it!=step.end(); ++it){
 			if (it->first >= 1) break;
@@ -272,13 +328,23 @@ EdgeData partition_core(A& step, const EdgeData& contour){
 }
 
 template<class A>
-EdgeData partition_section(A& step, const EdgeData& cont, shared_ptr<Vertex> pstart, shared_ptr<Vertex> pend){
-	EdgeData sub = Assembler::ShrinkContour(cont, pstart.get(), pend.get());
+EdgeData partition_section(A& step, const ContourInfo& cont, shared_ptr<Vertex> pstart, shared_ptr<Vertex> pend){
+	EdgeData sub = cont.shrink(pstart.get(), pend.get());
 	A substep = build_substep(step, cont, pstart, pend);
-	//temporary reverse contour with single edge if needed
-	std::unique_ptr<R::ReallyRevert> trev;
-	if (First(sub) != pstart) trev.reset(new R::ReallyRevert(sub));
-	assert(First(sub) == pstart);
+	//reversed copy of a contour with single edge if needed.
+	//Edges of sub are shared with other sections and contours which
+	//could be processed concurrently, so they are not reverted in place.
+	if (First(sub) != pstart){
+		VertexData av = OrderedPoints(sub);
+		EdgeData rsub(sub.size());
+		for (int i=0; i<sub.size(); ++i){
+			int k = sub.size() - 1 - i;
+			rsub[i] = std::make_shared<Edge>(av[k+1], av[k]);
+			rsub[i]->boundary_type = sub[k]->boundary_type;
+		}
+		assert(First(rsub) == pstart);
+		return partition_core(substep, rsub);
+	}
 	return partition_core(substep, sub);
 }
 
@@ -286,9 +352,10 @@ EdgeData partition_section(A& step, const EdgeData& cont, shared_ptr<Vertex> pst
 template<class A>
 EdgeData partition_core(A& step, const EdgeData& contour, const Vlist& keep){
 	auto it0 = keep.begin(), it1 = std::next(it0);
+	ContourInfo info(contour);
 	EdgeData ret;
 	while (it1 != keep.end()){
-		cns::Connect(ret, partition_section(step, contour, *it0, *it1));
+		cns::Connect(ret, partition_section(step, info, *it0, *it1));
 		//if sub.size() == 1 then its direction is not defined
 		//so we need to check the resulting direction.
 		//We did it after second union when direction matters
@@ -436,6 +503,7 @@ EdgeData cns::WeightedPartition(std::map<double, double> basis,
 		for (auto& v: nums_double) v*=(double(nedges)/sum_double);
 		vector<int> nums = HMMath::RoundVector(nums_double, vector<int>(nums_double.size(), 1));
 		//build subcontours
+		ContourInfo info(contour);
 		auto it0 = keep_sorted.begin(), it1 = std::next(it0);
 		auto itn = nums.begin();
 		EdgeData ret;
@@ -451,7 +519,7 @@ EdgeData cns::WeightedPartition(std::map<double, double> basis,
 				//try
 				auto b = basis;
 				for (auto& it: b) it.second*=coef;
-				psub = partition_section(b, contour, *it0, *it1);
+				psub = partition_section(b, info, *it0, *it1);
 				if (psub.size() == *itn) break;
 				//approximate
 				if (psub.size() < *itn){
@@ -484,12 +552,44 @@ EdgeData cns::ConditionalPartition(const EdgeData& input, double step, double in
 		const vector<EdgeData>& condconts,
 		const vector<std::pair<Point, double>>& condpoints,
 		double pw, const VertexData& keepit){
-	Conditions2D cond;
-	cond.contcond = condconts;
-	cond.pointcond = condpoints;
-	cond.default_step = step;
-	cond.influence_dist = influence;
-	cond.pw = pw;
+	Conditions2D cond(condconts, condpoints, step, influence, pw);
 	return partition_with_keepit(cond, input, keepit);
 }
 
+vector<EdgeData> cns::BulkPartition(const vector<PartitionTask>& tasks){
+	HMTimer::TicToc tm("BulkPartition");
+	vector<EdgeData> ret(tasks.size());
+	HMParallel::For(tasks.size(), [&](int i){
+		const PartitionTask& t = tasks[i];
+		ret[i] = WeightedPartition(t.basis, *t.contour, t.nedges, t.keepit);
+	});
+	if (HMTimer::IsRecording()){
+		HMTimer::AddRecord(HMTimer::Record("Partition", "BulkPartition")
+			.add("contours", tasks.size()).add("threads", HMParallel::NThreads())
+			.add("time", tm.elapsed()));
+	}
+	return ret;
+}
+
+vector<EdgeData> cns::BulkConditionalPartition(const vector<EdgeData>& input,
+		double step, double influence,
+		const vector<EdgeData>& condconts,
+		const vector<std::pair<Point, double>>& condpoints,
+		double pw,
+		const vector<VertexData>& keepit){
+	assert(keepit.size() == 0 || keepit.size() == input.size());
+	HMTimer::TicToc tm("BulkConditionalPartition");
+	Conditions2D cond(condconts, condpoints, step, influence, pw);
+	vector<EdgeData> ret(input.size());
+	HMParallel::For(input.size(), [&](int i){
+		Conditions2D c = cond;
+		ret[i] = partition_with_keepit(c, input[i],
+			keepit.size() > 0 ? keepit[i] : VertexData());
+	});
+	if (HMTimer::IsRecording()){
+		HMTimer::AddRecord(HMTimer::Record("Partition", "BulkConditionalPartition")
+			.add("contours", input.size()).add("threads", HMParallel::NThreads())
+			.add("time", tm.elapsed()));
+	}
+	return ret;
+}
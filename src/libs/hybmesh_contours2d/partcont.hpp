@@ -34,6 +34,28 @@ EdgeData ConditionalPartition(const EdgeData& input, double step, double influen
 		double pw,
 		const VertexData& keepit = {});
 
+//Partition of multiple contours processed in parallel.
+//Input contours are not modified so tasks may share contours or edges.
+//i-th result equals WeightedPartition of the i-th task.
+struct PartitionTask{
+	PartitionTask(const EdgeData& c, const std::map<double, double>& b,
+			int ned=-1, const VertexData& keep={}):
+		contour(&c), basis(b), nedges(ned), keepit(keep){}
+	const EdgeData* contour;
+	std::map<double, double> basis; //same as in WeightedPartition
+	int nedges;                     //forced number of edges if positive
+	VertexData keepit;
+};
+vector<EdgeData> BulkPartition(const vector<PartitionTask>& tasks);
+
+//ConditionalPartition of each input contour with common conditions.
+//keepit is either empty or has the size of input.
+vector<EdgeData> BulkConditionalPartition(const vector<EdgeData>& input, double step, double influence,
+		const vector<EdgeData>& condconts,
+		const vector<std::pair<Point, double>>& condpoints,
+		double pw,
+		const vector<VertexData>& keepit = {});
+
 }}}
 
 #endif
@@ -11,6 +11,7 @@
 #include "export2d_vtk.hpp"
 #include "finder2d.hpp"
 #include "clipper_core.hpp"
+#include "hmtimer.hpp"
 
 using HMTesting::add_check;
 
@@ -684,6 +685,221 @@ void test16(){
 	}
 }
 
+void test17(){
+	std::cout<<"17. Spatially indexed closest edge search"<<std::endl;
+	//random segments and points compared with linear search
+	EdgeData ed;
+	VertexData vd;
+	srand(1);
+	auto rnd = [](double a, double b){ return a + (b-a)*rand()/RAND_MAX; };
+	for (int i=0; i<500; ++i){
+		Point p0(rnd(0, 10), rnd(0, 5));
+		Point p1 = p0 + Point(rnd(-0.5, 0.5), rnd(-0.5, 0.5));
+		ed.emplace_back(new Edge(std::make_shared<Vertex>(p0), std::make_shared<Vertex>(p1)));
+		vd.push_back(ed.back()->first());
+	}
+	//contour with shared vertices
+	auto c1 = Contour::Constructor::Circle(64, 1, Point(5, 2.5));
+	ed.insert(ed.end(), c1.begin(), c1.end());
+
+	Finder::ClosestEdgeFinder efinder(ed);
+	Finder::ClosestPointFinder pfinder(vd);
+	bool good1 = true, good2 = true, good3 = true;
+	for (int i=0; i<2000; ++i){
+		Point p = (i % 10 == 0) ? Point(rnd(-100, 100), rnd(-100, 100))
+		                        : Point(rnd(-1, 11), rnd(-1, 6));
+		if (i % 10 == 1) p = *c1[i % c1.size()]->first();
+		if (efinder.find(p) != Finder::ClosestEdge(ed, p)) good1 = false;
+		if (pfinder.find(p) != Finder::ClosestPoint(vd, p)) good2 = false;
+		auto e = ed[efinder.find_first(p)];
+		if (!ISEQ(Point::dist(Finder::ClosestEPoint(ed, p), p),
+		          sqrt(Point::meas_section(p, *e->first(), *e->last())))) good3 = false;
+	}
+	add_check(good1, "closest edge");
+	add_check(good2, "closest point");
+	add_check(good3, "first closest edge");
+
+	EdgeData empty;
+	add_check(Finder::ClosestEdgeFinder(empty).find_first(Point(0, 0)) == -1, "empty data");
+}
+
+void test18(){
+	std::cout<<"18. Multiple contours clipping"<<std::endl;
+	//array of overlapping squares in random order
+	vector<EdgeData> sq;
+	for (int i=0; i<10; ++i)
+	for (int j=0; j<10; ++j){
+		double x = 0.75*((i*7) % 10), y = 0.75*((j*3) % 10);
+		sq.push_back(Contour::Constructor::FromPoints({x,y, x+1,y, x+1,y+1, x,y+1}, true));
+	}
+	auto u1 = Contour::Clip::Union(sq);
+	add_check(u1.nodes.size() == 1 && ISEQ(u1.area(), 7.75*7.75), "union of squares");
+
+	auto i1 = Contour::Clip::Intersection(
+		{sq[0], Contour::Constructor::Circle(64, 1, Point(0, 0)), sq[1]});
+	add_check(i1.nodes.size() == 0, "empty intersection");
+	i1 = Contour::Clip::Intersection({sq[0], sq[30], sq[7], sq[37]});
+	add_check(ISEQ(i1.area(), 0.25*0.25), "intersection of squares");
+
+	auto c1 = Contour::Constructor::FromPoints({-1,-1, 9,-1, 9,9, -1,9}, true);
+	auto d1 = Contour::Clip::Difference(c1, u1);
+	add_check(d1.nodes.size() == 2 && ISEQ(d1.area(), 100 - 7.75*7.75), "contour minus tree");
+	auto u2 = Contour::Clip::Union(d1, u1);
+	add_check(u2.nodes.size() == 1 && ISEQ(u2.area(), 100), "tree plus tree");
+	auto d2 = Contour::Clip::Difference(Contour::Tree({c1}), sq);
+	add_check(ISEQ(d2.area(), d1.area()), "tree minus contours");
+}
+
+void test19(){
+	std::cout<<"19. Crosses of contours with many edges"<<std::endl;
+	vector<double> pts1, pts2;
+	for (int i=0; i<=2000; ++i){
+		double x = 0.5 + (10*M_PI - 1)*i/2000.0;
+		pts1.push_back(x); pts1.push_back(sin(x));
+	}
+	for (int i=0; i<=1000; ++i){
+		pts2.push_back(10*M_PI*i/1000.0); pts2.push_back(0);
+	}
+	auto c1 = Contour::Constructor::FromPoints(pts1);
+	auto c2 = Contour::Constructor::FromPoints(pts2);
+	auto cr = Contour::Finder::CrossAll(c1, c2);
+	bool good = cr.size() == 9;
+	for (int i=0; i<cr.size() && good; ++i){
+		good = fabs(std::get<1>(cr[i]).x - (i+1)*M_PI) < 1e-4 && ISZERO(std::get<1>(cr[i]).y);
+	}
+	add_check(good, "all crosses");
+	auto cr1 = Contour::Finder::Cross(c2, c1);
+	add_check(std::get<0>(cr1) && ISEQ(std::get<2>(cr1), 0.1), "first cross");
+	auto cr2 = Contour::Finder::Cross(c1, Contour::Constructor::FromPoints({0, 2, 40, 2}));
+	add_check(!std::get<0>(cr2), "no crosses");
+
+	//figure eight
+	vector<double> pts3;
+	for (int i=0; i<1500; ++i){
+		double t = 2*M_PI*(i+0.5)/1500;
+		pts3.push_back(sin(2*t)); pts3.push_back(sin(t));
+	}
+	auto c3 = Contour::Constructor::FromPoints(pts3, true);
+	auto sc = Contour::Finder::SelfCross(c3);
+	add_check(std::get<0>(sc) && std::get<1>(sc) == Point(0, 0) &&
+	          std::get<4>(sc) == 749 && std::get<5>(sc) == 1499, "self cross");
+	pts3.resize(1000);
+	auto c4 = Contour::Constructor::FromPoints(pts3, true);
+	add_check(!std::get<0>(Contour::Finder::SelfCross(c4)), "no self cross");
+}
+
+void test20(){
+	std::cout<<"20. Bulk partition of multiple contours"<<std::endl;
+	//multi-body geometry: outer box with rows of profiles of different sizes
+	vector<EdgeData> bodies;
+	bodies.push_back(Contour::Constructor::FromPoints({-1,-1, 21,-1, 21,11, -1,11}, true));
+	for (int i=0; i<20; ++i)
+	for (int j=0; j<10; ++j){
+		double r = 0.15 + 0.2*((i+j) % 3)/2.0;
+		bodies.push_back(Contour::Constructor::Circle(32 + 8*(i % 4), r, Point(i+0.5, j+0.5)));
+	}
+	vector<Contour::Algos::PartitionTask> tasks;
+	for (int i=0; i<bodies.size(); ++i){
+		std::map<double, double> m {{0, 0.02}, {0.5, 0.05}};
+		tasks.emplace_back(bodies[i], m, -1, Contour::CornerPoints(bodies[i]));
+	}
+
+	HMTimer::ClearRecords();
+	HMTimer::SetRecording(true);
+	HMTimer::TicToc t1("serial partition");
+	vector<EdgeData> r1;
+	for (auto& t: tasks) r1.push_back(Contour::Algos::WeightedPartition(
+			t.basis, *t.contour, t.nedges, t.keepit));
+	t1.toc();
+	auto r2 = Contour::Algos::BulkPartition(tasks);
+	bool good = r1.size() == r2.size();
+	for (int i=0; i<r1.size() && good; ++i){
+		good = r1[i].size() == r2[i].size() && r1[i].size() > 10;
+		for (int j=0; j<r1[i].size() && good; ++j)
+			good = *r1[i][j]->first() == *r2[i][j]->first();
+	}
+	add_check(good, "weighted partition");
+
+	//tasks sharing a contour with single edge sections of opposite direction
+	EdgeData shared = Contour::Constructor::FromPoints({0,0, 1,0, 1,1, 0,1}, true);
+	shared[1]->reverse();
+	shared[3]->reverse();
+	vector<Point> before;
+	for (auto e: shared){ before.push_back(*e->first()); before.push_back(*e->last()); }
+	vector<Contour::Algos::PartitionTask> stasks;
+	for (int i=0; i<50; ++i){
+		std::map<double, double> m {{0, 0.01 + 0.001*(i%5)}, {0.5, 0.05}};
+		stasks.emplace_back(shared, m, -1, AllVertices(shared));
+	}
+	auto r5 = Contour::Algos::BulkPartition(stasks);
+	good = true;
+	for (int i=0; i<shared.size(); ++i){
+		good = good && *shared[i]->first() == before[2*i] && *shared[i]->last() == before[2*i+1];
+	}
+	for (int i=0; i<stasks.size() && good; ++i){
+		auto r = Contour::Algos::WeightedPartition(stasks[i].basis, shared, -1, stasks[i].keepit);
+		good = r.size() == r5[i].size() && r.size() > 40;
+		for (int j=0; j<r.size() && good; ++j) good = *r[j]->first() == *r5[i][j]->first();
+	}
+	add_check(good, "shared contour partition");
+
+	vector<EdgeData> conds {r2[1], r2[2]};
+	vector<std::pair<Point, double>> pconds {{Point(10, 5), 0.01}};
+	HMTimer::TicToc t3("serial conditional partition");
+	vector<EdgeData> r3;
+	for (int i=0; i<40; ++i) r3.push_back(Contour::Algos::ConditionalPartition(
+			bodies[i], 0.1, 1.5, conds, pconds, 1.0));
+	t3.toc();
+	auto r4 = Contour::Algos::BulkConditionalPartition(
+			vector<EdgeData>(bodies.begin(), bodies.begin()+40), 0.1, 1.5, conds, pconds, 1.0);
+	HMTimer::SetRecording(false);
+	good = r3.size() == r4.size();
+	for (int i=0; i<r3.size() && good; ++i){
+		good = r3[i].size() == r4[i].size();
+		for (int j=0; j<r3[i].size() && good; ++j)
+			good = *r3[i][j]->first() == *r4[i][j]->first();
+	}
+	add_check(good && r4[1].size() > r4[10].size(), "conditional partition");
+
+	//bulk procedures record their timings. Serial timings are added for comparison.
+	auto recs = HMTimer::Records();
+	HMTimer::ClearRecords();
+	vector<std::string> names {"BulkPartition", "BulkPartition", "BulkConditionalPartition"};
+	good = recs.size() == 3;
+	for (int i=0; i<recs.size() && good; ++i){
+		good = recs[i].category == "Partition" && recs[i].name == names[i] &&
+		       recs[i].fields[2].first == "time";
+	}
+	add_check(good, "bulk partition records");
+	if (good){
+		std::cout<<"\tserial/bulk partition time: "<<t1.elapsed()<<"/"<<recs[0].fields[2].second
+		         <<", conditional: "<<t3.elapsed()<<"/"<<recs[2].fields[2].second
+		         <<" with "<<recs[0].fields[1].second<<" threads"<<std::endl;
+	}
+}
+
+void test21(){
+	std::cout<<"21. Conditional partition with many conditions"<<std::endl;
+	//long line surrounded by a row of small circles and point conditions
+	auto line = Contour::Constructor::FromPoints({0, 0, 100, 0});
+	vector<EdgeData> conds;
+	vector<std::pair<Point, double>> pconds;
+	for (int i=0; i<1000; ++i){
+		conds.push_back(Contour::Constructor::Circle(16, 0.05, Point(0.1*i, 0.3)));
+		pconds.emplace_back(Point(50 + 0.05*i, -0.2), 0.02);
+	}
+	auto r = Contour::Algos::ConditionalPartition(line, 1.0, 0.5, conds, pconds, 1.0);
+	double maxnear = 0;
+	for (auto& e: r){
+		double x = e->center().x;
+		if (x > 1 && x < 99) maxnear = std::max(maxnear, e->length());
+	}
+	add_check(maxnear < 0.7 && r.size() > 150, "refinement near conditions");
+	auto r2 = Contour::Algos::ConditionalPartition(
+		Contour::Constructor::FromPoints({-200, 0, -100, 0}), 1.0, 0.5, conds, pconds, 1.0);
+	add_check(r2.size() == 100, "line out of conditions influence zone");
+}
+
 int main(){
 	std::cout<<"hybmesh_contours2d testing"<<std::endl;
 	test1();
@@ -702,7 +918,11 @@ int main(){
 	test14();
 	test15();
 	test16();
-
+	test17();
+	test18();
+	test19();
+	test20();
+	test21();
 
 	HMTesting::check_final_report();
 	std::cout<<"DONE"<<std::endl;
@@ -1,26 +1,32 @@
 #include "assemble3d.hpp"
 #include "contabs3d.hpp"
 #include "finder3d.hpp"
+#include "hmparallel.hpp"
 using namespace HM3D;
 
 namespace hs = HM3D::Surface::Assembler;
 namespace hc = HM3D::Contour::Assembler;
 
 FaceData hs::GridSurface(const GridData& g){
+	vector<char> isbnd(g.vfaces.size());
+	HMParallel::For(g.vfaces.size(), [&](int i){
+		isbnd[i] = g.vfaces[i]->is_boundary();
+	}, 10000);
 	FaceData ret;
-	for (auto f: g.vfaces){
-		if (f->is_boundary()) ret.push_back(f);
+	ret.reserve(std::count(isbnd.begin(), isbnd.end(), 1));
+	for (int i=0; i<g.vfaces.size(); ++i){
+		if (isbnd[i]) ret.push_back(g.vfaces[i]);
 	}
 	return ret;
 }
 
 std::map<int, FaceData> hs::GridSurfaceBType(const HM3D::GridData& g){
 	FaceData all = GridSurface(g);
+	std::map<int, int> cnt;
+	for (auto& f: all) ++cnt[f->boundary_type];
 	std::map<int, FaceData> ret;
-	for (auto f: all){
-		auto er = ret.emplace(f->boundary_type, FaceData());
-		er.first->second.push_back(f);
-	}
+	for (auto& it: cnt) ret[it.first].reserve(it.second);
+	for (auto& f: all) ret[f->boundary_type].push_back(f);
 	return ret;
 }
 
@@ -1,4 +1,6 @@
 #include "contabs3d.hpp"
+#include "hmparallel.hpp"
+#include <numeric>
 
 namespace ct = HM3D::Connectivity;
 using namespace ct;
@@ -17,34 +19,57 @@ vector<VertexEdgeR> ct::VertexEdge(const EdgeData& data){
 	return ret;
 }
 
+namespace{
+//face indices and local edge indices for each edge
+//in flat arrays sorted by edge id. Face order is preserved.
+//Edge ids should be set.
+void edge_face_flat(const HM3D::FaceData& data, int nedges,
+		vector<int>& start, vector<int>& fc, vector<int>& loc){
+	start.assign(nedges+1, 0);
+	for (auto& f: data)
+	for (auto& e: f->edges) ++start[e->id+1];
+	std::partial_sum(start.begin(), start.end(), start.begin());
+	fc.resize(start.back());
+	loc.resize(start.back());
+	vector<int> pos(start.begin(), start.end()-1);
+	for (int i=0; i<data.size(); ++i)
+	for (int j=0; j<data[i]->edges.size(); ++j){
+		int k = pos[data[i]->edges[j]->id]++;
+		fc[k] = i;
+		loc[k] = j;
+	}
+}
+}
+
 vector<EdgeFaceR> ct::EdgeFace(const FaceData& data){
 	auto ae = AllEdges(data);
+	aa::enumerate_ids_pvec(ae);
+	vector<int> start, fc, loc;
+	edge_face_flat(data, ae.size(), start, fc, loc);
 	vector<EdgeFaceR> ret(ae.size());
-	for (int i=0; i<ae.size(); ++i){
+	HMParallel::For(ret.size(), [&](int i){
 		ret[i].e = ae[i];
-		ret[i].e->id = i;
-	}
-	for (int i=0; i<data.size(); ++i)
-	for (auto& e: data[i]->edges){
-		ret[e->id].find.push_back(i);
-	}
+		ret[i].find.assign(fc.begin() + start[i], fc.begin() + start[i+1]);
+	}, 1000);
 	return ret;
 }
 
 vector<EdgeFaceExtendedR> ct::EdgeFaceExtended(const FaceData& data){
 	auto ae = AllEdges(data);
+	aa::enumerate_ids_pvec(ae);
+	vector<int> start, fc, loc;
+	edge_face_flat(data, ae.size(), start, fc, loc);
 	vector<EdgeFaceExtendedR> ret(ae.size());
-	for (int i=0; i<ae.size(); ++i){
-		ret[i].e = ae[i];
-		ret[i].e->id = i;
-	}
-	for (int i=0; i<data.size(); ++i)
-	for (int j=0; j<data[i]->edges.size(); ++j){
-		auto& r = ret[data[i]->edges[j]->id];
-		r.find.push_back(i);
-		r.locind.push_back(j);
-		r.posdir.push_back(data[i]->is_positive_edge(j));
-	}
+	HMParallel::For(ret.size(), [&](int i){
+		auto& r = ret[i];
+		r.e = ae[i];
+		r.find.assign(fc.begin() + start[i], fc.begin() + start[i+1]);
+		r.locind.assign(loc.begin() + start[i], loc.begin() + start[i+1]);
+		r.posdir.resize(r.find.size());
+		for (int k=0; k<r.find.size(); ++k){
+			r.posdir[k] = data[r.find[k]]->is_positive_edge(r.locind[k]);
+		}
+	}, 1000);
 	return ret;
 }
 
@@ -53,29 +78,50 @@ vector<vector<int>> ct::FaceFace(const ShpVector<Face>& data){
 }
 
 vector<vector<int>> ct::FaceFace(const vector<EdgeFaceR>& edge_face, int nfaces){
+	//face->edge_face entries in flat array
+	vector<int> start(nfaces+1, 0);
+	for (auto& it: edge_face)
+	for (auto f: it.find) ++start[f+1];
+	std::partial_sum(start.begin(), start.end(), start.begin());
+	vector<int> fe(start.back());
+	vector<int> pos(start.begin(), start.end()-1);
+	for (int i=0; i<edge_face.size(); ++i)
+	for (auto f: edge_face[i].find) fe[pos[f]++] = i;
+
+	//neighbours are listed in order of edge_face entries
 	vector<vector<int>> ret(nfaces);
-	for (auto& it: edge_face){
-		for (int i=0; i<it.size(); ++i){
-			int f1 = it.find[i];
-			for (int j=i+1; j<it.size(); ++j){
-				int f2 = it.find[j];
-				ret[f1].push_back(f2);
-				ret[f2].push_back(f1);
-			}
+	HMParallel::For(nfaces, [&](int f){
+		size_t sz = 0;
+		for (int k=start[f]; k<start[f+1]; ++k) sz += edge_face[fe[k]].size() - 1;
+		ret[f].reserve(sz);
+		for (int k=start[f]; k<start[f+1]; ++k)
+		for (int f2: edge_face[fe[k]].find) if (f2 != f){
+			ret[f].push_back(f2);
 		}
-	}
+	}, 1000);
 	return ret;
 }
 
 vector<vector<int>> ct::CellCell(const CellData& data){
 	vector<vector<int>> ret(data.size());
 	auto af = AllFaces(data);
+	aa::enumerate_ids_pvec(af);
 	aa::enumerate_ids_pvec(data);
-	for (auto f: af) if (!f->is_boundary()){
-		auto c1 = f->left.lock()->id;
-		auto c2 = f->right.lock()->id;
-		ret[c1].push_back(c2);
-		ret[c2].push_back(c1);
-	}
+	//neighbours are listed in order of faces in af
+	HMParallel::For(data.size(), [&](int i){
+		auto& c = data[i];
+		vector<std::pair<int, int>> nb;
+		nb.reserve(c->faces.size());
+		for (auto& f: c->faces) if (!f->is_boundary()){
+			auto c2 = (f->left.lock() == c) ? f->right.lock() : f->left.lock();
+			int i2 = c2->id;
+			if (i2 >= 0 && i2 < data.size() && data[i2] == c2){
+				nb.push_back(std::make_pair(f->id, i2));
+			}
+		}
+		std::sort(nb.begin(), nb.end());
+		ret[i].resize(nb.size());
+		for (int k=0; k<nb.size(); ++k) ret[i][k] = nb[k].second;
+	}, 1000);
 	return ret;
 }
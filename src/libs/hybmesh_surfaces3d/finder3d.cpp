@@ -1,5 +1,8 @@
 #include "finder3d.hpp"
+#include "hmparallel.hpp"
 
+using namespace HM3D;
+using namespace HM3D::Finder;
 
 std::tuple<int, double>
 HM3D::Finder::ClosestPoint(const HM3D::VertexData& vec, const Point3& v){
@@ -22,3 +25,267 @@ HM3D::Finder::ClosestPoint(const HM3D::VertexData& vec, const Point3& v){
 	return ret;
 }
 
+// ============================ SurfaceFinder
+namespace{
+
+BoundingBox3D tri_box(const Point3& p1, const Point3& p2, const Point3& p3){
+	BoundingBox3D ret(p1, p2);
+	ret.xmin = std::min(ret.xmin, p3.x); ret.xmax = std::max(ret.xmax, p3.x);
+	ret.ymin = std::min(ret.ymin, p3.y); ret.ymax = std::max(ret.ymax, p3.y);
+	ret.zmin = std::min(ret.zmin, p3.z); ret.zmax = std::max(ret.zmax, p3.z);
+	return ret;
+}
+
+void box_add(BoundingBox3D& b, const BoundingBox3D& a){
+	b.xmin = std::min(b.xmin, a.xmin); b.xmax = std::max(b.xmax, a.xmax);
+	b.ymin = std::min(b.ymin, a.ymin); b.ymax = std::max(b.ymax, a.ymax);
+	b.zmin = std::min(b.zmin, a.zmin); b.zmax = std::max(b.zmax, a.zmax);
+}
+
+//boxes have common points with geps tolerance
+bool box_cross(const BoundingBox3D& a, const BoundingBox3D& b){
+	return !(ISLOWER(a.xmax, b.xmin) || ISLOWER(b.xmax, a.xmin) ||
+	         ISLOWER(a.ymax, b.ymin) || ISLOWER(b.ymax, a.ymin) ||
+	         ISLOWER(a.zmax, b.zmin) || ISLOWER(b.zmax, a.zmin));
+}
+
+//squared distance from point to box, zero for inner points
+double box_meas(const BoundingBox3D& b, const Point3& p){
+	double dx = std::max(0.0, std::max(b.xmin - p.x, p.x - b.xmax));
+	double dy = std::max(0.0, std::max(b.ymin - p.y, p.y - b.ymax));
+	double dz = std::max(0.0, std::max(b.zmin - p.z, p.z - b.zmax));
+	return dx*dx + dy*dy + dz*dz;
+}
+
+//does [p, p + dir] segment cross geps-widened box
+bool segment_box(const BoundingBox3D& b, const Point3& p, const Vect3& dir){
+	double t0 = 0, t1 = 1;
+	auto slab = [&t0, &t1](double x, double d, double mn, double mx)->bool{
+		mn -= geps; mx += geps;
+		if (d == 0) return x >= mn && x <= mx;
+		double ta = (mn - x)/d, tb = (mx - x)/d;
+		if (ta > tb) std::swap(ta, tb);
+		t0 = std::max(t0, ta);
+		t1 = std::min(t1, tb);
+		return t0 <= t1;
+	};
+	return slab(p.x, dir.x, b.xmin, b.xmax) &&
+	       slab(p.y, dir.y, b.ymin, b.ymax) &&
+	       slab(p.z, dir.z, b.zmin, b.zmax);
+}
+
+//closest point of triangle (a, b, c) to p
+Point3 closest_on_triangle(const Point3& p, const Point3& a, const Point3& b, const Point3& c){
+	Vect3 ab = b - a, ac = c - a;
+	Vect3 ap = p - a;
+	double d1 = vecDot(ab, ap), d2 = vecDot(ac, ap);
+	if (d1 <= 0 && d2 <= 0) return a;
+
+	Vect3 bp = p - b;
+	double d3 = vecDot(ab, bp), d4 = vecDot(ac, bp);
+	if (d3 >= 0 && d4 <= d3) return b;
+
+	double vc = d1*d4 - d3*d2;
+	if (vc <= 0 && d1 >= 0 && d3 <= 0) return a + ab*(d1/(d1 - d3));
+
+	Vect3 cp = p - c;
+	double d5 = vecDot(ab, cp), d6 = vecDot(ac, cp);
+	if (d6 >= 0 && d5 <= d6) return c;
+
+	double vb = d5*d2 - d1*d6;
+	if (vb <= 0 && d2 >= 0 && d6 <= 0) return a + ac*(d2/(d2 - d6));
+
+	double va = d3*d6 - d5*d4;
+	if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+		return b + (c - b)*((d4 - d3)/((d4 - d3) + (d5 - d6)));
+
+	double den = va + vb + vc;
+	if (den <= 0) return a;
+	return a + ab*(vb/den) + ac*(vc/den);
+}
+
+}
+
+SurfaceFinder::SurfaceFinder(const FaceData& data){
+	//fan triangulation of each face
+	vector<int> start(data.size() + 1, 0);
+	for (int i=0; i<data.size(); ++i){
+		start[i+1] = start[i] + std::max(0, (int)data[i]->edges.size() - 2);
+	}
+	tris.resize(start.back());
+	HMParallel::For(data.size(), [&](int i){
+		if (start[i+1] == start[i]) return;
+		auto sv = data[i]->sorted_vertices();
+		for (int k=1; k<sv.size()-1; ++k){
+			Tri& t = tris[start[i] + k - 1];
+			t.p1 = *sv[0];
+			t.p2 = *sv[k];
+			t.p3 = *sv[k+1];
+			t.face = i;
+		}
+	}, 1000);
+
+	if (tris.size() > 0){
+		nodes.reserve(tris.size()/2 + 1);
+		build(0, tris.size());
+		bbox = nodes[0].box;
+	}
+}
+
+int SurfaceFinder::build(int start, int end){
+	int ret = nodes.size();
+	nodes.push_back(Node());
+
+	//triangles bounding box and centers bounding box
+	BoundingBox3D box = tri_box(tris[start].p1, tris[start].p2, tris[start].p3);
+	Point3 c0 = tris[start].p1 + tris[start].p2 + tris[start].p3;
+	BoundingBox3D cbox(c0, c0);
+	for (int i=start+1; i<end; ++i){
+		const Tri& t = tris[i];
+		box_add(box, tri_box(t.p1, t.p2, t.p3));
+		Point3 c = t.p1 + t.p2 + t.p3;
+		box_add(cbox, BoundingBox3D(c, c));
+	}
+	nodes[ret].box = box;
+	nodes[ret].start = start;
+	nodes[ret].end = end;
+	nodes[ret].left = nodes[ret].right = -1;
+	if (end - start <= 4) return ret;
+
+	//split by median center along the longest direction
+	int mid = (start + end)/2;
+	double Point3::*ax = &Point3::x;
+	if (cbox.ylen() > cbox.xlen() && cbox.ylen() >= cbox.zlen()) ax = &Point3::y;
+	else if (cbox.zlen() > cbox.xlen() && cbox.zlen() > cbox.ylen()) ax = &Point3::z;
+	std::nth_element(tris.begin() + start, tris.begin() + mid, tris.begin() + end,
+		[ax](const Tri& a, const Tri& b){
+			return a.p1.*ax + a.p2.*ax + a.p3.*ax < b.p1.*ax + b.p2.*ax + b.p3.*ax;
+		});
+
+	int left = build(start, mid);
+	int right = build(mid, end);
+	nodes[ret].left = left;
+	nodes[ret].right = right;
+	return ret;
+}
+
+std::tuple<int, double, Point3> SurfaceFinder::find(const Point3& p) const{
+	std::tuple<int, double, Point3> ret(-1, -1, p);
+	if (nodes.size() == 0) return ret;
+
+	double best = std::numeric_limits<double>::max();
+	vector<int> stack(1, 0);
+	while (stack.size() > 0){
+		const Node& nd = nodes[stack.back()];
+		stack.pop_back();
+		if (box_meas(nd.box, p) >= best) continue;
+		if (nd.left < 0){
+			for (int i=nd.start; i<nd.end; ++i){
+				const Tri& t = tris[i];
+				Point3 cp = closest_on_triangle(p, t.p1, t.p2, t.p3);
+				double m = Point3::meas(p, cp);
+				if (m < best){
+					best = m;
+					ret = std::make_tuple(t.face, m, cp);
+				}
+			}
+		} else {
+			//closer node goes last to be processed first
+			double ml = box_meas(nodes[nd.left].box, p);
+			double mr = box_meas(nodes[nd.right].box, p);
+			if (ml < mr){
+				stack.push_back(nd.right);
+				stack.push_back(nd.left);
+			} else {
+				stack.push_back(nd.left);
+				stack.push_back(nd.right);
+			}
+		}
+	}
+	return ret;
+}
+
+int SurfaceFinder::ray_crosses(const Point3& p, const Vect3& dir, bool& degenerate) const{
+	const double eps = 1e-10;
+	int ret = 0;
+	degenerate = false;
+	vector<int> stack(1, 0);
+	while (stack.size() > 0 && !degenerate){
+		const Node& nd = nodes[stack.back()];
+		stack.pop_back();
+		if (!segment_box(nd.box, p, dir)) continue;
+		if (nd.left >= 0){
+			stack.push_back(nd.left);
+			stack.push_back(nd.right);
+			continue;
+		}
+		for (int i=nd.start; i<nd.end; ++i){
+			const Tri& t = tris[i];
+			Vect3 e1 = t.p2 - t.p1, e2 = t.p3 - t.p1;
+			Vect3 h = vecCross(dir, e2);
+			double det = vecDot(e1, h);
+			//segment is parallel to triangle plane.
+			//If it lies within the plane it touches edges of neighbouring triangles.
+			if (fabs(det) <= eps*vecLen(e1)*vecLen(e2)*vecLen(dir)) continue;
+			Vect3 s = p - t.p1;
+			double u = vecDot(s, h)/det;
+			if (u < -eps || u > 1 + eps) continue;
+			Vect3 q = vecCross(s, e1);
+			double v = vecDot(dir, q)/det;
+			if (v < -eps || u + v > 1 + eps) continue;
+			double w = vecDot(e2, q)/det;
+			if (w < 0 || w > 1) continue;
+			if (u < eps || v < eps || u + v > 1 - eps){
+				degenerate = true;
+				break;
+			}
+			++ret;
+		}
+	}
+	return ret;
+}
+
+int SurfaceFinder::whereis(const Point3& p) const{
+	if (nodes.size() == 0) return OUTSIDE;
+	if (bbox.position(p) == OUTSIDE) return OUTSIDE;
+	if (std::get<1>(find(p)) < geps*geps) return BOUND;
+
+	//rays should leave bounding box
+	double len = 2*(bbox.xlen() + bbox.ylen() + bbox.zlen()) + 1;
+	//directions are chosen not to be parallel to coordinate planes.
+	//If ray passes through triangle edges or vertices the next one is tried.
+	static const double dirs[][3] = {
+		{0.5384, 0.6142, 0.5770}, {-0.6718, 0.3411, 0.6575},
+		{0.2919, -0.8403, 0.4567}, {-0.4046, -0.5262, -0.7479},
+		{0.7941, -0.2180, -0.5673}, {-0.1357, 0.9128, -0.3852}};
+	int cr = 0;
+	for (auto& d: dirs){
+		bool degenerate;
+		cr = ray_crosses(p, Vect3(d[0], d[1], d[2])*len, degenerate);
+		if (!degenerate) break;
+	}
+	return (cr % 2 == 1) ? INSIDE : OUTSIDE;
+}
+
+vector<int> SurfaceFinder::faces_in_box(const BoundingBox3D& bb) const{
+	vector<int> ret;
+	if (nodes.size() == 0) return ret;
+	vector<int> stack(1, 0);
+	while (stack.size() > 0){
+		const Node& nd = nodes[stack.back()];
+		stack.pop_back();
+		if (!box_cross(nd.box, bb)) continue;
+		if (nd.left >= 0){
+			stack.push_back(nd.left);
+			stack.push_back(nd.right);
+			continue;
+		}
+		for (int i=nd.start; i<nd.end; ++i){
+			const Tri& t = tris[i];
+			if (box_cross(tri_box(t.p1, t.p2, t.p3), bb)) ret.push_back(t.face);
+		}
+	}
+	std::sort(ret.begin(), ret.end());
+	ret.resize(std::unique(ret.begin(), ret.end()) - ret.begin());
+	return ret;
+}
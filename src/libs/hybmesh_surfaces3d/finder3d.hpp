@@ -1,5 +1,5 @@
-#ifndef HYBMESH_FINDER2D_HPP
-#define HYBMESH_FINDER2D_HPP
+#ifndef HYBMESH_FINDER3D_HPP
+#define HYBMESH_FINDER3D_HPP
 #include "primitives3d.hpp"
 
 namespace HM3D{ namespace Finder{
@@ -9,6 +9,45 @@ std::tuple<
 	double       //measure to closest vertex
 > ClosestPoint(const VertexData& vec, const Point3& v);
 
+//Bounding volume hierarchy over surface faces for multiple
+//closest point, point location and box queries.
+//Faces are split into triangles by fans from their first vertex.
+//Input data order and coordinates should not be changed while using the finder.
+//All find methods are thread safe.
+class SurfaceFinder{
+	struct Tri{
+		Point3 p1, p2, p3;
+		int face;
+	};
+	//leaf nodes have left < 0 and contain tris[start:end]
+	struct Node{
+		BoundingBox3D box;
+		int left, right;
+		int start, end;
+	};
+	vector<Tri> tris;
+	vector<Node> nodes;
+	BoundingBox3D bbox;
+
+	int build(int start, int end);
+	//number of crosses of [p, p + dir] segment with surface triangles.
+	//degenerate is set to true if segment touches triangle edges or vertices.
+	int ray_crosses(const Point3& p, const Vect3& dir, bool& degenerate) const;
+public:
+	SurfaceFinder(const FaceData& data);
+
+	//<0> closest face index, -1 if data is empty
+	//<1> squared distance to closest face
+	//<2> closest point lying on the face
+	std::tuple<int, double, Point3> find(const Point3& p) const;
+	//->(INSIDE, BOUND, OUTSIDE) by ray casting. Surface direction is ignored.
+	//!!! surface should be closed
+	int whereis(const Point3& p) const;
+	//sorted indices of faces which triangle bounding boxes have common points with bb
+	vector<int> faces_in_box(const BoundingBox3D& bb) const;
+
+	const BoundingBox3D& bounding_box() const { return bbox; }
+};
 
 }}
 #endif
@@ -1,11 +1,55 @@
 #include "serialize3d.hpp"
 #include "surface.hpp"
 #include "assemble3d.hpp"
+#include "hmparallel.hpp"
+#include <atomic>
+#include <mutex>
 
 using namespace HM3D;
 using namespace HM3D::Ser;
 
 namespace{
+size_t table_memory(const vector<double>& v){ return v.capacity()*sizeof(double); }
+size_t table_memory(const vector<int>& v){ return v.capacity()*sizeof(int); }
+size_t table_memory(const vector<vector<int>>& v){
+	size_t ret = v.capacity()*sizeof(vector<int>);
+	for (auto& it: v) ret += table_memory(it);
+	return ret;
+}
+
+//Lazily built table.
+//get() could be called concurrently. Table builders should not query
+//other unbuilt tables from inside parallel loops.
+template<class T>
+class LazyTable{
+	T data;
+	std::atomic<bool> ready;
+public:
+	LazyTable(): ready(false){}
+
+	template<class Builder>
+	T& get(std::recursive_mutex& mut, Builder&& build){
+		if (!ready.load(std::memory_order_acquire)){
+			std::lock_guard<std::recursive_mutex> lk(mut);
+			if (!ready.load(std::memory_order_relaxed)){
+				T().swap(data);
+				build(data);
+				ready.store(true, std::memory_order_release);
+			}
+		}
+		return data;
+	}
+	void set(const T& d){
+		data = d;
+		ready.store(true, std::memory_order_release);
+	}
+	void reset(){
+		ready.store(false, std::memory_order_release);
+		T().swap(data);
+	}
+	size_t memory() const { return table_memory(data); }
+};
+
 template<class SerClass>
 vector<int> fvtab(const SerClass& s, int nface){
 	vector<int> ret;
@@ -36,75 +80,80 @@ vector<int> fvtab(const SerClass& s, int nface){
 struct Ser::Surface::Cache{
 	const Ser::Surface* parent;
 	Cache(const Ser::Surface& par): parent(&par){}
+	//guards tables building. Recursive since tables depend on each other.
+	std::recursive_mutex mut;
 
 	//=============== data
 	//main tables
-	vector<double> _vert;
-	vector<int> _btypes;
-	vector<int> _edge_vert;
-	vector<vector<int>> _face_edge;
-	vector<vector<int>> _face_vertex;
+	LazyTable<vector<double>> _vert;
+	LazyTable<vector<int>> _btypes;
+	LazyTable<vector<int>> _edge_vert;
+	LazyTable<vector<vector<int>>> _face_edge;
+	LazyTable<vector<vector<int>>> _face_vertex;
 
 	// ============== callers
 	vector<double>& vert(){
-		if (_vert.size() == 0){
+		return _vert.get(mut, [&](vector<double>& r){
 			auto av = AllVertices(parent->surface);
-			_vert.reserve(av.size()*3);
-			for (auto& v: av){
-				_vert.push_back(v->x);
-				_vert.push_back(v->y);
-				_vert.push_back(v->z);
-			}
-		}
-		return _vert;
+			r.resize(av.size()*3);
+			HMParallel::For(av.size(), [&](int i){
+				r[3*i] = av[i]->x;
+				r[3*i+1] = av[i]->y;
+				r[3*i+2] = av[i]->z;
+			}, 10000);
+		});
 	}
 	vector<int>& edge_vert(){
-		if (_edge_vert.size() == 0){
+		return _edge_vert.get(mut, [&](vector<int>& r){
 			auto ave = AllPrimitives(parent->surface);
 			auto& av = std::get<0>(ave);
 			auto& ae = std::get<1>(ave);
 			aa::enumerate_ids_pvec(av);
-			_edge_vert.reserve(2*ae.size());
+			r.reserve(2*ae.size());
 			for (auto e: ae){
-				_edge_vert.push_back(e->first()->id);
-				_edge_vert.push_back(e->last()->id);
+				r.push_back(e->first()->id);
+				r.push_back(e->last()->id);
 			}
-		}
-		return _edge_vert;
+		});
 	}
 	vector<int>& btypes(){
-		if (_btypes.size() == 0){
+		return _btypes.get(mut, [&](vector<int>& r){
 			for (auto f: parent->surface){
-				_btypes.push_back(f->boundary_type);
+				r.push_back(f->boundary_type);
 			}
-		}
-		return _btypes;
+		});
 	}
 	vector<vector<int>>& face_edge(){
-		if (_face_edge.size() == 0){
+		return _face_edge.get(mut, [&](vector<vector<int>>& r){
 			auto ae = AllEdges(parent->surface);
 			aa::enumerate_ids_pvec(ae);
-			_face_edge.resize(parent->n_faces());
-			for (int i=0; i<_face_edge.size(); ++i){
-				for (auto e: parent->surface[i]->edges){
-					_face_edge[i].push_back(e->id);
-				}
-			}
-		}
-		return _face_edge;
+			r.resize(parent->n_faces());
+			HMParallel::For(r.size(), [&](int i){
+				auto& fe = parent->surface[i]->edges;
+				r[i].resize(fe.size());
+				for (int j=0; j<fe.size(); ++j) r[i][j] = fe[j]->id;
+			}, 10000);
+		});
 	}
 	vector<vector<int>>& face_vertex(){
-		if (_face_vertex.size() == 0){
-			_face_vertex.resize(parent->n_faces());
-			for (size_t i=0; i<parent->n_faces(); ++i){
-				_face_vertex[i] = fvtab(*parent, i);
-			}
-		}
-		return _face_vertex;
+		return _face_vertex.get(mut, [&](vector<vector<int>>& r){
+			//tables used by fvtab are built before the parallel loop
+			face_edge();
+			edge_vert();
+			r.resize(parent->n_faces());
+			HMParallel::For(parent->n_faces(), [&](int i){
+				r[i] = fvtab(*parent, i);
+			}, 10000);
+		});
 	}
 
 	int n_edges() { return edge_vert().size()/2; }
 	int n_vert() { return vert().size()/3; }
+
+	size_t memory() const{
+		return _vert.memory() + _btypes.memory() + _edge_vert.memory() +
+		       _face_edge.memory() + _face_vertex.memory();
+	}
 };
 
 
@@ -122,6 +171,8 @@ Ser::Surface::Surface(const HM3D::FaceData& srf){
 void Ser::Surface::empty_cache() const {
 	cache.reset(new Cache(*this));
 }
+void Ser::Surface::reset_vert() const { cache->_vert.reset(); }
+size_t Ser::Surface::cache_memory() const { return cache->memory(); }
 Ser::Surface::~Surface(){}
 
 int Ser::Surface::n_edges() const { return cache->n_edges(); }
@@ -142,10 +193,10 @@ void Ser::Surface::fill_from_serial(const vector<double>& vert,
 		const vector<int>& btypes){
 	//fill cache
 	empty_cache();
-	cache->_vert = vert;
-	cache->_edge_vert = edgevert;
-	cache->_face_edge = faceedge;
-	cache->_btypes = btypes;
+	cache->_vert.set(vert);
+	cache->_edge_vert.set(edgevert);
+	cache->_face_edge.set(faceedge);
+	cache->_btypes.set(btypes);
 	//fill grid
 	VertexData vvert;
 	EdgeData vedges;
@@ -176,125 +227,164 @@ void Ser::Surface::fill_from_serial(const vector<double>& vert,
 struct Ser::Grid::Cache{
 	const Ser::Grid* parent;
 	Cache(const Ser::Grid& par): parent(&par){}
+	//guards tables building. Recursive since tables depend on each other.
+	std::recursive_mutex mut;
 
 	// ================ data
 	//main tables
-	vector<double> _vert;
-	vector<int> _edge_vert;
-	vector<vector<int>> _face_edge;
-	vector<int> _face_cell;
-	vector<int> _btypes;
+	LazyTable<vector<double>> _vert;
+	LazyTable<vector<int>> _edge_vert;
+	LazyTable<vector<vector<int>>> _face_edge;
+	LazyTable<vector<int>> _face_cell;
+	LazyTable<vector<int>> _btypes;
 	//aux tables
-	vector<int> _bfaces;
-	vector<int> _bedges;
-	vector<int> _bvert;
-	vector<vector<int>> _face_vertex;
+	LazyTable<vector<int>> _bfaces;
+	LazyTable<vector<int>> _bedges;
+	LazyTable<vector<int>> _bvert;
+	LazyTable<vector<vector<int>>> _face_vertex;
+	LazyTable<vector<vector<int>>> _cell_face;
+	LazyTable<vector<vector<int>>> _cell_vertex;
 
 	// ================ callers
 	//main tables
 	vector<double>& vert(){
-		if (_vert.size() == 0){
-			_vert.reserve(3*parent->n_vert());
-			for (auto& v: parent->grid.vvert){
-				_vert.push_back(v->x);
-				_vert.push_back(v->y);
-				_vert.push_back(v->z);
-			}
-		}
-		return _vert;
+		return _vert.get(mut, [&](vector<double>& r){
+			auto& vv = parent->grid.vvert;
+			r.resize(3*parent->n_vert());
+			HMParallel::For(vv.size(), [&](int i){
+				r[3*i] = vv[i]->x;
+				r[3*i+1] = vv[i]->y;
+				r[3*i+2] = vv[i]->z;
+			}, 10000);
+		});
 	}
 	vector<int>& edge_vert(){
-		if (_edge_vert.size() == 0){
-			_edge_vert.reserve(parent->n_edges()*2);
+		return _edge_vert.get(mut, [&](vector<int>& r){
+			auto& ve = parent->grid.vedges;
 			aa::enumerate_ids_pvec(parent->grid.vvert);
-			for (auto e: parent->grid.vedges){
-				_edge_vert.push_back(e->first()->id);
-				_edge_vert.push_back(e->last()->id);
-			}
-		}
-		return _edge_vert;
+			r.resize(parent->n_edges()*2);
+			HMParallel::For(ve.size(), [&](int i){
+				r[2*i] = ve[i]->first()->id;
+				r[2*i+1] = ve[i]->last()->id;
+			}, 10000);
+		});
 	}
 	vector<vector<int>>& face_edge(){
-		if (_face_edge.size() == 0){
+		return _face_edge.get(mut, [&](vector<vector<int>>& r){
 			aa::enumerate_ids_pvec(parent->grid.vedges);
-			_face_edge.resize(parent->n_faces());
-			for (int i=0; i<_face_edge.size(); ++i){
-				for (auto e: parent->grid.vfaces[i]->edges){
-					_face_edge[i].push_back(e->id);
-				}
-			}
-		}
-		return _face_edge;
+			r.resize(parent->n_faces());
+			HMParallel::For(r.size(), [&](int i){
+				auto& fe = parent->grid.vfaces[i]->edges;
+				r[i].resize(fe.size());
+				for (int j=0; j<fe.size(); ++j) r[i][j] = fe[j]->id;
+			}, 10000);
+		});
 	}
 	vector<int>& face_cell(){
-		if (_face_cell.size() == 0){
-			_face_cell.resize(parent->n_faces()*2, -1);
+		return _face_cell.get(mut, [&](vector<int>& r){
+			r.resize(parent->n_faces()*2, -1);
 			aa::enumerate_ids_pvec(parent->grid.vcells);
-			for (int i=0; i<parent->n_faces(); ++i){
-				auto f=parent->grid.vfaces[i];
+			HMParallel::For(parent->n_faces(), [&](int i){
+				auto& f = parent->grid.vfaces[i];
 				if (f->has_left_cell())
-					_face_cell[2*i] = f->left.lock()->id;
+					r[2*i] = f->left.lock()->id;
 				if (f->has_right_cell())
-					_face_cell[2*i+1] = f->right.lock()->id;
-			}
-		}
-		return _face_cell;
+					r[2*i+1] = f->right.lock()->id;
+			}, 10000);
+		});
 	}
 	vector<int>& btypes(){
-		if (_btypes.size()==0){
-			_btypes.resize(parent->n_faces());
-			for (int i=0; i<parent->n_faces(); ++i){
-				_btypes[i] = parent->grid.vfaces[i]->boundary_type;
-			}
-		}
-		return _btypes;
+		return _btypes.get(mut, [&](vector<int>& r){
+			r.resize(parent->n_faces());
+			HMParallel::For(parent->n_faces(), [&](int i){
+				r[i] = parent->grid.vfaces[i]->boundary_type;
+			}, 10000);
+		});
 	}
 	//aux tables
 	vector<vector<int>>& face_vertex(){
-		if (_face_vertex.size() == 0){
-			_face_vertex.resize(parent->n_faces());
-			for (size_t i=0; i<parent->n_faces(); ++i){
-				_face_vertex[i] = fvtab(*parent, i);
-			}
-		}
-		return _face_vertex;
+		return _face_vertex.get(mut, [&](vector<vector<int>>& r){
+			//tables used by fvtab are built before the parallel loop
+			face_edge();
+			edge_vert();
+			r.resize(parent->n_faces());
+			HMParallel::For(parent->n_faces(), [&](int i){
+				r[i] = fvtab(*parent, i);
+			}, 10000);
+		});
+	}
+
+	vector<vector<int>>& cell_face(){
+		return _cell_face.get(mut, [&](vector<vector<int>>& r){
+			aa::enumerate_ids_pvec(parent->grid.vfaces);
+			r.resize(parent->n_cells());
+			HMParallel::For(parent->n_cells(), [&](int i){
+				auto& cf = parent->grid.vcells[i]->faces;
+				r[i].resize(cf.size());
+				for (int j=0; j<cf.size(); ++j) r[i][j] = cf[j]->id;
+			}, 10000);
+		});
+	}
+
+	//vertices in order of their first appearance in cell faces
+	vector<vector<int>>& cell_vertex(){
+		return _cell_vertex.get(mut, [&](vector<vector<int>>& r){
+			auto& cf = cell_face();
+			auto& fv = face_vertex();
+			r.resize(parent->n_cells());
+			HMParallel::For(parent->n_cells(), [&](int i){
+				auto& cv = r[i];
+				for (int f: cf[i])
+				for (int v: fv[f]){
+					if (std::find(cv.begin(), cv.end(), v) == cv.end()) cv.push_back(v);
+				}
+			}, 10000);
+		});
 	}
 
 	vector<int>& bfaces(){
-		if (_bfaces.size() == 0){
-			for (int i=0; i<parent->n_faces(); ++i){
-				if (parent->grid.vfaces[i]->is_boundary())
-					_bfaces.push_back(i);
+		return _bfaces.get(mut, [&](vector<int>& r){
+			vector<char> isbnd(parent->n_faces());
+			HMParallel::For(parent->n_faces(), [&](int i){
+				isbnd[i] = parent->grid.vfaces[i]->is_boundary();
+			}, 10000);
+			r.reserve(std::count(isbnd.begin(), isbnd.end(), 1));
+			for (int i=0; i<isbnd.size(); ++i) if (isbnd[i]){
+				r.push_back(i);
 			}
-		}
-		return _bfaces;
+		});
 	}
 
 	vector<int>& bedges(){
-		if (_bedges.size() == 0){
-			vector<bool> used(parent->n_edges(), false);
+		return _bedges.get(mut, [&](vector<int>& r){
+			vector<char> used(parent->n_edges(), false);
 			auto& fe = face_edge();
 			for (auto bf: bfaces())
 			for (auto e: fe[bf])
 				used[e]=true;
 			for (size_t i=0; i<used.size(); ++i)
-			if (used[i]) _bedges.push_back(i);
-		}
-		return _bedges;
+			if (used[i]) r.push_back(i);
+		});
 	}
 
 	vector<int>& bvert(){
-		if (_bvert.size() == 0){
-			vector<bool> used(parent->n_vert(), false);
+		return _bvert.get(mut, [&](vector<int>& r){
+			vector<char> used(parent->n_vert(), false);
 			auto& ed = edge_vert();
 			for (auto be: bedges()){
 				used[ed[2*be]]=true;
 				used[ed[2*be+1]]=true;
 			}
 			for (size_t i=0; i<used.size(); ++i)
-			if (used[i]) _bvert.push_back(i);
-		}
-		return _bvert;
+			if (used[i]) r.push_back(i);
+		});
+	}
+
+	size_t memory() const{
+		return _vert.memory() + _edge_vert.memory() + _face_edge.memory() +
+		       _face_cell.memory() + _btypes.memory() + _bfaces.memory() +
+		       _bedges.memory() + _bvert.memory() + _face_vertex.memory() +
+		       _cell_face.memory() + _cell_vertex.memory();
 	}
 };
 
@@ -313,6 +403,9 @@ Ser::Grid::~Grid(){}
 void Ser::Grid::empty_cache() const {
 	cache.reset(new Cache(*this));
 }
+void Ser::Grid::reset_vert() const { cache->_vert.reset(); }
+void Ser::Grid::reset_btypes() const { cache->_btypes.reset(); }
+size_t Ser::Grid::cache_memory() const { return cache->memory(); }
 
 const vector<double>& Ser::Grid::vert() const { return cache->vert(); }
 const vector<int>& Ser::Grid::edge_vert() const { return cache->edge_vert(); }
@@ -324,11 +417,13 @@ const vector<int>& Ser::Grid::bvert() const { return cache->bvert(); }
 const vector<int>& Ser::Grid::btypes() const { return cache->btypes(); }
 const vector<vector<int>>& Ser::Grid::face_vertex() const { return cache->face_vertex(); }
 const vector<int>& Ser::Grid::face_vertex(int n) const { return cache->face_vertex()[n]; }
+const vector<vector<int>>& Ser::Grid::cell_face() const { return cache->cell_face(); }
+const vector<vector<int>>& Ser::Grid::cell_vertex() const { return cache->cell_vertex(); }
 
 void Ser::Grid::set_btype(std::function<int(Vertex, int)> func){
 	auto bsurf = HM3D::Surface::Assembler::GridSurface(grid);
 	HM3D::Surface::SetBoundaryTypes(bsurf, func);
-	cache->_btypes.clear();
+	reset_btypes();
 }
 
 void Ser::Grid::renumber_by_cells(){
@@ -372,11 +467,11 @@ void Ser::Grid::fill_from_serial(const vector<double>& vert,
 		const vector<int>& btypes){
 	//fill cache
 	empty_cache();
-	cache->_vert = vert;
-	cache->_edge_vert = edgevert;
-	cache->_face_edge = faceedge;
-	cache->_face_cell = facecell;
-	cache->_btypes = btypes;
+	cache->_vert.set(vert);
+	cache->_edge_vert.set(edgevert);
+	cache->_face_edge.set(faceedge);
+	cache->_face_cell.set(facecell);
+	cache->_btypes.set(btypes);
 	//fill grid
 	grid.clear();
 	//vertices
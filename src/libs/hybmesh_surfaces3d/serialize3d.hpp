@@ -3,6 +3,9 @@
 #include "primitives3d.hpp"
 
 namespace HM3D{ namespace Ser {
+//Serialized tables are built on demand and cached.
+//Tables could be queried concurrently but cache resetting
+//should not be done simultaneously with queries.
 class Surface{
 	struct Cache;
 	mutable std::unique_ptr<Cache> cache;
@@ -17,6 +20,11 @@ public:
 
 	//this should be called after all this->grid changes
 	void reset_geometry() const { empty_cache(); }
+	//this should be called if only vertices coordinates were changed.
+	//Topology tables are kept.
+	void reset_vert() const;
+	//memory used by already built tables in bytes
+	size_t cache_memory() const;
 
 	int n_vert() const;
 	int n_edges() const;
@@ -54,6 +62,13 @@ public:
 
 	//this should be called after all this->grid changes
 	void reset_geometry() const { empty_cache(); }
+	//this should be called if only vertices coordinates were changed.
+	//Topology tables are kept.
+	void reset_vert() const;
+	//this should be called if only faces boundary types were changed
+	void reset_btypes() const;
+	//memory used by already built tables in bytes
+	size_t cache_memory() const;
 
 	int n_vert() const { return grid.vvert.size(); }
 	int n_edges() const { return grid.vedges.size(); }
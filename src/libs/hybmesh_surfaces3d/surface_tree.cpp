@@ -1,30 +1,29 @@
 #include "surface_tree.hpp"
+#include "finder3d.hpp"
+#include "hmparallel.hpp"
 
 using namespace HM3D;
 using namespace HM3D::Surface;
 
+namespace{
+//position of surface vertices with respect to closed surface.
+//Vertices lying on the surface are skipped.
+int surface_position(const Finder::SurfaceFinder& finder, const VertexData& av){
+	for (auto& v: av){
+		int pos = finder.whereis(*v);
+		if (pos != BOUND) return pos;
+	}
+	return BOUND;
+}
+}
+
 Tree Tree::Assemble(const FaceData& idata){
-	// !!! only bounding box check here
 	vector<FaceData> data = HM3D::SplitData(idata);
 	vector<FaceData*> closed;
-	vector<BoundingBox3D> closed_bboxes;
 	vector<FaceData*> open;
-	//find all closed contours, assemble bounding boxes for them
 	for (int i=0; i<data.size(); ++i){
-		bool isclosed = IsClosed(data[i]);
-		if (isclosed) closed.push_back(&data[i]);
+		if (IsClosed(data[i])) closed.push_back(&data[i]);
 		else open.push_back(&data[i]);
-		
-		auto ae = AllEdges(data[i]);
-		if (isclosed){
-			HM3D::VertexData av;
-			for (auto e: ae) aa::constant_ids_pvec(e->vertices, 0);
-			for (auto e: ae) for (auto v: e->vertices) if (v->id==0){
-				av.push_back(v);
-				v->id = 1;
-			}
-			closed_bboxes.push_back(BoundingBox3D(av));
-		}
 	}
 	//add open contours to result
 	Tree ret;
@@ -32,55 +31,61 @@ Tree Tree::Assemble(const FaceData& idata){
 	if (closed.size() == 0) return ret;
 	//add closed contours
 	for (auto s: closed) ret.nodes.emplace_back(new Tree::TNode(*s, 0));
-	//build tree
-	for (int i=1; i<closed.size(); ++i){
-		vector<int> inners, outers;
-		for (int j=0; j<i; ++j){
-			int pos = closed_bboxes[i].relation(closed_bboxes[j]);
-			if (pos == 1){
-				inners.push_back(j);
-			} else if (pos == 2){
-				outers.push_back(j);
-			} else if (pos == 3){
-				//just a sibling, do nothing
-			} else throw std::runtime_error(
-				"Failed to assemble surface tree for "
-				"complicated geometry");
-		}
-		//look up
-		int lowest_outer=-1;
-		int klowest = -1;
-		for (int k: outers){
-			int olv = ret.nodes[open.size()+k]->level;
-			if (olv > lowest_outer){
-				lowest_outer = olv;
-				klowest = k;
-			}
-		}
-		if (klowest >= 0){
-			auto out = ret.nodes[open.size() + klowest];
-			auto self = ret.nodes[open.size() + i];
-			out->children.push_back(self);
-			self->parent = out;
-			self->level = lowest_outer+1;
+	int nclosed = closed.size();
+
+	//vertices, bounding boxes and search trees for closed surfaces
+	vector<VertexData> closed_vert(nclosed);
+	vector<BoundingBox3D> closed_bboxes(nclosed);
+	vector<shared_ptr<Finder::SurfaceFinder>> finders(nclosed);
+	//AllVertices changes vertex ids which could be shared by touching surfaces
+	for (int i=0; i<nclosed; ++i){
+		closed_vert[i] = AllVertices(*closed[i]);
+		closed_bboxes[i] = BoundingBox3D(closed_vert[i]);
+	}
+	HMParallel::For(nclosed, [&](int i){
+		finders[i].reset(new Finder::SurfaceFinder(*closed[i]));
+	}, 2);
+
+	//surfaces which bounding boxes contain first vertex of each surface
+	BoundingBox3D area = closed_bboxes[0];
+	for (auto& bb: closed_bboxes){
+		area.xmin = std::min(area.xmin, bb.xmin); area.xmax = std::max(area.xmax, bb.xmax);
+		area.ymin = std::min(area.ymin, bb.ymin); area.ymax = std::max(area.ymax, bb.ymax);
+		area.zmin = std::min(area.zmin, bb.zmin); area.zmax = std::max(area.zmax, bb.zmax);
+	}
+	BoundingBox3DFinder bbfinder(area, area.maxlen()/std::max(1.0, std::cbrt(nclosed)));
+	for (auto& bb: closed_bboxes) bbfinder.addentry(bb);
+
+	//all surfaces containing i-th surface.
+	//Since closed surfaces have no crosses it is enough to check single vertex.
+	vector<vector<int>> outers(nclosed);
+	std::atomic<bool> failed(false);
+	HMParallel::For(nclosed, [&](int i){
+		for (int j: bbfinder.suspects(*closed_vert[i][0])){
+			if (j == i) continue;
+			int rel = closed_bboxes[j].relation(closed_bboxes[i]);
+			if (rel != 0 && rel != 1) continue;
+			int pos = surface_position(*finders[j], closed_vert[i]);
+			if (pos == INSIDE) outers[i].push_back(j);
+			else if (pos == BOUND) failed = true;
 		}
-		//look down
-		for (int k: inners){
-			auto in = ret.nodes[open.size() + k];
-			auto self = ret.nodes[open.size() + i];
-			++(in->level);
-			if (in->level == self->level + 1){
-				if (!in->parent.expired()){
-					auto par = in->parent.lock();
-					auto fnd = std::find_if(par->children.begin(), par->children.end(),
-							[&in](weak_ptr<Tree::TNode> e){
-								return (e.lock() == in);
-							});
-					assert(fnd != par->children.end());
-					par->children.erase(fnd);
-				}
-				in->parent = self;
-				self->children.push_back(in);
+	}, 2);
+	if (failed) throw std::runtime_error(
+		"Failed to assemble surface tree for "
+		"complicated geometry");
+
+	//level equals number of outer surfaces, parent is the outer surface of previous level
+	for (int i=0; i<nclosed; ++i){
+		ret.nodes[open.size() + i]->level = outers[i].size();
+	}
+	for (int i=0; i<nclosed; ++i){
+		auto self = ret.nodes[open.size() + i];
+		for (int k: outers[i]){
+			auto out = ret.nodes[open.size() + k];
+			if (out->level == self->level - 1){
+				out->children.push_back(self);
+				self->parent = out;
+				break;
 			}
 		}
 	}
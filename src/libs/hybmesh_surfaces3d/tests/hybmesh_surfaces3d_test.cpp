@@ -1,5 +1,6 @@
 #include "hmgrid3d.hpp"
 #include <fstream>
+#include <random>
 #include "debug3d.hpp"
 #include "hmtesting.hpp"
 #include "hmtimer.hpp"
@@ -7,6 +8,10 @@
 #include "contour.hpp"
 #include "healgrid.hpp"
 #include "assemble3d.hpp"
+#include "contabs3d.hpp"
+#include "serialize3d.hpp"
+#include "hmparallel.hpp"
+#include "finder3d.hpp"
 
 using namespace HMTesting;
 
@@ -95,9 +100,179 @@ void test01(){
 	}
 }
 
+void test02(){
+	std::cout<<"2. Connectivity tables"<<std::endl;
+	auto g1 = HM3D::Grid::Constructor::Cuboid({0, 0, 0}, 1, 1, 1, 2, 2, 2);
+	auto cc = HM3D::Connectivity::CellCell(g1.vcells);
+	add_check(std::all_of(cc.begin(), cc.end(),
+			[](const vector<int>& v){ return v.size() == 3; }),
+		"cell-cell");
+	auto ef = HM3D::Connectivity::EdgeFace(g1.vfaces);
+	int nef = 0;
+	for (auto& it: ef) nef += it.size();
+	add_check(ef.size() == g1.vedges.size() && nef == 4*g1.vfaces.size(), "edge-face");
+
+	HM3D::Ser::Grid sg(g1);
+	auto& cf = sg.cell_face();
+	auto& cv = sg.cell_vertex();
+	bool good = cf.size() == 8 && cv.size() == 8;
+	for (int i=0; i<cv.size(); ++i){
+		if (cf[i].size() != 6 || cv[i].size() != 8) good = false;
+	}
+	add_check(good, "serialized cell-face, cell-vertex");
+	add_check(sg.bfaces().size() == 24 && sg.bedges().size() == 48 && sg.bvert().size() == 26,
+		"serialized boundary");
+}
+void test03(){
+	std::cout<<"3. Serialized grid cache"<<std::endl;
+	auto g1 = HM3D::Grid::Constructor::Cuboid({0, 0, 0}, 1, 1, 1, 3, 3, 3);
+	HM3D::Ser::Grid sg(g1);
+	add_check(sg.cache_memory() == 0, "empty cache");
+
+	//concurrent queries
+	vector<size_t> sizes(16);
+	HMParallel::For(16, [&](int i){
+		sizes[i] = (i % 2 == 0) ? sg.cell_vertex().size() : sg.bvert().size();
+	}, 2, 4);
+	add_check(sizes[0] == 27 && sizes[1] == 56 &&
+	          std::count(sizes.begin(), sizes.end(), sizes[0]) == 8,
+	          "concurrent queries");
+	size_t mem = sg.cache_memory();
+	add_check(mem > 0, "cache memory");
+
+	//coordinates-only change keeps topology tables
+	const vector<int>* fv = &sg.face_vertex(0);
+	vector<int> fv0 = *fv;
+	for (auto& v: sg.grid.vvert) v->x += 1;
+	sg.reset_vert();
+	add_check(ISEQ(sg.vert()[0], g1.vvert[0]->x) && &sg.face_vertex(0) == fv &&
+	          sg.face_vertex(0) == fv0, "vertices reset");
+	sg.reset_geometry();
+	add_check(sg.cache_memory() == 0, "full reset");
+}
+
+void test04(){
+	std::cout<<"4. Surface finder"<<std::endl;
+	//unit cube with a cubic hole
+	auto g1 = HM3D::Grid::Constructor::Cuboid({0, 0, 0}, 1, 1, 1, 5, 4, 3);
+	auto g2 = HM3D::Grid::Constructor::Cuboid({0.3, 0.3, 0.3}, 0.3, 0.3, 0.3, 2, 2, 2);
+	auto s1 = HM3D::Surface::Assembler::GridSurface(g1);
+	auto s2 = HM3D::Surface::Assembler::GridSurface(g2);
+	HM3D::FaceData srf = s1;
+	srf.insert(srf.end(), s2.begin(), s2.end());
+	HM3D::Finder::SurfaceFinder finder(srf);
+
+	auto f1 = finder.find(Point3(0.5, 0.5, 2));
+	add_check(std::get<0>(f1) >= 0 && ISEQ(std::get<1>(f1), 1.0) &&
+	          std::get<2>(f1) == Point3(0.5, 0.5, 1), "closest point");
+
+	//points are compared with linear search and exact positions
+	auto av = HM3D::AllVertices(srf);
+	bool good_closest = true, good_where = true;
+	auto exact = [](const Point3& p)->int{
+		auto in_cube = [&p](double a, double b){
+			return p.x > a && p.x < b && p.y > a && p.y < b && p.z > a && p.z < b;
+		};
+		return (in_cube(0, 1) && !in_cube(0.3, 0.6)) ? INSIDE : OUTSIDE;
+	};
+	for (int i=0; i<1000; ++i){
+		//grid aligned points make rays pass through edges
+		double x = (i % 10)/8.0 - 0.1;
+		double y = ((i / 10) % 10)/8.0 - 0.1;
+		double z = (i / 100)/9.0 - 0.05;
+		Point3 p(x, y, z);
+		//outside of the unit cube distance is known,
+		//otherwise it should not exceed distance to the closest vertex
+		double dx = std::max(0.0, std::max(-x, x - 1));
+		double dy = std::max(0.0, std::max(-y, y - 1));
+		double dz = std::max(0.0, std::max(-z, z - 1));
+		double m = dx*dx + dy*dy + dz*dz;
+		if (m == 0) m = std::get<1>(HM3D::Finder::ClosestPoint(av, p));
+		auto fnd = finder.find(p);
+		if (std::get<1>(fnd) > m + geps || (dx + dy + dz > 0 && !ISEQ(std::get<1>(fnd), m)))
+			good_closest = false;
+		if (finder.whereis(p) != exact(p)) good_where = false;
+	}
+	add_check(good_closest, "closest points");
+	add_check(good_where, "points location");
+	add_check(finder.whereis(Point3(0.5, 0.5, 1)) == BOUND &&
+	          finder.whereis(Point3(0.3, 0.4, 0.5)) == BOUND &&
+	          finder.whereis(Point3(0.45, 0.45, 0.45)) == OUTSIDE &&
+	          finder.whereis(Point3(0.2, 0.4, 0.6)) == INSIDE, "bound points location");
+
+	//faces touching x = 1 plane
+	auto fb = finder.faces_in_box(BoundingBox3D(Point3(0.9, -1, -1), Point3(1.1, 2, 2)));
+	int nfb = 0;
+	for (auto& f: srf){
+		BoundingBox3D bb(HM3D::AllVertices(HM3D::FaceData {f}));
+		if (bb.xmax > 0.9) ++nfb;
+	}
+	add_check(nfb == 26 && fb.size() == nfb &&
+	          std::is_sorted(fb.begin(), fb.end()), "faces in box");
+}
+
+void test05(){
+	std::cout<<"5. Surface tree of many bodies"<<std::endl;
+	HM3D::FaceData srf;
+	auto add_cube = [&srf](Point3 p0, double a, int n){
+		auto g = HM3D::Grid::Constructor::Cuboid(p0, a, a, a, n, n, n);
+		auto s = HM3D::Surface::Assembler::GridSurface(g);
+		srf.insert(srf.end(), s.begin(), s.end());
+	};
+	//L-shaped body with a cube inside and a cube within its bounding box only
+	auto gl1 = HM3D::Grid::Constructor::Cuboid({0, 0, 0}, 2, 1, 1, 2, 1, 1);
+	auto gl2 = HM3D::Grid::Constructor::Cuboid({0, 1, 0}, 1, 1, 1, 1, 1, 1);
+	auto gl = HM3D::Grid::Algos::MergeGrids(gl1, gl2);
+	auto sl = HM3D::Surface::Assembler::GridSurface(gl);
+	srf.insert(srf.end(), sl.begin(), sl.end());
+	add_cube(Point3(0.2, 0.2, 0.2), 0.2, 1);
+	add_cube(Point3(1.4, 1.4, 0.4), 0.2, 1);
+	//box with 5x5x5 cubes each containing a smaller cube
+	add_cube(Point3(10, 10, 10), 10, 2);
+	for (int i=0; i<5; ++i)
+	for (int j=0; j<5; ++j)
+	for (int k=0; k<5; ++k){
+		Point3 p0(10.5 + 2*i, 10.5 + 2*j, 10.5 + 2*k);
+		add_cube(p0, 1, 1);
+		add_cube(p0 + Point3(0.3, 0.3, 0.3), 0.4, 1);
+	}
+	std::shuffle(srf.begin(), srf.end(), std::mt19937(0));
+
+	auto tree = HM3D::Surface::Tree::Assemble(srf);
+	vector<int> nlevel(4, 0);
+	bool good_parents = true;
+	for (auto& nd: tree.nodes){
+		if (nd->level < 0 || nd->level > 3) { good_parents = false; continue; }
+		++nlevel[nd->level];
+		if (nd->isroot()) continue;
+		//parent bounding box should contain node
+		auto par = nd->parent.lock();
+		BoundingBox3D bb1(HM3D::AllVertices(nd->surface));
+		BoundingBox3D bb2(HM3D::AllVertices(par->surface));
+		if (par->level != nd->level - 1 || bb2.relation(bb1) != 1) good_parents = false;
+	}
+	add_check(tree.nodes.size() == 254 && nlevel[0] == 3 && nlevel[1] == 126 &&
+	          nlevel[2] == 125 && nlevel[3] == 0 && good_parents, "levels and parents");
+	add_check(tree.roots().size() == 3 && tree.roots()[0]->children.size() +
+	          tree.roots()[1]->children.size() + tree.roots()[2]->children.size() == 126,
+	          "roots");
+
+	//bounding area with different origins along y and z
+	srf.clear();
+	add_cube(Point3(0, 10, 0), 1, 2);
+	add_cube(Point3(0.3, 10.3, 0.3), 0.3, 1);
+	auto tree2 = HM3D::Surface::Tree::Assemble(srf);
+	add_check(tree2.nodes.size() == 2 && tree2.roots().size() == 1 &&
+	          tree2.roots()[0]->children.size() == 1 &&
+	          tree2.roots()[0]->children[0].lock()->level == 1, "offset area");
+}
 
 int main(){
 	test01();
+	test02();
+	test03();
+	test04();
+	test05();
 	
 	check_final_report();
 	std::cout<<"DONE"<<std::endl;
@@ -94,6 +94,7 @@ class TetrahedralFill(NewGrid3DCommand):
                 'constr': co.ListOfOptions(co.BasicOption(str), []),
                 'pts': co.ListOfOptions(co.Point3Option(), []),
                 'pts_size': co.ListOfOptions(co.BasicOption(float), []),
+                'backend': co.BasicOption(str, 'gmsh'),
                 }
 
     def _build_grid(self):
@@ -102,7 +103,8 @@ class TetrahedralFill(NewGrid3DCommand):
         cb = self.ask_for_callback()
         return g3core.tetrahedral_fill(
             [x.cdata for x in src], [x.cdata for x in constr],
-            self.get_option('pts'), self.get_option('pts_size'), cb)
+            self.get_option('pts'), self.get_option('pts_size'), cb,
+            backend=self.get_option('backend'))
 
 
 class Merge(NewGrid3DCommand):
@@ -114,9 +116,15 @@ class Merge(NewGrid3DCommand):
         return {'name': co.BasicOption(str, None),
                 'src1': co.BasicOption(str),
                 'src2': co.BasicOption(str),
+                'src_more': co.ListOfOptions(co.BasicOption(str), []),
                 }
 
     def _build_grid(self):
-        g1 = self.grid3_by_name(self.get_option('src1'))
-        g2 = self.grid3_by_name(self.get_option('src2'))
-        return g3core.merge(g1.cdata, g2.cdata)
+        names = [self.get_option('src1'), self.get_option('src2')]
+        names.extend(self.get_option('src_more'))
+        gg = [self.grid3_by_name(n).cdata for n in names]
+        cb = self.ask_for_callback()
+        if len(gg) == 2:
+            return g3core.merge(gg[0], gg[1], cb)
+        else:
+            return g3core.merge_many(gg, cb)
@@ -594,6 +594,8 @@ class MapGrid(NewGridCommand):
             snap - snapping algo ("no", "add_vertices", "shift_vertices")
             btypes - source of boundary features ("from_grid", "from_contour")
             algo ('inverse_laplace', 'direct_laplace')
+            fem_tol - tolerance of adaptive auxiliary triangulation.
+                Non-positive value means fixed triangulation.
         """
         return {'name': co.BasicOption(str, None),
                 'base': co.BasicOption(str),
@@ -605,6 +607,7 @@ class MapGrid(NewGridCommand):
                 'algo': co.BasicOption(str, 'inverse_laplace'),
                 'is_reversed': co.BoolOption(False),
                 'return_invalid': co.BoolOption(False),
+                'fem_tol': co.BasicOption(float, -1.0),
                 }
 
     def _build_grid(self):
@@ -618,7 +621,8 @@ class MapGrid(NewGridCommand):
                               self.get_option('btypes') == 'from_contour',
                               self.get_option('algo'),
                               self.get_option('is_reversed'),
-                              self.get_option('return_invalid'), cb)
+                              self.get_option('return_invalid'),
+                              self.get_option('fem_tol'), cb)
         return ret
 
 
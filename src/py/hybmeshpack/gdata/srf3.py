@@ -70,6 +70,19 @@ class Surface3(AbstractSurface3):
     def assign_boundary_type(self, bt):
         return s3core.assign_boundary_types(self.cdata, bt)
 
+    def closest_points(self, pts):
+        """ -> (closest surface points, indices of their faces)
+        """
+        return s3core.closest_points(self.cdata, pts)
+
+    def where_points(self, pts):
+        """ -> 1 (inside), 0 (on surface), -1 (outside) for each point
+        """
+        return s3core.where_points(self.cdata, pts)
+
+    def faces_in_box(self, p0, p1):
+        return s3core.faces_in_box(self.cdata, p0, p1)
+
     # overriden from GeomObject3
     def volume(self):
         return s3core.volume(self.cdata)
@@ -80,6 +80,11 @@ def move(obj, dx, dy):
     ccall(cport.g2_move, obj, dx)
 
 
+def renumber(obj, algo):
+    """ algo = 'rcm', 'hilbert', 'morton' """
+    ccall(cport.g2_renumber, obj, algo)
+
+
 def scale(obj, xpc, ypc, px, py):
     p0 = (ct.c_double * 2)(px, py)
     pc = (ct.c_double * 2)(xpc, ypc)
@@ -306,8 +311,18 @@ def stripe_grid(obj, partition, tipalgo, bnd, cb):
     return ret
 
 
+def stripe_grid_vtk(obj, partition, tipalgo, nwindow, fname, cb):
+    npartition = ct.c_int(len(partition))
+    partition = list_to_c(partition, float)
+    nwindow = ct.c_int(nwindow)
+    fname = fname.encode('utf-8')
+    ccall_cb(cport.g2_stripe_grid_vtk, cb, obj,
+             npartition, partition, tipalgo, nwindow, fname)
+
+
 def map_grid(base_obj, target_obj, base_points, target_points,
-             snap, bt_from_contour, algo, is_reversed, rinvalid, cb):
+             snap, bt_from_contour, algo, is_reversed, rinvalid, fem_tol,
+             cb):
     npoints = min(len(base_points), len(target_points))
     base_points = base_points[:npoints]
     target_points = target_points[:npoints]
@@ -317,11 +332,13 @@ def map_grid(base_obj, target_obj, base_points, target_points,
     bt_from_contour = ct.c_int(bt_from_contour)
     is_reversed = ct.c_int(is_reversed)
     rinvalid = ct.c_int(rinvalid)
+    fem_tol = ct.c_double(fem_tol)
     ret = ct.c_void_p()
 
     ccall_cb(cport.g2_map_grid, cb, base_obj, target_obj,
              npoints, base_points, target_points, snap,
-             bt_from_contour, algo, is_reversed, rinvalid, ct.byref(ret))
+             bt_from_contour, algo, is_reversed, rinvalid, fem_tol,
+             ct.byref(ret))
     return ret
 
 
@@ -418,13 +435,14 @@ def to_hm(doc, node, obj, name, fmt, afields, cb=None):
     ccall(cport.g2_to_hm, doc, node, obj, name, fmt, naf, af)
 
 
-def boundary_layer_grid(opt, cb=None):
+def boundary_layer_grid(opt, cb=None, nthreads=0):
     """ ->grid2.
         opt - options dictionary object.
               Same as gridcom.BuildBoundaryGrid options['opt'] dictionary
               except for 'source' field is a proper Contour2.cdata object.
               All fields must be filled
         cb - callback of CB_CANCEL2 type
+        nthreads - number of threads. Non-positive value means default.
     """
     # prepare c input data
     class COptStruct(ct.Structure):
@@ -477,7 +495,9 @@ def boundary_layer_grid(opt, cb=None):
         c_opt[i] = COptStruct(co)
 
     ret = ct.c_void_p()
-    ccall_cb(cport.g2_boundary_layer, cb, nopt, c_opt, ct.byref(ret))
+    nthreads = ct.c_int(nthreads)
+    ccall_cb(cport.g2_boundary_layer, cb, nopt, c_opt, nthreads,
+             ct.byref(ret))
     return ret
 
 
@@ -40,6 +40,11 @@ def move(obj, dx, dy, dz):
     ccall(cport.g3_move, obj, dx)
 
 
+def renumber(obj, algo):
+    """ algo = 'rcm', 'hilbert', 'morton' """
+    ccall(cport.g3_renumber, obj, algo)
+
+
 def scale(obj, xpc, ypc, zpc, px, py, pz):
     p0 = (ct.c_double * 3)(px, py, pz)
     pc = (ct.c_double * 3)(xpc, ypc, zpc)
@@ -149,7 +154,12 @@ def revolve(g2obj, vec, phivals, center_tri, bt1, bt2):
     return ret
 
 
-def tetrahedral_fill(sobjs, constrs, pts, pt_sizes, cb):
+def tetrahedral_fill(sobjs, constrs, pts, pt_sizes, cb, nthreads=0,
+                     backend='gmsh'):
+    """ nthreads - number of threads used for disjoint domains.
+        Non-positive value means default.
+        backend = 'gmsh', 'tetgen'
+    """
     nsobjs = ct.c_int(len(sobjs))
     sobjs = list_to_c(sobjs, 'void*')
     nconstrs = ct.c_int(len(constrs))
@@ -157,10 +167,11 @@ def tetrahedral_fill(sobjs, constrs, pts, pt_sizes, cb):
     npts = ct.c_int(len(pts))
     pts = list_to_c(concat(pts), float)
     pt_sizes = list_to_c(pt_sizes, float)
+    nthreads = ct.c_int(nthreads)
     ret = ct.c_void_p()
     ccall_cb(cport.g3_tetrahedral_fill, cb,
              nsobjs, sobjs, nconstrs, constrs, npts, pts, pt_sizes,
-             ct.byref(ret))
+             nthreads, backend, ct.byref(ret))
     return ret
 
 
@@ -170,6 +181,14 @@ def merge(obj1, obj2, cb=None):
     return ret
 
 
+def merge_many(objs, cb=None):
+    nobjs = ct.c_int(len(objs))
+    objs = list_to_c(objs, "void*")
+    ret = ct.c_void_p()
+    ccall_cb(cport.g3_merge_many, cb, nobjs, objs, ct.byref(ret))
+    return ret
+
+
 def assign_boundary_types(obj, bt):
     dataout = ct.POINTER(ct.c_int)()
     ccall(cport.g3_assign_boundary_types, obj, bt.data, ct.byref(dataout))
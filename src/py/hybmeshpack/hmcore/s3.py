@@ -1,7 +1,7 @@
 import ctypes as ct
 from . import cport
 from proc import (ccall, ccall_cb, free_cside_array, list_to_c,
-                  move_to_static, BndTypesDifference)
+                  move_to_static, concat, BndTypesDifference)
 
 
 def deepcopy(obj):
@@ -106,6 +106,35 @@ def assign_boundary_types(obj, bt):
     return BndTypesDifference.from_cdata(dataout)
 
 
+def closest_points(obj, pts):
+    """ -> (list of closest surface points, list of face indices)
+    """
+    npts = ct.c_int(len(pts))
+    cpts = list_to_c(concat(pts), 'float')
+    ret = (ct.c_double * (3*len(pts)))()
+    ret_faces = (ct.c_int * len(pts))()
+    ccall(cport.s3_closest_points, obj, npts, cpts, ret, ret_faces)
+    it = iter(ret)
+    return [[a, b, c] for a, b, c in zip(it, it, it)], list(ret_faces)
+
+
+def where_points(obj, pts):
+    """ -> list of 1 (inside), 0 (on surface), -1 (outside) for each point
+    """
+    npts = ct.c_int(len(pts))
+    cpts = list_to_c(concat(pts), 'float')
+    ret = (ct.c_int * len(pts))()
+    ccall(cport.s3_where_points, obj, npts, cpts, ret)
+    return list(ret)
+
+
+def faces_in_box(obj, p0, p1):
+    box = (ct.c_double * 6)(p0[0], p0[1], p0[2], p1[0], p1[1], p1[2])
+    nret, cret = ct.c_int(), ct.POINTER(ct.c_int)()
+    ccall(cport.s3_faces_in_box, obj, box, ct.byref(nret), ct.byref(cret))
+    return list(move_to_static(nret.value, cret, int))
+
+
 def to_hm(doc, node, obj, name, fmt, cb):
     name = name.encode('utf-8')
     ccall_cb(cport.s3_to_hm, cb, doc, node, obj, name, fmt)
@@ -57,21 +57,40 @@ def _surf3_from_id(gid):
         return Surface3(cd)
 
 
+def _renumbered(grid, renumber, core):
+    if renumber is None:
+        return grid
+    ret = grid.deepcopy()
+    core.renumber(ret.cdata, renumber)
+    return ret
+
+
 # Exporting grids
 @hmscriptfun
-def export_grid_vtk(gid, fname):
+def export_grid_vtk(gid, fname, renumber=None):
     """ Exports 2d grid to vtk format
 
        :param gid: single or list of 2d grid identifiers
 
        :param str fname: output filename
 
+       :param str renumber: if not None defines primitives reordering
+          algorithm applied to a copy of the grid before export:
+
+          * ``'rcm'`` - reverse Cuthill-McKee ordering of cells,
+          * ``'hilbert'`` - cells are sorted along Hilbert curve,
+          * ``'morton'`` - cells are sorted along Morton (z-order) curve.
+
+          Edges and vertices follow the order of cells.
+
        :returns: None
     """
     icheck(0, UListOr1(Grid2D()))
     icheck(1, String())
+    icheck(2, NoneOr(OneOf('rcm', 'hilbert', 'morton')))
 
-    grid = _grid2_from_id(gid)
+    from hybmeshpack.hmcore import g2
+    grid = _renumbered(_grid2_from_id(gid), renumber, g2)
     cb = flow.interface.ask_for_callback()
     vtk_export.grid2(fname, grid, cb)
 
@@ -124,7 +143,7 @@ def export_grid_hmg(gid, fname, fmt='ascii', afields=[]):
 
 
 @hmscriptfun
-def export_grid_msh(gid, fname, periodic_pairs=[]):
+def export_grid_msh(gid, fname, periodic_pairs=[], renumber=None):
     """Exports grid to fluent msh format.
 
     :param gid: 2d grid file identifier or list of identifiers.
@@ -146,6 +165,15 @@ def export_grid_msh(gid, fname, periodic_pairs=[]):
       Periodic and shadow boundary segments should be singly connected and
       topologically equivalent.
 
+    :param str renumber: if not None defines primitives reordering
+       algorithm applied to a copy of the grid before export:
+
+       * ``'rcm'`` - reverse Cuthill-McKee ordering of cells,
+       * ``'hilbert'`` - cells are sorted along Hilbert curve,
+       * ``'morton'`` - cells are sorted along Morton (z-order) curve.
+
+       Edges and vertices follow the order of cells.
+
     :returns: None
 
     Only grids with triangle/quadrangle cells could be exported.
@@ -153,9 +181,11 @@ def export_grid_msh(gid, fname, periodic_pairs=[]):
     icheck(0, UListOr1(Grid2D()))
     icheck(1, String())
     icheck(2, CompoundList(ZType(), ZType(), Bool()))
+    icheck(3, NoneOr(OneOf('rcm', 'hilbert', 'morton')))
 
+    from hybmeshpack.hmcore import g2
     cb = flow.interface.ask_for_callback()
-    grid = _grid2_from_id(gid)
+    grid = _renumbered(_grid2_from_id(gid), renumber, g2)
     bt = flow.receiver.get_zone_types()
     fluent_export.grid2(fname, grid, bt, periodic_pairs, cb)
 
@@ -211,7 +241,8 @@ def export_grid_tecplot(gid, fname):
 
 # 3d exports
 @hmscriptfun
-def export3d_grid_vtk(gid, fname_grid=None, fname_surface=None):
+def export3d_grid_vtk(gid, fname_grid=None, fname_surface=None,
+                      renumber=None):
     """Exports 3D grid and its surface to vtk ascii format.
 
     :param gid: 3D grid file identifier or list of identifiers
@@ -220,6 +251,15 @@ def export3d_grid_vtk(gid, fname_grid=None, fname_surface=None):
 
     :param str-or-None fname_surface: filename for surface output.
 
+    :param str renumber: if not None defines primitives reordering
+       algorithm applied to a copy of the grid before export:
+
+       * ``'rcm'`` - reverse Cuthill-McKee ordering of cells,
+       * ``'hilbert'`` - cells are sorted along Hilbert curve,
+       * ``'morton'`` - cells are sorted along Morton (z-order) curve.
+
+       Faces, edges and vertices follow the order of cells.
+
     Only hexahedron, prism, wedge and tetrahedron cells could be exported
     as a grid. Surface export takes arbitrary grid.
 
@@ -231,13 +271,15 @@ def export3d_grid_vtk(gid, fname_grid=None, fname_surface=None):
     icheck(0, UListOr1(Grid3D()))
     icheck(1, NoneOr(String()))
     icheck(2, NoneOr(String()))
+    icheck(3, NoneOr(OneOf('rcm', 'hilbert', 'morton')))
     if not fname_grid:
         fname_grid = None
     if not fname_surface:
         fname_surface = None
 
+    from hybmeshpack.hmcore import g3
     cb = flow.interface.ask_for_callback()
-    grid = _grid3_from_id(gid)
+    grid = _renumbered(_grid3_from_id(gid), renumber, g3)
     if fname_grid is not None:
         vtk_export.grid3(fname_grid, grid, cb)
     if fname_surface is not None:
@@ -245,7 +287,7 @@ def export3d_grid_vtk(gid, fname_grid=None, fname_surface=None):
 
 
 @hmscriptfun
-def export3d_grid_msh(gid, fname, periodic_pairs=[]):
+def export3d_grid_msh(gid, fname, periodic_pairs=[], renumber=None):
     """Exports 3D grid to fluent msh ascii format.
 
     :param gid: 3D grid file identifier or list of identifiers
@@ -271,13 +313,24 @@ def export3d_grid_msh(gid, fname, periodic_pairs=[]):
        For surface 2D topology definition periodic/shadow surfaces are taken
        with outside/inside normals respectively.
 
+    :param str renumber: if not None defines primitives reordering
+       algorithm applied to a copy of the grid before export:
+
+       * ``'rcm'`` - reverse Cuthill-McKee ordering of cells,
+       * ``'hilbert'`` - cells are sorted along Hilbert curve,
+       * ``'morton'`` - cells are sorted along Morton (z-order) curve.
+
+       Faces, edges and vertices follow the order of cells.
+
     """
     icheck(0, UListOr1(Grid3D()))
     icheck(1, String())
     icheck(2, CompoundList(ZType(), ZType(), Point3D(), Point3D()))
+    icheck(3, NoneOr(OneOf('rcm', 'hilbert', 'morton')))
 
+    from hybmeshpack.hmcore import g3
     cb = flow.interface.ask_for_callback()
-    grid = _grid3_from_id(gid)
+    grid = _renumbered(_grid3_from_id(gid), renumber, g3)
     bt = flow.receiver.get_zone_types()
     fluent_export.grid3(fname, grid, bt, periodic_pairs, cb)
 
@@ -3,7 +3,8 @@ from hybmeshpack import com
 from hybmeshpack.hmscript import flow, hmscriptfun
 import o2info
 from datachecks import (icheck, List, UListOr1, Bool, UList, Point2D,
-                        Grid2D, OneOf, Float, Tuple, ACont2D, CompoundList)
+                        Grid2D, OneOf, Float, Tuple, ACont2D, CompoundList,
+                        NoneOr)
 
 
 @hmscriptfun
@@ -308,7 +309,7 @@ def insert_grid_constraints(grid, conts=[], sites=[], buffer_size=1.,
 def map_grid(base_grid, target_contour, base_points, target_points,
              snap="no", project_to="line", btypes="from_grid",
              algo="inverse_laplace",
-             is_reversed=False, return_invalid=False):
+             is_reversed=False, return_invalid=False, fem_tol=None):
     """Performs mapping of base grid on another contour.
     See detailed options description in :ref:`gridmappings`.
 
@@ -365,6 +366,11 @@ def map_grid(base_grid, target_contour, base_points, target_points,
 
        .. warning:: Never use invalid grids for further operations.
 
+    :param float fem_tol: if given then auxiliary triangulation used
+       for the Laplace problem solution is built adaptively:
+       it is refined until relative error estimation of the solution
+       becomes less than this value. Otherwise fixed triangulation is used.
+
     :returns: identifier of newly created grid
 
     """
@@ -378,6 +384,7 @@ def map_grid(base_grid, target_contour, base_points, target_points,
     icheck(7, OneOf('inverse_laplace', 'direct_laplace'))
     icheck(8, Bool())
     icheck(9, Bool())
+    icheck(10, NoneOr(Float(grthan=0.0)))
 
     # project_to option treatment
     if project_to == "line":
@@ -404,7 +411,8 @@ def map_grid(base_grid, target_contour, base_points, target_points,
                              "algo": algo,
                              "btypes": btypes,
                              "is_reversed": is_reversed,
-                             "return_invalid": return_invalid})
+                             "return_invalid": return_invalid,
+                             "fem_tol": -1.0 if fem_tol is None else fem_tol})
     flow.exec_command(c)
     return c.added_grids2()[0]
 
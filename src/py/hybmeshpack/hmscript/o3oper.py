@@ -1,25 +1,34 @@
 " 3D objects operations"
 from hybmeshpack import com
 from hybmeshpack.hmscript import flow, hmscriptfun
-from datachecks import icheck, Grid3D
+from datachecks import icheck, Grid3D, List, NoneOr
 
 
 @hmscriptfun
-def merge_grids3(g1, g2):
+def merge_grids3(g1, g2, more_grids=None):
     """ Merges 3d grids into single one.
 
         :param g1:
 
         :param g2: 3d source grids identifiers.
 
+        :param more_grids: list of additional 3d grids identifiers.
+
         :returns: new grid identifier.
 
         Merge procedure will process only strictly
         coincident boundary primitives.
+        All grids are merged in a single pass, so it is faster to pass
+        all of them at once than to merge them pairwise.
     """
     icheck(0, Grid3D())
     icheck(1, Grid3D())
+    icheck(2, NoneOr(List(Grid3D())))
+
+    if more_grids is None:
+        more_grids = []
 
-    c = com.grid3dcom.Merge({"src1": g1, "src2": g2})
+    c = com.grid3dcom.Merge({"src1": g1, "src2": g2,
+                             "src_more": more_grids})
     flow.exec_command(c)
     return c.added_grids3()[0]
@@ -23,4 +23,14 @@ check(abs(hm.domain_volume(ss) - 68.0) < 1e-8)
 g7 = hm.merge_grids3(g6, g2)
 check(abs(hm.domain_volume(g7) - 72.0) < 1e-8)
 
+print "merge of multiple grids"
+m = [hm.extrude_grid(hm.add_unf_rect_grid([i, 0], [i + 1, 1], 2, 2), [0, 1])
+     for i in range(3)]
+m1 = hm.merge_grids3(m[0], m[1], [m[2]])
+check(abs(hm.domain_volume(m1) - 3.0) < 1e-8)
+check(hm.info_grid3(m1) ==
+      {'Nnodes': 42, 'Nedges': 85, 'Nfaces': 56, 'Ncells': 12})
+m2 = hm.merge_grids3(hm.merge_grids3(m[0], m[1]), m[2])
+check(hm.info_grid3(m2) == hm.info_grid3(m1))
+
 hm.export3d_grid_vtk(g7, "g7.vtk")
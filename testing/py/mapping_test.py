@@ -45,6 +45,18 @@ checkdict(
     hm.info_contour(a2),
     {'btypes': {1: 40}, 'Nnodes': 40, 'subcont': [40], 'Nedges': 40})
 
+print "rectangle to square with sine edges: adaptive auxiliary grid"
+a2a = hm.map_grid(
+    g1, c1,
+    [[0, 0], [5, 0], [5, 1], [0, 1]],
+    [[0, 0], [1, 0], [1, 1], [0, 1]],
+    algo="direct_laplace",
+    snap="no", btypes="from_grid", fem_tol=0.01)
+checkdict(
+    hm.info_grid(a2a),
+    {'cell_types': {4: 100}, 'Nnodes': 121, 'Nedges': 220, 'Ncells': 100})
+check(abs(hm.domain_area(a2a) - hm.domain_area(a2)) < 1e-8)
+
 
 print "rectangle to square with sine edges: add_vertices, from_contour"
 a3 = hm.map_grid(